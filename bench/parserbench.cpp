@@ -0,0 +1,322 @@
+// Copyright 2019 The MWC Developers
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Offline throughput benchmark for tries::Mwc713InputParser and tries::NodeOutputParser.
+// Replays captured stdout transcripts through the parsers and reports MB/s, events/s,
+// heap allocations and per parserId hit distribution.
+//
+// Transcripts can be raw stdout or the log file written by logger::logMwc713out / logMwcNodeOut.
+// For the log files only 'mwc713>>' or 'mwc-node>>' lines are replayed.
+//
+// Every transcript can have '<transcript>.expected' file with the expected hit distribution
+// ('<EVENT_NAME> <count>' per line). If distribution doesn't match, benchmark exit with code 1,
+// so parser changes can be regression-gated.
+//
+// Build:  cmake -DMWC_BUILD_PARSER_BENCH=ON
+// Usage:  mwc-parser-bench [--chunk <bytes>] [--repeat <N>] [--min-mbps <MB/s>] [--no-expect]
+//                          [--mwc713 <transcript>]... [--node <transcript>]...
+// Without transcripts the bundled bench/fixtures are used.
+
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QMap>
+#include <QRegExp>
+#include <QTextStream>
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#include "../tries/mwc713inputparser.h"
+#include "../tries/NodeOutputParser.h"
+#include "../util/Log.h"
+
+#ifndef BENCH_FIXTURES_DIR
+#define BENCH_FIXTURES_DIR "bench/fixtures"
+#endif
+
+////////////////////////////////////////////////////////////////////////
+// Heap allocations counter.
+// With glibc malloc is interposed, so Qt containers are counted as well. Otherwise only operator new is counted.
+
+static std::atomic<long long> allocCounter(0);
+
+#if defined(__GLIBC__)
+
+extern "C" {
+    void * __libc_malloc(size_t size);
+    void * __libc_calloc(size_t n, size_t size);
+    void * __libc_realloc(void * ptr, size_t size);
+
+    void * malloc(size_t size) __THROW {
+        allocCounter++;
+        return __libc_malloc(size);
+    }
+
+    void * calloc(size_t n, size_t size) __THROW {
+        allocCounter++;
+        return __libc_calloc(n, size);
+    }
+
+    void * realloc(void * ptr, size_t size) __THROW {
+        allocCounter++;
+        return __libc_realloc(ptr, size);
+    }
+}
+
+static const char * ALLOC_COUNTER_NAME = "malloc";
+
+#else
+
+void * operator new(size_t size) {
+    allocCounter++;
+    void * ptr = std::malloc(size>0 ? size : 1);
+    if (ptr==nullptr)
+        throw std::bad_alloc();
+    return ptr;
+}
+
+void operator delete(void * ptr) noexcept {
+    std::free(ptr);
+}
+
+static const char * ALLOC_COUNTER_NAME = "operator new";
+
+#endif
+
+namespace bench {
+
+enum class PARSER { MWC713, NODE };
+
+struct Transcript {
+    PARSER  parser;
+    QString fileName;
+    QString data;
+};
+
+// Statistic for a single replay
+struct ReplayStats {
+    qint64 bytes = 0;
+    qint64 chunks = 0;
+    qint64 events = 0;
+    qint64 allocations = 0;
+    qint64 nsecs = 0;
+    QMap<QString, qint64> hits; // event name => hits number
+};
+
+// Log lines prefix: 'dd.MM.yyyy hh:mm:ss.zzz '
+static const QRegExp LOG_LINE_PREFIX("^\\d\\d\\.\\d\\d\\.\\d{4} \\d\\d:\\d\\d:\\d\\d\\.\\d{3} ");
+
+// Load the transcript. Log files are converted back into the stdout stream.
+static bool loadTranscript(PARSER parser, const QString & fileName, Transcript & transcript) {
+    QFile file(fileName);
+    if (!file.open(QFile::ReadOnly)) {
+        qCritical().noquote() << "Unable to read transcript " << fileName;
+        return false;
+    }
+
+    const QString marker = parser == PARSER::MWC713 ? "mwc713>> " : "mwc-node>> ";
+    const QStringList lines = QString::fromUtf8( file.readAll() ).split('\n');
+
+    QStringList output;
+    for (const QString & ln : lines) {
+        QRegExp prefix(LOG_LINE_PREFIX);
+        if (prefix.indexIn(ln) != 0) {
+            output.push_back(ln); // raw stdout
+            continue;
+        }
+
+        // Log line, only the process output is needed
+        const QString logRecord = ln.mid( prefix.matchedLength() );
+        if (logRecord.startsWith(marker))
+            output.push_back( logRecord.mid(marker.length()) );
+    }
+
+    transcript.parser = parser;
+    transcript.fileName = fileName;
+    transcript.data = output.join("\n");
+    return true;
+}
+
+// Expected hits distribution, empty if there is no '.expected' file
+static QMap<QString, qint64> loadExpected(const QString & transcriptFileName) {
+    QMap<QString, qint64> res;
+    QFile file(transcriptFileName + ".expected");
+    if (!file.open(QFile::ReadOnly | QFile::Text))
+        return res;
+
+    QTextStream in(&file);
+    while (!in.atEnd()) {
+        QStringList l = in.readLine().split(' ', QString::SkipEmptyParts);
+        if (l.size()==2)
+            res.insert( l[0], l[1].toLongLong() );
+    }
+    return res;
+}
+
+// Feed the transcript into the parser by chunks. Same parser instance is reused for all repeats.
+static ReplayStats replay(const Transcript & transcript, int chunkSize, int repeat) {
+    ReplayStats stats;
+
+    tries::Mwc713InputParser mwc713Parser;
+    tries::NodeOutputParser nodeParser;
+
+    // Direct connections, counting is a part of the measured time
+    QObject::connect( &mwc713Parser, &tries::Mwc713InputParser::sgGenericEvent,
+                      [&stats](wallet::WALLET_EVENTS event, QString message) {
+        Q_UNUSED(message);
+        stats.events++;
+        stats.hits[ wallet::toString(event) + "(" + QString::number(int(event)) + ")" ]++;
+    });
+    QObject::connect( &nodeParser, &tries::NodeOutputParser::nodeOutputGenericEvent,
+                      [&stats](tries::NODE_OUTPUT_EVENT event, QString message) {
+        Q_UNUSED(message);
+        stats.events++;
+        stats.hits[ tries::toString(event) ]++;
+    });
+
+    // Chunks are prepared in advance, they are not a part of the measurement.
+    // Transcript is wrapped with new lines, so every repeat produce the same events.
+    QVector<QString> chunks;
+    chunks.push_back("\n");
+    for (int pos=0; pos<transcript.data.length(); pos+=chunkSize)
+        chunks.push_back( transcript.data.mid(pos, chunkSize) );
+    chunks.push_back("\n");
+
+    QElapsedTimer timer;
+    const long long allocStart = allocCounter;
+    timer.start();
+
+    for (int r=0; r<repeat; r++) {
+        for (const QString & chunk : chunks) {
+            if (transcript.parser == PARSER::MWC713)
+                mwc713Parser.processInput(chunk);
+            else
+                nodeParser.processInput(chunk);
+
+            stats.bytes += chunk.length();
+            stats.chunks++;
+        }
+    }
+
+    stats.nsecs = timer.nsecsElapsed();
+    stats.allocations = allocCounter - allocStart;
+    return stats;
+}
+
+// Parsers are logging every input with qDebug, it must not be a part of the measurement
+static void silentMessageHandler(QtMsgType type, const QMessageLogContext & context, const QString & msg) {
+    Q_UNUSED(context);
+    if (type == QtCriticalMsg || type == QtFatalMsg) {
+        QTextStream(stderr) << msg << "\n";
+    }
+}
+
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("mwc-parser-bench");
+
+    QCommandLineParser cmdParser;
+    cmdParser.setApplicationDescription("Replay mwc713 and mwc-node transcripts through the output parsers");
+    cmdParser.addHelpOption();
+    cmdParser.addOptions({
+        {"chunk", "Chunk size in symbols that is fed into the parser at once. Default: 4096", "bytes", "4096"},
+        {"repeat", "Number of times every transcript is replayed. Default: 5", "N", "5"},
+        {"min-mbps", "Fail if throughput for any transcript is below this limit", "MB/s", "0"},
+        {"no-expect", "Don't verify hits distribution against '.expected' files"},
+        {"mwc713", "mwc713 stdout transcript or mwc-qt-wallet log file", "transcript"},
+        {"node", "mwc-node stdout transcript or mwc-qt-wallet log file", "transcript"},
+    });
+    cmdParser.process(app);
+
+    const int chunkSize = std::max(1, cmdParser.value("chunk").toInt());
+    const int repeat = std::max(1, cmdParser.value("repeat").toInt());
+    const double minMbps = cmdParser.value("min-mbps").toDouble();
+    const bool checkExpected = !cmdParser.isSet("no-expect");
+
+    QVector< QPair<bench::PARSER, QString> > files;
+    for (const QString & fn : cmdParser.values("mwc713"))
+        files.push_back( QPair<bench::PARSER, QString>(bench::PARSER::MWC713, fn) );
+    for (const QString & fn : cmdParser.values("node"))
+        files.push_back( QPair<bench::PARSER, QString>(bench::PARSER::NODE, fn) );
+
+    if (files.isEmpty()) {
+        const QString fixtures(BENCH_FIXTURES_DIR);
+        files.push_back( QPair<bench::PARSER, QString>(bench::PARSER::MWC713, fixtures + "/mwc713_outputs.log") );
+        files.push_back( QPair<bench::PARSER, QString>(bench::PARSER::MWC713, fixtures + "/mwc713_recovery.txt") );
+        files.push_back( QPair<bench::PARSER, QString>(bench::PARSER::NODE, fixtures + "/node_txhashset_sync.log") );
+    }
+
+    qInstallMessageHandler(bench::silentMessageHandler);
+    // Parsers are logging the events. Logs are disabled, nothing will be written on disk
+    logger::initLogger(false);
+
+    QTextStream out(stdout);
+    out << "Chunk size: " << chunkSize << ", repeat: " << repeat << ", allocations counter: " << ALLOC_COUNTER_NAME << "\n";
+
+    bool ok = true;
+    for (const auto & f : files) {
+        bench::Transcript transcript;
+        if (!bench::loadTranscript(f.first, f.second, transcript)) {
+            ok = false;
+            continue;
+        }
+
+        const bench::ReplayStats stats = bench::replay(transcript, chunkSize, repeat);
+
+        const double secs = std::max( double(stats.nsecs) / 1e9, 1e-9 );
+        const double mbps = double(stats.bytes) / 1e6 / secs;
+
+        out << "\n" << QFileInfo(transcript.fileName).fileName()
+            << (transcript.parser == bench::PARSER::MWC713 ? " [mwc713]" : " [mwc-node]") << "\n";
+        out << "  symbols:      " << stats.bytes << " in " << stats.chunks << " chunks\n";
+        out << "  time:         " << QString::number(secs*1000.0, 'f', 2) << " ms\n";
+        out << "  throughput:   " << QString::number(mbps, 'f', 2) << " MB/s\n";
+        out << "  events:       " << stats.events << ", " << QString::number(double(stats.events)/secs, 'f', 0) << " events/s\n";
+        out << "  allocations:  " << stats.allocations << ", "
+            << QString::number( double(stats.allocations) / std::max(qint64(1), stats.events), 'f', 2 ) << " per event\n";
+        out << "  hits:\n";
+        for (auto h = stats.hits.constBegin(); h != stats.hits.constEnd(); h++)
+            out << "    " << h.key() << " " << h.value()/repeat << "\n";
+
+        if (minMbps > 0.0 && mbps < minMbps) {
+            out << "  FAILED: throughput is below " << minMbps << " MB/s\n";
+            ok = false;
+        }
+
+        if (checkExpected) {
+            const QMap<QString, qint64> expected = bench::loadExpected(transcript.fileName);
+            if (!expected.isEmpty()) {
+                QMap<QString, qint64> hits;
+                for (auto h = stats.hits.constBegin(); h != stats.hits.constEnd(); h++)
+                    hits.insert( h.key(), h.value()/repeat );
+
+                if (hits != expected) {
+                    out << "  FAILED: hits distribution doesn't match " << transcript.fileName << ".expected\n";
+                    ok = false;
+                }
+                else {
+                    out << "  hits distribution matches the expected\n";
+                }
+            }
+        }
+    }
+
+    out.flush();
+    return ok ? 0 : 1;
+}
@@ -13,6 +13,8 @@
 // limitations under the License.
 
 #include "BridgeManager.h"
+#include "WalletSignalHub.h"
+#include "../state/state.h"
 
 namespace bridge {
 
@@ -25,4 +27,11 @@ BridgeManager *getBridgeManager() {
     return bridgeManager;
 }
 
+WalletSignalHub * BridgeManager::getWalletHub() {
+    if (walletHub==nullptr) {
+        walletHub = new WalletSignalHub( state::getStateContext()->wallet );
+    }
+    return walletHub;
+}
+
 }
\ No newline at end of file
@@ -38,6 +38,7 @@ class NewSeed;
 class WalletConfig;
 class CoreWindow;
 class SelectMode;
+class WalletSignalHub;
 
 // Because many instances of bridges might exist, we need some place to map them.
 // Please use getBridgeManager to access a singletone.
@@ -118,6 +119,9 @@ public:
     void addSelectMode( bridge::SelectMode * b ) {selectMode += b;}
     void removeSelectMode( bridge::SelectMode * b ) {selectMode -= b;}
     const QSet<SelectMode*> & getSelectMode() const {return selectMode;}
+
+    // Wallet signals dispatcher for all bridge::Wallet instances. Created on first request.
+    WalletSignalHub * getWalletHub();
 private:
     QSet<ProgressWnd*>      progressWnd;
     QSet<InputPassword*>    inputPassword;
@@ -139,6 +143,8 @@ private:
     QSet<CoreWindow*>       coreWindow;
     QSet<SelectMode*>       selectMode;
 
+    WalletSignalHub *       walletHub = nullptr;
+
 };
 
 BridgeManager * getBridgeManager();
@@ -0,0 +1,248 @@
+// Copyright 2020 The MWC Developers
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "WalletSignalHub.h"
+#include "wallet_b.h"
+#include "../wallet/walletsnapshot.h"
+
+namespace bridge {
+
+WalletSignalHub::WalletSignalHub(wallet::Wallet * wallet) {
+    Q_ASSERT(wallet);
+
+    QObject::connect(notify::Notification::getObject2Notify(), &notify::Notification::onNewNotificationMessage,
+                     this, &WalletSignalHub::onNewNotificationMessage, Qt::QueuedConnection);
+
+    QObject::connect(wallet, &wallet::Wallet::onStartingCommand,
+                     this, &WalletSignalHub::onStartingCommand, Qt::QueuedConnection);
+    QObject::connect(wallet, &wallet::Wallet::onConfigUpdate,
+                     this, &WalletSignalHub::onConfigUpdate, Qt::QueuedConnection);
+
+    QObject::connect(wallet, &wallet::Wallet::onListenersStatus,
+                     this, &WalletSignalHub::onUpdateListenerStatus, Qt::QueuedConnection);
+    QObject::connect(wallet, &wallet::Wallet::onListeningStartResults,
+                     this, &WalletSignalHub::onListeningStartResults, Qt::QueuedConnection);
+    QObject::connect(wallet, &wallet::Wallet::onListeningStopResult,
+                     this, &WalletSignalHub::onListeningStopResult, Qt::QueuedConnection);
+    QObject::connect(wallet, &wallet::Wallet::onHttpListeningStatus,
+                     this, &WalletSignalHub::onHttpListeningStatus, Qt::QueuedConnection);
+
+    QObject::connect(wallet, &wallet::Wallet::onNodeStatus,
+                     this, &WalletSignalHub::onUpdateNodeStatus, Qt::QueuedConnection);
+
+    QObject::connect(wallet, &wallet::Wallet::onUpdateSyncProgress,
+                     this, &WalletSignalHub::onUpdateSyncProgress, Qt::QueuedConnection);
+
+    QObject::connect(wallet, &wallet::Wallet::onWalletBalanceUpdated,
+                     this, &WalletSignalHub::onWalletBalanceUpdated, Qt::QueuedConnection);
+    QObject::connect(wallet, &wallet::Wallet::onLoginResult,
+                     this, &WalletSignalHub::onLoginResult, Qt::QueuedConnection);
+    QObject::connect(wallet, &wallet::Wallet::onLogout,
+                     this, &WalletSignalHub::onLogout, Qt::QueuedConnection);
+    QObject::connect(wallet, &wallet::Wallet::onMwcAddressWithIndex,
+                     this, &WalletSignalHub::onMwcAddressWithIndex, Qt::QueuedConnection);
+    QObject::connect(wallet, &wallet::Wallet::onTorAddress,
+                     this, &WalletSignalHub::onTorAddress, Qt::QueuedConnection);
+    QObject::connect(wallet, &wallet::Wallet::onFileProofAddress,
+                     this, &WalletSignalHub::onFileProofAddress, Qt::QueuedConnection);
+
+    QObject::connect(wallet, &wallet::Wallet::onOutputs,
+                     this, &WalletSignalHub::onOutputs, Qt::QueuedConnection);
+    QObject::connect(wallet, &wallet::Wallet::onTransactions,
+                     this, &WalletSignalHub::onTransactions, Qt::QueuedConnection);
+    QObject::connect(wallet, &wallet::Wallet::onTransactionsDelta,
+                     this, &WalletSignalHub::onTransactionsDelta, Qt::QueuedConnection);
+    QObject::connect(wallet, &wallet::Wallet::onOutputsDelta,
+                     this, &WalletSignalHub::onOutputsDelta, Qt::QueuedConnection);
+    QObject::connect(wallet, &wallet::Wallet::onCancelTransacton,
+                     this, &WalletSignalHub::onCancelTransacton, Qt::QueuedConnection);
+    QObject::connect(wallet, &wallet::Wallet::onTransactionById,
+                     this, &WalletSignalHub::onTransactionById, Qt::QueuedConnection);
+
+    QObject::connect(wallet, &wallet::Wallet::onExportProof,
+                     this, &WalletSignalHub::onExportProof, Qt::QueuedConnection);
+    QObject::connect(wallet, &wallet::Wallet::onVerifyProof,
+                     this, &WalletSignalHub::onVerifyProof, Qt::QueuedConnection);
+
+    QObject::connect(wallet, &wallet::Wallet::onNodeStatus,
+                     this, &WalletSignalHub::onNodeStatus, Qt::QueuedConnection);
+
+    QObject::connect(wallet, &wallet::Wallet::onAccountCreated,
+                     this, &WalletSignalHub::onAccountCreated, Qt::QueuedConnection);
+    QObject::connect(wallet, &wallet::Wallet::onAccountRenamed,
+                     this, &WalletSignalHub::onAccountRenamed, Qt::QueuedConnection);
+    QObject::connect(wallet, &wallet::Wallet::onRepost,
+                     this, &WalletSignalHub::onRepost, Qt::QueuedConnection);
+    QObject::connect(wallet, &wallet::Wallet::onDecodeSlatepack,
+                     this, &WalletSignalHub::onDecodeSlatepack, Qt::QueuedConnection);
+    QObject::connect(wallet, &wallet::Wallet::onFinalizeSlatepack,
+                     this, &WalletSignalHub::onFinalizeSlatepack, Qt::QueuedConnection);
+}
+
+void WalletSignalHub::subscribe( bridge::Wallet * b ) {
+    Q_ASSERT(b);
+    if (!subscribers.contains(b))
+        subscribers.push_back(b);
+}
+
+void WalletSignalHub::unsubscribe( bridge::Wallet * b ) {
+    subscribers.removeAll(b);
+}
+
+void WalletSignalHub::onStartingCommand(QString actionName) {
+    deliver([&](Wallet * b) {b->onStartingCommand(actionName);});
+}
+
+void WalletSignalHub::onNewNotificationMessage(notify::MESSAGE_LEVEL level, QString message) {
+    deliver([&](Wallet * b) {b->onNewNotificationMessage(level, message);});
+}
+
+void WalletSignalHub::onConfigUpdate() {
+    deliver([&](Wallet * b) {b->onConfigUpdate();});
+}
+
+void WalletSignalHub::onListeningStartResults( bool mqTry, bool tor, QStringList errorMessages, bool initialStart ) {
+    deliver([&](Wallet * b) {b->onListeningStartResults(mqTry, tor, errorMessages, initialStart);});
+}
+
+void WalletSignalHub::onListeningStopResult(bool mqTry, bool tor, QStringList errorMessages ) {
+    deliver([&](Wallet * b) {b->onListeningStopResult(mqTry, tor, errorMessages);});
+}
+
+void WalletSignalHub::onUpdateListenerStatus(bool mqsOnline, bool torOnline) {
+    deliver([&](Wallet * b) {b->onUpdateListenerStatus(mqsOnline, torOnline);});
+}
+
+void WalletSignalHub::onHttpListeningStatus(bool listening, QString additionalInfo) {
+    deliver([&](Wallet * b) {b->onHttpListeningStatus(listening, additionalInfo);});
+}
+
+void WalletSignalHub::onUpdateNodeStatus( bool online, QString errMsg, int nodeHeight, int peerHeight, int64_t totalDifficulty, int connections ) {
+    deliver([&](Wallet * b) {b->onUpdateNodeStatus(online, errMsg, nodeHeight, peerHeight, totalDifficulty, connections);});
+}
+
+void WalletSignalHub::onUpdateSyncProgress(double progressPercent) {
+    deliver([&](Wallet * b) {b->onUpdateSyncProgress(progressPercent);});
+}
+
+void WalletSignalHub::onWalletBalanceUpdated() {
+    deliver([&](Wallet * b) {b->onWalletBalanceUpdated();});
+}
+
+void WalletSignalHub::onLoginResult(bool ok) {
+    deliver([&](Wallet * b) {b->onLoginResult(ok);});
+}
+
+void WalletSignalHub::onLogout() {
+    deliver([&](Wallet * b) {b->onLogout();});
+}
+
+void WalletSignalHub::onMwcAddressWithIndex(QString mwcAddress, int idx) {
+    deliver([&](Wallet * b) {b->onMwcAddressWithIndex(mwcAddress, idx);});
+}
+
+void WalletSignalHub::onTorAddress(QString tor) {
+    deliver([&](Wallet * b) {b->onTorAddress(tor);});
+}
+
+void WalletSignalHub::onFileProofAddress(QString address) {
+    deliver([&](Wallet * b) {b->onFileProofAddress(address);});
+}
+
+void WalletSignalHub::onOutputs( QString account, bool showSpent, int64_t height, QVector<wallet::WalletOutput> outputs, QString cookie) {
+    // One snapshot for all subscribers
+    const wallet::OutputsSnapshot snapshot(account, showSpent, height, outputs);
+    deliver([&](Wallet * b) {
+        if (b->acceptData(account, cookie))
+            b->deliverOutputs(snapshot, cookie);
+    });
+}
+
+void WalletSignalHub::onTransactions( QString account, int64_t height, QVector<wallet::WalletTransaction> transactions, QString cookie) {
+    const wallet::TransactionsSnapshot snapshot(account, height, transactions);
+    deliver([&](Wallet * b) {
+        if (b->acceptData(account, cookie))
+            b->deliverTransactions(snapshot, cookie);
+    });
+}
+
+void WalletSignalHub::onTransactionsDelta( wallet::TransactionsDelta delta ) {
+    deliver([&](Wallet * b) {
+        if (b->acceptData(delta.account, ""))
+            b->deliverTransactionsDelta(delta);
+    });
+}
+
+void WalletSignalHub::onOutputsDelta( wallet::OutputsDelta delta ) {
+    deliver([&](Wallet * b) {
+        if (b->acceptData(delta.account, ""))
+            b->deliverOutputsDelta(delta);
+    });
+}
+
+void WalletSignalHub::onCancelTransacton( bool success, QString account, int64_t trIdx, QString errMessage ) {
+    deliver([&](Wallet * b) {
+        if (b->acceptData(account, ""))
+            b->onCancelTransacton(success, account, trIdx, errMessage);
+    });
+}
+
+void WalletSignalHub::onTransactionById( bool success, QString account, int64_t height, wallet::WalletTransaction transaction,
+                                         QVector<wallet::WalletOutput> outputs, QVector<QString> messages ) {
+    const wallet::TransactionsSnapshot snapshot(account, height, {transaction}, outputs);
+    deliver([&](Wallet * b) {
+        if (b->acceptData(account, ""))
+            b->deliverTransactionById(success, snapshot, messages);
+    });
+}
+
+void WalletSignalHub::onExportProof( bool success, QString fn, QString msg ) {
+    deliver([&](Wallet * b) {b->onExportProof(success, fn, msg);});
+}
+
+void WalletSignalHub::onVerifyProof( bool success, QString fn, QString msg ) {
+    deliver([&](Wallet * b) {b->onVerifyProof(success, fn, msg);});
+}
+
+void WalletSignalHub::onNodeStatus( bool online, QString errMsg, int nodeHeight, int peerHeight, int64_t totalDifficulty, int connections ) {
+    deliver([&](Wallet * b) {b->onNodeStatus(online, errMsg, nodeHeight, peerHeight, totalDifficulty, connections);});
+}
+
+void WalletSignalHub::onAccountCreated( QString newAccountName) {
+    deliver([&](Wallet * b) {b->onAccountCreated(newAccountName);});
+}
+
+void WalletSignalHub::onAccountRenamed(bool success, QString errorMessage) {
+    deliver([&](Wallet * b) {b->onAccountRenamed(success, errorMessage);});
+}
+
+void WalletSignalHub::onRepost(int txIdx, QString err) {
+    deliver([&](Wallet * b) {b->onRepost(txIdx, err);});
+}
+
+void WalletSignalHub::onDecodeSlatepack( QString tag, QString error, QString slatepack, QString slateJSon, QString content, QString sender, QString recipient ) {
+    deliver([&](Wallet * b) {
+        if (b->acceptData("", tag))
+            b->onDecodeSlatepack(tag, error, slatepack, slateJSon, content, sender, recipient);
+    });
+}
+
+void WalletSignalHub::onFinalizeSlatepack( QString tagId, QString error, QString txUuid ) {
+    deliver([&](Wallet * b) {
+        if (b->acceptData("", tagId))
+            b->onFinalizeSlatepack(tagId, error, txUuid);
+    });
+}
+
+}
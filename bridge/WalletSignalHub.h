@@ -0,0 +1,91 @@
+// Copyright 2020 The MWC Developers
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MWC_QT_WALLET_WALLETSIGNALHUB_H
+#define MWC_QT_WALLET_WALLETSIGNALHUB_H
+
+#include <QObject>
+#include <QList>
+#include "../core/Notification.h"
+#include "../wallet/wallet.h"
+
+namespace bridge {
+
+class Wallet;
+
+// Single receiver of the wallet::Wallet signals for all bridge::Wallet instances.
+// There are many bridge::Wallet objects (every window and state has one). Instead of every
+// instance connecting to every wallet signal, the hub get each signal once and calls
+// the subscribers directly. Heavy data (outputs, transactions) is delivered only to the
+// subscribers that are listening for it and accept the account and tag, see bridge::Wallet filters.
+// Lives at the main thread, owned by BridgeManager.
+class WalletSignalHub : public QObject {
+    Q_OBJECT
+public:
+    WalletSignalHub(wallet::Wallet * wallet);
+
+    void subscribe( bridge::Wallet * b );
+    void unsubscribe( bridge::Wallet * b );
+
+private:
+    // Call f for every subscriber. Subscribers can be deleted while we are calling them
+    // (QML handlers are direct), so iterating a copy and checking that it is still here.
+    template <class F>
+    void deliver(F f) {
+        const QList<bridge::Wallet *> subs = subscribers;
+        for (auto b : subs) {
+            if (subscribers.contains(b))
+                f(b);
+        }
+    }
+
+private slots:
+    void onStartingCommand(QString actionName);
+    void onNewNotificationMessage(notify::MESSAGE_LEVEL level, QString message);
+    void onConfigUpdate();
+    void onListeningStartResults( bool mqTry, bool tor, QStringList errorMessages, bool initialStart );
+    void onListeningStopResult(bool mqTry, bool tor, QStringList errorMessages );
+    void onUpdateListenerStatus(bool mqsOnline, bool torOnline);
+    void onHttpListeningStatus(bool listening, QString additionalInfo);
+    void onUpdateNodeStatus( bool online, QString errMsg, int nodeHeight, int peerHeight, int64_t totalDifficulty, int connections );
+    void onUpdateSyncProgress(double progressPercent);
+    void onWalletBalanceUpdated();
+    void onLoginResult(bool ok);
+    void onLogout();
+    void onMwcAddressWithIndex(QString mwcAddress, int idx);
+    void onTorAddress(QString tor);
+    void onFileProofAddress(QString address);
+    void onOutputs( QString account, bool showSpent, int64_t height, QVector<wallet::WalletOutput> outputs, QString cookie);
+    void onTransactions( QString account, int64_t height, QVector<wallet::WalletTransaction> transactions, QString cookie);
+    void onTransactionsDelta( wallet::TransactionsDelta delta );
+    void onOutputsDelta( wallet::OutputsDelta delta );
+    void onCancelTransacton( bool success, QString account, int64_t trIdx, QString errMessage );
+    void onTransactionById( bool success, QString account, int64_t height, wallet::WalletTransaction transaction,
+                            QVector<wallet::WalletOutput> outputs, QVector<QString> messages );
+    void onExportProof( bool success, QString fn, QString msg );
+    void onVerifyProof( bool success, QString fn, QString msg );
+    void onNodeStatus( bool online, QString errMsg, int nodeHeight, int peerHeight, int64_t totalDifficulty, int connections );
+    void onAccountCreated( QString newAccountName);
+    void onAccountRenamed(bool success, QString errorMessage);
+    void onRepost(int txIdx, QString err);
+    void onDecodeSlatepack( QString tag, QString error, QString slatepack, QString slateJSon, QString content, QString sender, QString recipient );
+    void onFinalizeSlatepack( QString tagId, QString error, QString txUuid );
+
+private:
+    QList<bridge::Wallet *> subscribers;
+};
+
+}
+
+#endif //MWC_QT_WALLET_WALLETSIGNALHUB_H
@@ -16,6 +16,11 @@
 #include "../core/Notification.h"
 #include "../state/state.h"
 #include "../wallet/wallet.h"
+#include "../wallet/historystore.h"
+#include "BridgeManager.h"
+#include "WalletSignalHub.h"
+#include <QJsonDocument>
+#include <QMetaMethod>
 
 
 namespace bridge {
@@ -25,76 +30,32 @@ static wallet::Wallet * getWallet() {
 }
 
 Wallet::Wallet(QObject *parent) : QObject(parent) {
+    // Wallet signals are coming through the hub, it is much cheaper than connecting every instance
+    getBridgeManager()->getWalletHub()->subscribe(this);
+}
+
+Wallet::~Wallet() {
+    getBridgeManager()->getWalletHub()->unsubscribe(this);
+}
+
+// Delivery filter for account related data. Empty - accept all
+void Wallet::setAccountFilter(QString account) {
+    accountFilter = account;
+}
+
+// Delivery filter for the cookie/tag of the requests. Empty - accept all
+void Wallet::setTagFilter(QString tag) {
+    tagFilter = tag;
+}
+
+bool Wallet::acceptData(const QString & account, const QString & tag) const {
+    if (!accountFilter.isEmpty() && !account.isEmpty() && account != accountFilter)
+        return false;
+    if (!tagFilter.isEmpty() && !tag.isEmpty() && tag != tagFilter)
+        return false;
+    return true;
+}
 
-    QObject::connect(notify::Notification::getObject2Notify(), &notify::Notification::onNewNotificationMessage,
-                     this, &Wallet::onNewNotificationMessage, Qt::QueuedConnection);
-
-    wallet::Wallet *wallet = state::getStateContext()->wallet;
-
-    QObject::connect(wallet, &wallet::Wallet::onStartingCommand,
-                     this, &Wallet::onStartingCommand, Qt::QueuedConnection);
-    QObject::connect(wallet, &wallet::Wallet::onConfigUpdate,
-                     this, &Wallet::onConfigUpdate, Qt::QueuedConnection);
-
-    QObject::connect(wallet, &wallet::Wallet::onListenersStatus,
-                     this, &Wallet::onUpdateListenerStatus, Qt::QueuedConnection);
-    QObject::connect(wallet, &wallet::Wallet::onListeningStartResults,
-                     this, &Wallet::onListeningStartResults, Qt::QueuedConnection);
-    QObject::connect(wallet, &wallet::Wallet::onListeningStopResult,
-                     this, &Wallet::onListeningStopResult, Qt::QueuedConnection);
-    QObject::connect(wallet, &wallet::Wallet::onHttpListeningStatus,
-                     this, &Wallet::onHttpListeningStatus, Qt::QueuedConnection);
-
-    QObject::connect(wallet, &wallet::Wallet::onNodeStatus,
-                     this, &Wallet::onUpdateNodeStatus, Qt::QueuedConnection);
-
-    QObject::connect(wallet, &wallet::Wallet::onUpdateSyncProgress,
-                     this, &Wallet::onUpdateSyncProgress, Qt::QueuedConnection);
-
-    QObject::connect(wallet, &wallet::Wallet::onWalletBalanceUpdated,
-                     this, &Wallet::onWalletBalanceUpdated, Qt::QueuedConnection);
-    QObject::connect(wallet, &wallet::Wallet::onLoginResult,
-                     this, &Wallet::onLoginResult, Qt::QueuedConnection);
-    QObject::connect(wallet, &wallet::Wallet::onLogout,
-                     this, &Wallet::onLogout, Qt::QueuedConnection);
-    QObject::connect(wallet, &wallet::Wallet::onMwcAddressWithIndex,
-                     this, &Wallet::onMwcAddressWithIndex, Qt::QueuedConnection);
-    QObject::connect(wallet, &wallet::Wallet::onTorAddress,
-                     this, &Wallet::onTorAddress, Qt::QueuedConnection);
-    QObject::connect(wallet, &wallet::Wallet::onFileProofAddress,
-                     this, &Wallet::onFileProofAddress, Qt::QueuedConnection);
-
-    QObject::connect(wallet, &wallet::Wallet::onOutputs,
-                     this, &Wallet::onOutputs, Qt::QueuedConnection);
-    QObject::connect(wallet, &wallet::Wallet::onTransactions,
-                     this, &Wallet::onTransactions, Qt::QueuedConnection);
-    QObject::connect(wallet, &wallet::Wallet::onCancelTransacton,
-                     this, &Wallet::onCancelTransacton, Qt::QueuedConnection);
-    QObject::connect(wallet, &wallet::Wallet::onTransactionById,
-                     this, &Wallet::onTransactionById, Qt::QueuedConnection);
-
-
-    QObject::connect(wallet, &wallet::Wallet::onExportProof,
-                     this, &Wallet::onExportProof, Qt::QueuedConnection);
-    QObject::connect(wallet, &wallet::Wallet::onVerifyProof,
-                     this, &Wallet::onVerifyProof, Qt::QueuedConnection);
-
-    QObject::connect(wallet, &wallet::Wallet::onNodeStatus,
-                     this, &Wallet::onNodeStatus, Qt::QueuedConnection);
-
-    QObject::connect(wallet, &wallet::Wallet::onAccountCreated,
-                     this, &Wallet::onAccountCreated, Qt::QueuedConnection);
-    QObject::connect(wallet, &wallet::Wallet::onAccountRenamed,
-                     this, &Wallet::onAccountRenamed, Qt::QueuedConnection);
-    QObject::connect(wallet, &wallet::Wallet::onRepost,
-                     this, &Wallet::onRepost, Qt::QueuedConnection);
-    QObject::connect(wallet, &wallet::Wallet::onDecodeSlatepack,
-                     this, &Wallet::onDecodeSlatepack, Qt::QueuedConnection);
-    QObject::connect(wallet, &wallet::Wallet::onFinalizeSlatepack,
-                     this, &Wallet::onFinalizeSlatepack, Qt::QueuedConnection);
-}
-
-Wallet::~Wallet() {}
 
 void Wallet::onStartingCommand(QString actionName) {
     emit sgnStartingCommand(actionName);
@@ -163,31 +124,40 @@ void Wallet::onFileProofAddress(QString address) {
     emit sgnFileProofAddress(address);
 }
 
-void Wallet::onOutputs( QString account, bool showSpent, int64_t height, QVector<wallet::WalletOutput> outputs) {
-    QVector<QString> outs;
-    for (const auto & o : outputs) {
-        outs.push_back( o.toJson() );
-    }
-    emit sgnOutputs( account, showSpent, QString::number(height), outs);
+void Wallet::deliverOutputs( const wallet::OutputsSnapshot & outputs, const QString & cookie) {
+    if (isSignalConnected(QMetaMethod::fromSignal(&Wallet::sgnOutputsSnapshot)))
+        emit sgnOutputsSnapshot(outputs, cookie);
+
+    if (isSignalConnected(QMetaMethod::fromSignal(&Wallet::sgnOutputs)))
+        emit sgnOutputs( outputs.getAccount(), outputs.isShowSpent(), QString::number(outputs.getHeight()), outputs.outputsToJson(), cookie);
 }
 
-void Wallet::onTransactions( QString account, int64_t height, QVector<wallet::WalletTransaction> transactions) {
-    QVector<QString> trans;
-    for (auto & t : transactions)
-        trans.push_back(t.toJson());
+void Wallet::deliverTransactions( const wallet::TransactionsSnapshot & transactions, const QString & cookie) {
+    if (isSignalConnected(QMetaMethod::fromSignal(&Wallet::sgnTransactionsSnapshot)))
+        emit sgnTransactionsSnapshot(transactions, cookie);
 
-    emit sgnTransactions( account, QString::number(height), trans);
+    if (isSignalConnected(QMetaMethod::fromSignal(&Wallet::sgnTransactions)))
+        emit sgnTransactions( transactions.getAccount(), QString::number(transactions.getHeight()), transactions.transactionsToJson(), cookie);
 }
 void Wallet::onCancelTransacton( bool success, QString account, int64_t trIdx, QString errMessage ) {
     emit sgnCancelTransacton(success, account, QString::number(trIdx), errMessage);
 }
-void Wallet::onTransactionById( bool success, QString account, int64_t height, wallet::WalletTransaction transaction,
-                        QVector<wallet::WalletOutput> outputs, QVector<QString> messages ) {
-    QVector<QString> outs;
-    for (const auto & o : outputs)
-        outs.push_back(o.toJson());
+void Wallet::deliverTransactionById( bool success, const wallet::TransactionsSnapshot & details, const QVector<QString> & messages ) {
+    if (isSignalConnected(QMetaMethod::fromSignal(&Wallet::sgnTransactionByIdSnapshot)))
+        emit sgnTransactionByIdSnapshot(success, details, messages);
+
+    if (isSignalConnected(QMetaMethod::fromSignal(&Wallet::sgnTransactionById))) {
+        const QString txJson = details.getTransactions().isEmpty() ? wallet::WalletTransaction().toJson() : details.getTransactions().first().toJson();
+        emit sgnTransactionById(success, details.getAccount(), QString::number(details.getHeight()), txJson, details.outputsToJson(), messages);
+    }
+}
+
+void Wallet::deliverTransactionsDelta( const wallet::TransactionsDelta & delta ) {
+    emit sgnTransactionsDelta(delta);
+}
 
-    emit sgnTransactionById(success, account, QString::number(height), transaction.toJson(), outs, messages);
+void Wallet::deliverOutputsDelta( const wallet::OutputsDelta & delta ) {
+    emit sgnOutputsDelta(delta);
 }
 
 void Wallet::onExportProof( bool success, QString fn, QString msg ) {
@@ -364,14 +334,14 @@ void Wallet::requestWalletBalanceUpdate() {
 
 // Request list of outputs for the account.
 // Respond will be with sgnOutputs
-void Wallet::requestOutputs(QString account, bool show_spent, bool enforceSync) {
-    getWallet()->getOutputs(account,show_spent, enforceSync);
+void Wallet::requestOutputs(QString account, bool show_spent, bool enforceSync, QString cookie) {
+    getWallet()->getOutputs(account,show_spent, enforceSync, cookie);
 }
 
 // Show all transactions for current account
-// Respond: sgnTransactions( QString account, QString height, QVector<QString> Transactions);
-void Wallet::requestTransactions(QString account, bool enforceSync) {
-    getWallet()->getTransactions(account, enforceSync);
+// Respond: sgnTransactions( QString account, QString height, QVector<QString> Transactions, QString cookie);
+void Wallet::requestTransactions(QString account, bool enforceSync, QString cookie) {
+    getWallet()->getTransactions(account, enforceSync, cookie);
 }
 
 // get Extended info for specific transaction
@@ -381,6 +351,27 @@ void Wallet::requestTransactionById(QString account, QString txIdxOrUUID ) {
     getWallet()->getTransactionById(account, txIdxOrUUID );
 }
 
+// Search over the local transactions history.
+// Return: number of matched transactions, then transactions of the requested page
+QVector<QString> Wallet::searchTransactions(QString queryJson) {
+    wallet::HistoryQueryResult found = searchTransactions( wallet::HistoryQuery::fromJson(queryJson) );
+    if (!found.error.isEmpty())
+        return {"-1", found.error};
+    QVector<QString> result;
+    result.push_back( QString::number(found.total) );
+    for (const auto & tx : found.transactions)
+        result.push_back( tx.toJson() );
+    return result;
+}
+
+wallet::HistoryQueryResult Wallet::searchTransactions(const wallet::HistoryQuery & query) {
+    return getWallet()->searchHistory(query);
+}
+
+QVector<wallet::WalletTransaction> Wallet::getStoredTransactions(QString account) {
+    return getWallet()->getHistoryStore().getTransactions(account);
+}
+
 // Cancel transaction by id
 // Respond: sgnCancelTransacton( bool success, QString trIdx, QString errMessage )
 void Wallet::requestCancelTransacton(QString account, QString txIdx) {
@@ -414,6 +405,21 @@ bool Wallet::requestNodeStatus() {
     return getWallet()->getNodeStatus();
 }
 
+// Height of the cached balances/transactions that are shown right after login until the first refresh.
+int Wallet::getWarmStartHeight() {
+    return int(getWallet()->getWarmStartHeight());
+}
+
+// Get mwc713 task engine metrics as json string
+QString Wallet::getTaskMetrics() {
+    return QJsonDocument( getWallet()->getTaskMetrics() ).toJson(QJsonDocument::JsonFormat::Compact);
+}
+
+// Dump mwc713 task engine metrics into the json file.
+QString Wallet::dumpTaskMetrics(QString fileName) {
+    return getWallet()->dumpTaskMetrics(fileName);
+}
+
 // Create another account, note no delete exist for accounts
 // Check Signal:  sgnAccountCreated
 void Wallet::createAccount( QString accountName ) {
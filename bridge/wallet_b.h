@@ -22,15 +22,28 @@
 #include <QObject>
 #include "../core/Notification.h"
 #include "../wallet/wallet.h"
+#include "../wallet/walletsnapshot.h"
 
 namespace bridge {
 
+class WalletSignalHub;
+
+// Wallet signals are delivered by WalletSignalHub. Heavy data (outputs, transactions) is built
+// only for the signals that are connected. Use account/tag filters to get only the data you need.
 class Wallet : public QObject {
     Q_OBJECT
+    friend class WalletSignalHub;
 public:
     explicit Wallet(QObject * parent = nullptr);
     ~Wallet();
 
+    // Delivery filter for account related data: outputs, transactions, transaction details, cancel results.
+    // Empty - accept all (default)
+    Q_INVOKABLE void setAccountFilter(QString account);
+    // Delivery filter for the cookie/tag of the requests: outputs, transactions, slatepack results.
+    // Empty - accept all (default)
+    Q_INVOKABLE void setTagFilter(QString tag);
+
     // return true if MQS is online
     Q_INVOKABLE bool getMqsListenerStatus();
     Q_INVOKABLE bool getKeybaseListenerStatus(); // Absolete
@@ -82,6 +95,10 @@ public:
     // Return: signal  sgnFileProofAddress
     Q_INVOKABLE void requestFileProofAddress();
 
+    // Height of the cached balances/transactions that are shown right after login until the first refresh.
+    // -1 if data is fresh
+    Q_INVOKABLE int getWarmStartHeight();
+
     // Request accounts info
     // includeAccountName - add Account names
     // includeSpendableInfo - add String about Spendables
@@ -97,18 +114,32 @@ public:
     Q_INVOKABLE void requestWalletBalanceUpdate();
 
     // Request list of outputs for the account.
-    // Respond will be with sgnOutputs
-    Q_INVOKABLE void requestOutputs(QString account, bool show_spent, bool enforceSync);
+    // cookie - requester tag, will be returned with the result
+    // Respond will be with sgnOutputs and sgnOutputsSnapshot
+    Q_INVOKABLE void requestOutputs(QString account, bool show_spent, bool enforceSync, QString cookie = "");
 
     // Show all transactions for current account
-    // Respond: sgnTransactions( QString account, QString height, QVector<QString> Transactions);
-    Q_INVOKABLE void requestTransactions(QString account, bool enforceSync);
+    // cookie - requester tag, will be returned with the result
+    // Respond: sgnTransactions( QString account, QString height, QVector<QString> Transactions, QString cookie);
+    //          sgnTransactionsSnapshot( wallet::TransactionsSnapshot transactions, QString cookie);
+    Q_INVOKABLE void requestTransactions(QString account, bool enforceSync, QString cookie = "");
 
     // get Extended info for specific transaction
     // Respond:  sgnTransactionById( bool success, QString account, QString height, QString transaction,
     //                            QVector<QString> outputs, QVector<QString> messages );
+    //           sgnTransactionByIdSnapshot( bool success, wallet::TransactionsSnapshot details, QVector<QString> messages );
     Q_INVOKABLE void requestTransactionById(QString account, QString txIdxOrUUID );
 
+    // Search over the local transactions history, the result is returned right away.
+    // queryJson - wallet::HistoryQuery::fromJson format
+    // Return: number of matched transactions, then transactions of the requested page (WalletTransaction::toJson)
+    //         "-1" and the error message if local history is not available
+    Q_INVOKABLE QVector<QString> searchTransactions(QString queryJson);
+    // The same for desktop
+    wallet::HistoryQueryResult searchTransactions(const wallet::HistoryQuery & query);
+    // All transactions of the account from the local history, in txIdx order. Empty if history is not available.
+    QVector<wallet::WalletTransaction> getStoredTransactions(QString account);
+
     // Cancel transaction by id
     // Respond: sgnCancelTransacton( bool success, QString trIdx, QString errMessage )
     Q_INVOKABLE void requestCancelTransacton(QString account, QString txIdx);
@@ -132,6 +163,12 @@ public:
     // Respond: sgnNodeStatus( bool online, QString errMsg, int nodeHeight, int peerHeight, int64_t totalDifficulty, int connections )
     Q_INVOKABLE bool requestNodeStatus();
 
+    // Get mwc713 task engine metrics as json string: latency histograms by task and queue depth by priority
+    Q_INVOKABLE QString getTaskMetrics();
+    // Dump mwc713 task engine metrics into the json file.
+    // Return error message or empty string on success
+    Q_INVOKABLE QString dumpTaskMetrics(QString fileName);
+
     // Create another account, note no delete exist for accounts
     // Check Signal:  sgnAccountCreated
     Q_INVOKABLE void createAccount( QString accountName );
@@ -182,16 +219,25 @@ signals:
 
     // Outputs requested form the wallet.
     // outputs are in Json format, see wallet::WalletOutput for details
-    void sgnOutputs( QString account, bool showSpent, QString height, QVector<QString> outputs);
+    // Json is built only if somebody (QML) is connected to this signal
+    void sgnOutputs( QString account, bool showSpent, QString height, QVector<QString> outputs, QString cookie);
+    // The same outputs as a shared snapshot, no data conversion. For C++ windows.
+    void sgnOutputsSnapshot( wallet::OutputsSnapshot outputs, QString cookie);
 
     //  Transactions from the requestTransactions request
     // Transactions are in Json format, see wallet::WalletTransaction for details
-    void sgnTransactions( QString account, QString height, QVector<QString> transactions);
+    void sgnTransactions( QString account, QString height, QVector<QString> transactions, QString cookie);
+    void sgnTransactionsSnapshot( wallet::TransactionsSnapshot transactions, QString cookie);
     // Transaction from getTransactionById request
     // transaction: JSON for wallet::WalletTransaction
     // outputs: JSON for  wallet::WalletOutput
     void sgnTransactionById( bool success, QString account, QString height, QString transaction,
                             QVector<QString> outputs, QVector<QString> messages );
+    // details: single transaction and its outputs
+    void sgnTransactionByIdSnapshot( bool success, wallet::TransactionsSnapshot details, QVector<QString> messages );
+    // Changes since the previous listing, emitted on every refresh (no matter who requested it). For C++ windows.
+    void sgnTransactionsDelta( wallet::TransactionsDelta delta );
+    void sgnOutputsDelta( wallet::OutputsDelta delta );
     // Respond from cancelTransacton
     void sgnCancelTransacton( bool success, QString account, QString trIdx, QString errMessage );
 
@@ -237,12 +283,7 @@ private slots:
     void onMwcAddressWithIndex(QString mwcAddress, int idx);
     void onTorAddress(QString tor);
     void onFileProofAddress(QString address);
-    void onOutputs( QString account, bool showSpent, int64_t height, QVector<wallet::WalletOutput> outputs);
-
-    void onTransactions( QString account, int64_t height, QVector<wallet::WalletTransaction> Transactions);
     void onCancelTransacton( bool success, QString account, int64_t trIdx, QString errMessage );
-    void onTransactionById( bool success, QString account, int64_t height, wallet::WalletTransaction transaction,
-                                QVector<wallet::WalletOutput> outputs, QVector<QString> messages );
 
     void onExportProof( bool success, QString fn, QString msg );
     void onVerifyProof( bool success, QString fn, QString msg );
@@ -256,6 +297,19 @@ private slots:
     void onDecodeSlatepack( QString tag, QString error, QString slatepack, QString slateJSon, QString content, QString sender, QString recipient );
 
     void onFinalizeSlatepack( QString tagId, QString error, QString txUuid );
+
+private:
+    bool acceptData(const QString & account, const QString & tag) const;
+
+    void deliverOutputs( const wallet::OutputsSnapshot & outputs, const QString & cookie);
+    void deliverTransactions( const wallet::TransactionsSnapshot & transactions, const QString & cookie);
+    void deliverTransactionById( bool success, const wallet::TransactionsSnapshot & details, const QVector<QString> & messages );
+    void deliverTransactionsDelta( const wallet::TransactionsDelta & delta );
+    void deliverOutputsDelta( const wallet::OutputsDelta & delta );
+
+private:
+    QString accountFilter;
+    QString tagFilter;
 };
 
 }
@@ -0,0 +1,468 @@
+// Copyright 2020 The MWC Developers
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "richlistview.h"
+#include <QPainter>
+#include <QMouseEvent>
+#include <QKeyEvent>
+#include <QHelpEvent>
+#include <QToolTip>
+#include <QFontMetrics>
+
+namespace control {
+
+const int ROW_GAP = 5;      // Space between the rows, RichVBox has the same
+const int CELL_SPACING = 4;
+const int RIGHT_MARGIN = 3; // RichVBox has it because of the scroll bar
+const int BUTTON_FONT = 10;
+
+const QColor ROW_BG_COLOR( 255, 255, 255, 25 );
+const QColor ROW_BG_FOCUS_COLOR( 255, 255, 255, 51 );
+const QColor LEFT_MARK_COLOR( "#BCF317" );
+const QColor HORZ_LINE_COLOR( 255, 255, 255, 128 );
+const QColor BUTTON_HOVER_COLOR( 255, 255, 255, 38 );
+
+static QFont cellFont(const QFont & base, int fontSize) {
+    QFont f(base);
+    f.setPixelSize(fontSize);
+    f.setWeight(QFont::Normal);
+    return f;
+}
+
+////////////////////////////////////////////////////////////////////
+// RichCell, RichRow
+
+RichCell RichCell::label(const QString & text, bool lowLight, int fontSize, bool wordWrap) {
+    RichCell c;
+    c.type = TYPE::TEXT;
+    c.text = text;
+    c.lowLight = lowLight;
+    c.fontSize = fontSize;
+    c.wordWrap = wordWrap;
+    return c;
+}
+
+RichCell RichCell::icon(const QString & pixmapPath) {
+    RichCell c;
+    c.type = TYPE::ICON;
+    c.text = pixmapPath;
+    return c;
+}
+
+RichCell RichCell::button(const QString & text, const QString & cookie, const QString & tooltip, int cx) {
+    RichCell c;
+    c.type = TYPE::BUTTON;
+    c.text = text;
+    c.cookie = cookie;
+    c.tooltip = tooltip;
+    c.cx = cx;
+    return c;
+}
+
+RichCell RichCell::spacer() {
+    return RichCell();
+}
+
+RichCell RichCell::fixedSpacer(int cx) {
+    RichCell c;
+    c.type = TYPE::FIXED_SPACER;
+    c.cx = cx;
+    return c;
+}
+
+RichLine & RichRow::line() {
+    lines.push_back(RichLine());
+    return lines.last();
+}
+
+void RichRow::horzLine() {
+    line().horzLine = true;
+}
+
+////////////////////////////////////////////////////////////////////
+// RichListModel
+
+void RichListModel::resetRows(int rows) {
+    beginResetModel();
+    rowNum = rows;
+    endResetModel();
+}
+
+void RichListModel::updateRow(int row) {
+    QModelIndex idx = index(row);
+    emit dataChanged(idx, idx);
+}
+
+int RichListModel::rowCount(const QModelIndex & parent) const {
+    return parent.isValid() ? 0 : rowNum;
+}
+
+QVariant RichListModel::data(const QModelIndex & index, int role) const {
+    Q_UNUSED(role)
+    // Data lives at the window, the view is requesting it by row
+    if (!index.isValid() || index.row()>=rowNum)
+        return QVariant();
+    return index.row();
+}
+
+////////////////////////////////////////////////////////////////////
+// RichRowDelegate
+
+RichRowDelegate::RichRowDelegate(RichListView * _view) :
+    QStyledItemDelegate(_view),
+    view(_view)
+{}
+
+void RichRowDelegate::paint(QPainter * painter, const QStyleOptionViewItem & option, const QModelIndex & index) const {
+    view->paintRow(painter, option.rect, index.row(), option.state & QStyle::State_Selected );
+}
+
+QSize RichRowDelegate::sizeHint(const QStyleOptionViewItem & option, const QModelIndex & index) const {
+    Q_UNUSED(option)
+    return QSize( view->viewport()->width(), view->getRowHeight(index.row()) );
+}
+
+////////////////////////////////////////////////////////////////////
+// RichListView
+
+RichListView::RichListView(QWidget * parent) : QListView(parent) {
+    setSizePolicy( QSizePolicy::Preferred, QSizePolicy::Preferred );
+    setStyleSheet( "QListView {border: 1px solid rgba(255, 255, 255, 0.2); background: transparent}" );
+    setHorizontalScrollBarPolicy(Qt::ScrollBarAlwaysOff);
+    setVerticalScrollBarPolicy(Qt::ScrollBarAsNeeded);
+    setVerticalScrollMode(QAbstractItemView::ScrollPerPixel);
+    setSelectionMode(QAbstractItemView::SingleSelection);
+    setEditTriggers(QAbstractItemView::NoEditTriggers);
+    setResizeMode(QListView::Adjust);
+    // Rows has different height, laying out by batches keeps UI responsive for the long lists
+    setLayoutMode(QListView::Batched);
+    setBatchSize(200);
+    setUniformItemSizes(false);
+    setSpacing(0);
+    setMouseTracking(true);
+
+    model = new RichListModel(this);
+    setModel(model);
+    setItemDelegate( new RichRowDelegate(this) );
+}
+
+void RichListView::resetRows(int rowCount) {
+    rowHeights = QVector<int>(rowCount, -1);
+    estimatedHeight = -1;
+    hoverButton.clear();
+    model->resetRows(rowCount);
+}
+
+void RichListView::updateRow(int row) {
+    if (row<0 || row>=rowHeights.size())
+        return;
+    rowHeights[row] = -1;
+    model->updateRow(row);
+    // height might change
+    scheduleDelayedItemsLayout();
+}
+
+RichRow RichListView::buildRow(int row) const {
+    if (!rowBuilder || row<0 || row>=model->rowCount())
+        return RichRow();
+    return rowBuilder(row);
+}
+
+int RichListView::getRowHeight(int row) const {
+    const int width = viewport()->width();
+    if (width != rowHeightsWidth) {
+        rowHeights.fill(-1);
+        rowHeightsWidth = width;
+        estimatedHeight = -1;
+    }
+    if (row<0 || row>=rowHeights.size())
+        return 0;
+
+    int & h = rowHeights[row];
+    if (h>=0)
+        return h;
+    // Layout is asking for all rows, building every one of them is too slow for the long lists.
+    // Rows are similar, so the first one is measured and the rest are fixed at paint.
+    if (estimatedHeight<0) {
+        h = layoutRow( buildRow(row), 0, 0, width, nullptr );
+        estimatedHeight = h;
+        return h;
+    }
+    return estimatedHeight;
+}
+
+void RichListView::onRowHeightsChanged() {
+    relayoutPending = false;
+    scheduleDelayedItemsLayout();
+}
+
+// Simplified version of what RichItem layouts are doing: mark, margins, lines of cells with spacers
+int RichListView::layoutRow(const RichRow & row, int left, int top, int width, QVector<PlacedCell> * cells) const {
+    const int contentLeft = left + LEFT_MARK_SIZE + LEFT_MARK_SPACING;
+    const int contentWidth = qMax(0, width - 2*(LEFT_MARK_SIZE + LEFT_MARK_SPACING) - RIGHT_MARGIN);
+
+    int y = top + VBOX_MARGIN;
+    for ( int ln=0; ln<row.lines.size(); ln++ ) {
+        const RichLine & line = row.lines[ln];
+        if (ln>0)
+            y += VBOX_SPACING;
+
+        if (line.horzLine) {
+            if (cells) {
+                PlacedCell pc;
+                pc.rect = QRect(contentLeft, y, contentWidth, 1);
+                pc.cell.type = RichCell::TYPE::HORZ_LINE;
+                cells->push_back(pc);
+            }
+            y += 1;
+            continue;
+        }
+
+        // Fixed sizes first, the rest of the space goes to spacers and word wrapped labels
+        const int n = line.cells.size();
+        QVector<int> cx(n, 0), cy(n, 0);
+        int fixedWidth = CELL_SPACING * qMax(0, n-1);
+        int flexNum = 0;
+        for (int i=0; i<n; i++) {
+            const RichCell & c = line.cells[i];
+            switch (c.type) {
+                case RichCell::TYPE::TEXT:
+                    if (c.wordWrap)
+                        flexNum++;
+                    else {
+                        QFontMetrics fm( cellFont(font(), c.fontSize) );
+                        cx[i] = fm.boundingRect(c.text).width() + 1;
+                        cy[i] = fm.height();
+                    }
+                    break;
+                case RichCell::TYPE::ICON:
+                    cx[i] = cy[i] = ROW_HEIGHT;
+                    break;
+                case RichCell::TYPE::BUTTON:
+                    cx[i] = c.cx;
+                    cy[i] = ROW_HEIGHT;
+                    break;
+                case RichCell::TYPE::FIXED_SPACER:
+                    cx[i] = c.cx;
+                    break;
+                default:
+                    flexNum++;
+                    break;
+            }
+            fixedWidth += cx[i];
+        }
+
+        const int flexWidth = flexNum>0 ? qMax(0, contentWidth - fixedWidth) / flexNum : 0;
+        for (int i=0; i<n; i++) {
+            const RichCell & c = line.cells[i];
+            if (c.type == RichCell::TYPE::SPACER)
+                cx[i] = flexWidth;
+            else if (c.type == RichCell::TYPE::TEXT && c.wordWrap) {
+                cx[i] = flexWidth;
+                QFontMetrics fm( cellFont(font(), c.fontSize) );
+                cy[i] = fm.boundingRect( QRect(0, 0, qMax(1,flexWidth), 1000000), Qt::TextWordWrap, c.text ).height();
+            }
+        }
+
+        int lineHeight = 0;
+        for (int h : cy)
+            lineHeight = qMax(lineHeight, h);
+
+        if (cells) {
+            int x = contentLeft;
+            const int right = contentLeft + contentWidth;
+            for (int i=0; i<n; i++) {
+                const RichCell & c = line.cells[i];
+                if (c.type == RichCell::TYPE::TEXT || c.type == RichCell::TYPE::ICON || c.type == RichCell::TYPE::BUTTON) {
+                    PlacedCell pc;
+                    // Not enough space, the last cells are clipped
+                    pc.rect = QRect( x, y + (lineHeight - cy[i])/2, qMax(0, qMin(cx[i], right - x)), cy[i] );
+                    pc.cell = c;
+                    cells->push_back(pc);
+                }
+                x += cx[i] + CELL_SPACING;
+            }
+        }
+        y += lineHeight;
+    }
+    y += VBOX_MARGIN;
+
+    return y - top + ROW_GAP;
+}
+
+const QIcon & RichListView::getIcon(const QString & path) const {
+    auto it = icons.find(path);
+    if (it == icons.end())
+        it = icons.insert(path, QIcon(path));
+    return it.value();
+}
+
+void RichListView::paintRow(QPainter * painter, const QRect & rect, int row, bool focused) const {
+    const RichRow r = buildRow(row);
+    QVector<PlacedCell> cells;
+    const int height = layoutRow(r, rect.left(), rect.top(), rect.width(), &cells);
+
+    // Now the row height is known. If the estimate was wrong, rows will be placed again.
+    if (row>=0 && row<rowHeights.size() && rect.width() == rowHeightsWidth && rowHeights[row] != height) {
+        const bool changed = rect.height() != height;
+        rowHeights[row] = height;
+        if (changed && !relayoutPending) {
+            relayoutPending = true;
+            QMetaObject::invokeMethod( const_cast<RichListView *>(this), "onRowHeightsChanged", Qt::QueuedConnection );
+        }
+    }
+
+    painter->save();
+
+    const QRect bg = rect.adjusted(0, 0, 0, -ROW_GAP);
+    painter->fillRect( bg, focused ? ROW_BG_FOCUS_COLOR : ROW_BG_COLOR );
+    if (r.marked)
+        painter->fillRect( QRect(bg.left(), bg.top(), LEFT_MARK_SIZE, bg.height()), LEFT_MARK_COLOR );
+
+    const QColor lowLightColor(LOW_LIGHT_COLOR);
+
+    for (const PlacedCell & pc : cells) {
+        const RichCell & c = pc.cell;
+        switch (c.type) {
+            case RichCell::TYPE::TEXT: {
+                QFont f = cellFont(font(), c.fontSize);
+                painter->setFont(f);
+                painter->setPen( c.lowLight ? lowLightColor : QColor(Qt::white) );
+                if (c.wordWrap)
+                    painter->drawText( pc.rect, Qt::AlignLeft | Qt::AlignTop | Qt::TextWordWrap, c.text );
+                else
+                    painter->drawText( pc.rect, Qt::AlignLeft | Qt::AlignVCenter,
+                                       QFontMetrics(f).elidedText(c.text, Qt::ElideRight, pc.rect.width()) );
+                break;
+            }
+            case RichCell::TYPE::ICON:
+                getIcon(c.text).paint(painter, pc.rect);
+                break;
+            case RichCell::TYPE::BUTTON: {
+                const QRect br = pc.rect.adjusted(0, 0, -1, -1);
+                if (!hoverButton.isEmpty() && hoverButton == c.cookie) {
+                    painter->setPen(Qt::NoPen);
+                    painter->setBrush(BUTTON_HOVER_COLOR);
+                    painter->drawRoundedRect(br, 3, 3);
+                }
+                painter->setBrush(Qt::NoBrush);
+                painter->setPen( QPen(Qt::white, 1) );
+                painter->drawRoundedRect(br, 3, 3);
+                painter->setFont( cellFont(font(), BUTTON_FONT) );
+                painter->drawText( pc.rect, Qt::AlignCenter, c.text );
+                break;
+            }
+            case RichCell::TYPE::HORZ_LINE:
+                painter->fillRect( pc.rect, HORZ_LINE_COLOR );
+                break;
+            default:
+                break;
+        }
+    }
+
+    painter->restore();
+}
+
+bool RichListView::findButton(const QPoint & pos, RichCell & button) const {
+    QModelIndex idx = indexAt(pos);
+    if (!idx.isValid())
+        return false;
+
+    const QRect rect = visualRect(idx);
+    QVector<PlacedCell> cells;
+    layoutRow( buildRow(idx.row()), rect.left(), rect.top(), rect.width(), &cells );
+    for (const PlacedCell & pc : cells) {
+        if (pc.cell.type == RichCell::TYPE::BUTTON && pc.rect.contains(pos)) {
+            button = pc.cell;
+            return true;
+        }
+    }
+    return false;
+}
+
+void RichListView::mouseMoveEvent(QMouseEvent * event) {
+    RichCell btn;
+    const QString hover = findButton(event->pos(), btn) ? btn.cookie : QString();
+    if (hover != hoverButton) {
+        hoverButton = hover;
+        viewport()->update();
+    }
+    QListView::mouseMoveEvent(event);
+}
+
+void RichListView::leaveEvent(QEvent * event) {
+    if (!hoverButton.isEmpty()) {
+        hoverButton.clear();
+        viewport()->update();
+    }
+    QListView::leaveEvent(event);
+}
+
+void RichListView::mouseReleaseEvent(QMouseEvent * event) {
+    QListView::mouseReleaseEvent(event);
+
+    if (event->button() != Qt::LeftButton)
+        return;
+
+    RichCell btn;
+    if (findButton(event->pos(), btn)) {
+        if (buttonCallback)
+            buttonCallback->richButtonPressed(nullptr, btn.cookie);
+        return;
+    }
+
+    QModelIndex idx = indexAt(event->pos());
+    if (idx.isValid())
+        emit onItemClicked( buildRow(idx.row()).id );
+}
+
+void RichListView::mouseDoubleClickEvent(QMouseEvent * event) {
+    RichCell btn;
+    if (findButton(event->pos(), btn))
+        return;
+
+    QListView::mouseDoubleClickEvent(event);
+    QModelIndex idx = indexAt(event->pos());
+    if (idx.isValid())
+        emit onItemActivated( buildRow(idx.row()).id );
+}
+
+void RichListView::keyPressEvent(QKeyEvent * event) {
+    if ( (event->key() == Qt::Key_Enter || event->key() == Qt::Key_Return) && currentIndex().isValid() ) {
+        emit onItemActivated( buildRow(currentIndex().row()).id );
+        return;
+    }
+    QListView::keyPressEvent(event);
+}
+
+void RichListView::resizeEvent(QResizeEvent * event) {
+    QListView::resizeEvent(event);
+    // Row heights depend on the width because of word wrapping, cache is reset on the next request
+    scheduleDelayedItemsLayout();
+}
+
+bool RichListView::viewportEvent(QEvent * event) {
+    if (event->type() == QEvent::ToolTip) {
+        QHelpEvent * he = static_cast<QHelpEvent *>(event);
+        RichCell btn;
+        if (findButton(he->pos(), btn) && !btn.tooltip.isEmpty())
+            QToolTip::showText(he->globalPos(), btn.tooltip, viewport());
+        else
+            QToolTip::hideText();
+        return true;
+    }
+    return QListView::viewportEvent(event);
+}
+
+}
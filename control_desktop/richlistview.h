@@ -0,0 +1,165 @@
+// Copyright 2020 The MWC Developers
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MWC_QT_WALLET_RICHLISTVIEW_H
+#define MWC_QT_WALLET_RICHLISTVIEW_H
+
+#include <QListView>
+#include <QAbstractListModel>
+#include <QStyledItemDelegate>
+#include <QHash>
+#include <QIcon>
+#include <functional>
+#include "richitem.h"
+#include "richbutton.h"
+
+namespace control {
+
+// Virtual analog of the RichItem. Instead of widgets the row is described by the lines of cells,
+// RichListView builds it only for the rows that are painted or measured.
+struct RichCell {
+    enum class TYPE { TEXT, ICON, BUTTON, SPACER, FIXED_SPACER, HORZ_LINE };
+
+    TYPE    type = TYPE::SPACER;
+    QString text;       // Label text, icon path or button text
+    int     fontSize = FONT_NORMAL;
+    bool    lowLight = false;
+    bool    wordWrap = false;
+    QString cookie;     // Button cookie for RichButtonPressCallback
+    QString tooltip;
+    int     cx = 0;     // Button or fixed spacer width
+
+    static RichCell label(const QString & text, bool lowLight = false, int fontSize = FONT_NORMAL, bool wordWrap = false);
+    static RichCell icon(const QString & pixmapPath);
+    static RichCell button(const QString & text, const QString & cookie, const QString & tooltip, int cx = 60);
+    static RichCell spacer();
+    static RichCell fixedSpacer(int cx);
+};
+
+struct RichLine {
+    QVector<RichCell> cells;
+    bool horzLine = false;
+
+    RichLine & add(const RichCell & cell) {cells.push_back(cell); return *this;}
+};
+
+struct RichRow {
+    QString id;           // Item id for onItemActivated, onItemClicked
+    bool    marked = false;
+    QVector<RichLine> lines;
+
+    // Add a new line and return it
+    RichLine & line();
+    void horzLine();
+};
+
+typedef std::function<RichRow(int row)> RichRowBuilder;
+
+class RichListView;
+
+class RichListModel : public QAbstractListModel {
+    Q_OBJECT
+public:
+    explicit RichListModel(QObject * parent) : QAbstractListModel(parent) {}
+
+    void resetRows(int rows);
+    void updateRow(int row);
+
+    virtual int rowCount(const QModelIndex & parent = QModelIndex()) const override;
+    virtual QVariant data(const QModelIndex & index, int role = Qt::DisplayRole) const override;
+private:
+    int rowNum = 0;
+};
+
+class RichRowDelegate : public QStyledItemDelegate {
+    Q_OBJECT
+public:
+    explicit RichRowDelegate(RichListView * view);
+
+    virtual void paint(QPainter * painter, const QStyleOptionViewItem & option, const QModelIndex & index) const override;
+    virtual QSize sizeHint(const QStyleOptionViewItem & option, const QModelIndex & index) const override;
+private:
+    RichListView * view;
+};
+
+// Virtualized list with RichItem look. Data lives at the window, view asks for rows with RichRowBuilder.
+// Only visible rows are built. Layout uses the estimated height for the rows that was never painted,
+// exact height is measured at paint and cached until the row or the width is changed.
+class RichListView : public QListView {
+    Q_OBJECT
+public:
+    explicit RichListView(QWidget * parent);
+
+    void setRowBuilder(RichRowBuilder builder) {rowBuilder = builder;}
+    // Buttons are reported with a callback, button pointer is nullptr
+    void setButtonCallback(RichButtonPressCallback * callback) {buttonCallback = callback;}
+
+    // Replace all rows. Nothing is built here.
+    void resetRows(int rowCount);
+    // Row data was changed
+    void updateRow(int row);
+    int  getRowCount() const {return model->rowCount();}
+
+    // For the delegate
+    void paintRow(QPainter * painter, const QRect & rect, int row, bool focused) const;
+    // Cached or estimated height, doesn't build the row except the very first one
+    int  getRowHeight(int row) const;
+
+signals:
+    void onItemClicked(QString id);
+    void onItemActivated(QString id);
+
+protected:
+    virtual void mouseMoveEvent(QMouseEvent * event) override;
+    virtual void mouseReleaseEvent(QMouseEvent * event) override;
+    virtual void mouseDoubleClickEvent(QMouseEvent * event) override;
+    virtual void keyPressEvent(QKeyEvent * event) override;
+    virtual void leaveEvent(QEvent * event) override;
+    virtual void resizeEvent(QResizeEvent * event) override;
+    virtual bool viewportEvent(QEvent * event) override;
+
+private slots:
+    // Painted rows got heights that are different from the estimate
+    void onRowHeightsChanged();
+
+private:
+    struct PlacedCell {
+        QRect rect;
+        RichCell cell;
+    };
+
+    RichRow buildRow(int row) const;
+    // Place row cells into the rect. Return row height
+    int layoutRow(const RichRow & row, int left, int top, int width, QVector<PlacedCell> * cells) const;
+    // Button at the viewport point. Return false if there is no button
+    bool findButton(const QPoint & pos, RichCell & button) const;
+    const QIcon & getIcon(const QString & path) const;
+
+private:
+    RichListModel * model = nullptr;
+    RichRowBuilder rowBuilder;
+    RichButtonPressCallback * buttonCallback = nullptr;
+
+    QString hoverButton; // cookie of the button under the mouse
+
+    mutable QVector<int> rowHeights; // cache, -1 - not measured yet
+    mutable int rowHeightsWidth = -1;
+    mutable int estimatedHeight = -1; // Height of the first measured row, used for the rest until they are painted
+    mutable bool relayoutPending = false;
+    mutable QHash<QString, QIcon> icons;
+};
+
+}
+
+#endif //MWC_QT_WALLET_RICHLISTVIEW_H
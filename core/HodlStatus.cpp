@@ -291,8 +291,11 @@ QPair< QString, int64_t> HodlStatus::getWalletHodlStatus(const QString & hash) c
             for ( auto o = walletOutputs.constBegin(); o != walletOutputs.constEnd(); ++o ) {
                 for ( const auto & walletOutput : o.value() ) {
                     // Counting only exist outputs. Unconfirmed doesn't make sense to count
-                    if ( (walletOutput.status=="Unspent" || walletOutput.status=="Locked") && hodl_outputs.contains(walletOutput.outputCommitment) ) {
-                        auto ho = hodl_outputs[walletOutput.outputCommitment];
+                    if ( walletOutput.status!=wallet::WalletOutput::STATUS::UNSPENT && walletOutput.status!=wallet::WalletOutput::STATUS::LOCKED )
+                        continue;
+                    const QString commit = walletOutput.getOutputCommitment();
+                    if ( hodl_outputs.contains(commit) ) {
+                        auto ho = hodl_outputs[commit];
                         int64_t balance = hodlBalancePerClass.value( ho.cls, 0 );
                         balance += int64_t(ho.value * 1000000000.0 + 0.5);
                         hodlBalancePerClass.insert( ho.cls, balance );
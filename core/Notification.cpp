@@ -146,6 +146,7 @@ void appendNotificationMessage( MESSAGE_LEVEL level, QString message ) {
 
     if (level == MESSAGE_LEVEL::FATAL_ERROR) {
         // Fatal error. Display message box and exiting. We don't want to continue
+        logger::flushLogs();
         core::getWndManager()->messageTextDlg("Wallet Error", "Wallet got a critical error:\n" + message + "\n\nPress OK to exit the wallet" );
         mwc::closeApplication();
         return;
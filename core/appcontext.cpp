@@ -23,6 +23,7 @@
 #include "../core/global.h"
 #include <QtAlgorithms>
 #include "../util/Log.h"
+#include "../util/tracer.h"
 #include "../util/Process.h"
 #include <QMessageBox>
 #include <QCoreApplication>
@@ -356,6 +357,7 @@ bool AppContext::loadDataImpl() {
 
 
 void AppContext::saveData() const {
+    tracer::Span traceSpan("appcontext", "AppContext::saveData");
     QPair<bool,QString> dataPath = ioutils::getAppDataPath("context");
     if (!dataPath.first) {
         core::getWndManager()->messageTextDlg("Error", dataPath.second);
@@ -498,6 +500,7 @@ void AppContext::loadNotesData() {
 }
 
 void AppContext::saveNotesData() const {
+    tracer::Span traceSpan("appcontext", "AppContext::saveNotesData");
     QPair<bool,QString> dataPath = ioutils::getAppDataPath("context");
     if (!dataPath.first) {
         core::getWndManager()->messageTextDlg("Error", dataPath.second);
@@ -857,6 +860,7 @@ void AppContext::setLockedOutput(const QString & output, bool lock) {
     if (lock) {
         if ( !lockedOutputs.contains(output) ) {
             lockedOutputs.insert(output);
+            lockedOutputsRevision++;
             saveData();
             logger::logEmit("AppContext", "onOutputLockChanged", output + " locked" );
             emit onOutputLockChanged(output);
@@ -864,6 +868,7 @@ void AppContext::setLockedOutput(const QString & output, bool lock) {
     }
     else {
         if (lockedOutputs.remove(output)) {
+            lockedOutputsRevision++;
             saveData();
             logger::logEmit("AppContext", "onOutputLockChanged", output + " unlocked" );
             emit onOutputLockChanged(output);
@@ -894,6 +899,7 @@ void AppContext::updateNote(const QString& key, const QString& note) {
         notes.remove(key);
     else
         notes.insert(key, note);
+    notesRevision++;
     saveNotesData();
 }
 
@@ -902,6 +908,7 @@ void AppContext::deleteNote(const QString& key) {
         loadNotesData();
     }
     notes.remove(key);
+    notesRevision++;
     saveNotesData();
 }
 
@@ -158,10 +158,15 @@ public:
     QString getNote(const QString& key);
     void updateNote(const QString& key, const QString& note);
     void deleteNote(const QString& key);
+    // Incremented on every notes change, so users can cache derived data
+    int getNotesRevision() const {return notesRevision;}
 
     // Outputs can be locked from spending.
     bool isLockOutputEnabled() const {return lockOutputEnabled;}
     bool isLockedOutputs(const QString & output) const;
+    const QSet<QString> & getLockedOutputs() const {return lockedOutputs;}
+    // Incremented on every lockedOutputs change, so users can cache derived data
+    int getLockedOutputsRevision() const {return lockedOutputsRevision;}
     void setLockOutputEnabled(bool enabled);
     void setLockedOutput(const QString & output, bool lock);
 
@@ -292,6 +297,7 @@ private:
     // Outputs can be locked from spending.
     bool lockOutputEnabled = false; // By default it is false
     QSet<QString> lockedOutputs; // Outputs that was locked (it is manual operation)
+    int lockedOutputsRevision = 0; // not persistent
 
     // Allow users to by-pass the stem-phase of the dandelion protocol
     // and directly fluff their transactions.
@@ -303,6 +309,7 @@ private:
     // For notes we need to do save and move
     bool notesLoaded = false;
     QMap<QString, QString> notes;
+    int notesRevision = 0; // not persistent
 
     // Earlier versions of Qt wallet stored notes in a different format by wallet and account
     // We read these notes in and migrate them to the new format for storing notes
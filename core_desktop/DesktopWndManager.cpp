@@ -55,6 +55,7 @@
 #include <QMessageBox>
 #include "../util_desktop/timeoutlock.h"
 #include "../util/Process.h"
+#include "../util/tracer.h"
 #include "../dialogs_desktop/showwalletstoppingmessagedlg.h"
 #include "../dialogs_desktop/s_swapbackupdlg.h"
 #include "../state/state.h"
@@ -167,42 +168,50 @@ void DesktopWndManager::hideWalletStoppingMessage() {
 
 
 void DesktopWndManager::pageInitFirstTime() {
+    tracer::Span traceSpan("page", __func__);
     windowManager->switchToWindowEx( mwc::PAGE_A_FIRST_TIME,
                                      new wnd::InitFirstTime( windowManager->getInWndParent() ) );
 }
 
 void DesktopWndManager::pageInputPassword(QString pageTitle, bool lockMode) {
+    tracer::Span traceSpan("page", __func__);
     windowManager->switchToWindowEx( pageTitle,
                 new wnd::InputPassword( windowManager->getInWndParent(), lockMode ) );
 }
 
 void DesktopWndManager::pageInitAccount(QString path, bool restoredFromSeed) {
+    tracer::Span traceSpan("page", __func__);
     windowManager->switchToWindowEx( mwc::PAGE_A_INIT_ACCOUNT,
                 new wnd::InitAccount( windowManager->getInWndParent(), path, restoredFromSeed ));
 }
 
 void DesktopWndManager::pageEnterSeed() {
+    tracer::Span traceSpan("page", __func__);
     windowManager->switchToWindowEx( mwc::PAGE_A_ENTER_SEED,
                                      new wnd::EnterSeed( windowManager->getInWndParent()));
 }
 
 void DesktopWndManager::pageNewSeed(QString pageTitle, QVector<QString> seed, bool hideSubmitButton) {
+    tracer::Span traceSpan("page", __func__);
     windowManager->switchToWindowEx( pageTitle,
                                     new wnd::NewSeed( windowManager->getInWndParent(),
                                                       seed, hideSubmitButton ) );
 }
 
 void DesktopWndManager::pageNewSeedTest(int wordIndex) {
+    tracer::Span traceSpan("page", __func__);
     windowManager->switchToWindowEx( mwc::PAGE_A_PASSPHRASE_TEST,
             new wnd::NewSeedTest( windowManager->getInWndParent(), wordIndex ));
 }
 
 void DesktopWndManager::pageProgressWnd(QString pageTitle, QString callerId, QString header, QString msgProgress, QString msgPlus, bool cancellable ) {
+    tracer::Span traceSpan("page", __func__);
     windowManager->switchToWindowEx( pageTitle,
              new wnd::ProgressWnd(windowManager->getInWndParent(), callerId, header, msgProgress, msgPlus, cancellable));
 }
 
 void DesktopWndManager::pageOutputs() {
+    tracer::Span traceSpan("page", __func__);
     windowManager->switchToWindowEx(mwc::PAGE_E_OUTPUTS,
                 new wnd::Outputs( windowManager->getInWndParent()));
 }
@@ -211,6 +220,7 @@ void DesktopWndManager::pageFileTransactionReceive(QString pageTitle,
                                             const QString & fileNameOrSlatepack,
                                             const util::FileTransactionInfo & transInfo,
                                             int nodeHeight) {
+    tracer::Span traceSpan("page", __func__);
     windowManager->switchToWindowEx( pageTitle,
                         new wnd::FileTransactionReceive( windowManager->getInWndParent(),
                                                   fileNameOrSlatepack, transInfo, nodeHeight) );
@@ -220,48 +230,57 @@ void DesktopWndManager::pageFileTransactionFinalize(QString pageTitle,
                                             const QString & fileNameOrSlatepack,
                                             const util::FileTransactionInfo & transInfo,
                                             int nodeHeight) {
+    tracer::Span traceSpan("page", __func__);
     windowManager->switchToWindowEx( pageTitle,
                                      new wnd::FileTransactionFinalize( windowManager->getInWndParent(),
                                                                fileNameOrSlatepack, transInfo, nodeHeight) );
 }
 
 void DesktopWndManager::pageRecieve() {
+    tracer::Span traceSpan("page", __func__);
     windowManager->switchToWindowEx( mwc::PAGE_E_RECEIVE,
                new wnd::Receive( windowManager->getInWndParent() ) );
 }
 
 void DesktopWndManager::pageListening() {
+    tracer::Span traceSpan("page", __func__);
 
     windowManager->switchToWindowEx( mwc::PAGE_E_LISTENING,
                  new wnd::Listening( windowManager->getInWndParent()));
 }
 
 void DesktopWndManager::pageFinalize() {
+    tracer::Span traceSpan("page", __func__);
     windowManager->switchToWindowEx( mwc::PAGE_G_FINALIZE_UPLOAD,
               new wnd::Finalize( windowManager->getInWndParent() ) );
 }
 
 void DesktopWndManager::pageSendStarting() {
+    tracer::Span traceSpan("page", __func__);
     windowManager->switchToWindowEx( mwc::PAGE_G_SEND,
               new wnd::SendStarting( windowManager->getInWndParent()));
 }
 
 void DesktopWndManager::pageSendOnline( QString selectedAccount, int64_t amount ) {
+    tracer::Span traceSpan("page", __func__);
     windowManager->switchToWindowEx( mwc::PAGE_G_SEND_ONLINE,
                                      new wnd::SendOnline( windowManager->getInWndParent(), selectedAccount, amount ));
 }
 
 void DesktopWndManager::pageSendFile( QString selectedAccount, int64_t amount ) {
+    tracer::Span traceSpan("page", __func__);
     windowManager->switchToWindowEx( mwc::PAGE_G_SEND_FILE,
                                      new wnd::SendOffline( windowManager->getInWndParent(), selectedAccount, amount, false ));
 }
 
 void DesktopWndManager::pageSendSlatepack( QString selectedAccount, int64_t amount ) {
+    tracer::Span traceSpan("page", __func__);
     windowManager->switchToWindowEx( mwc::PAGE_G_SEND_SLATEPACK,
                                      new wnd::SendOffline( windowManager->getInWndParent(), selectedAccount, amount, true ));
 }
 
 void DesktopWndManager::pageTransactions() {
+    tracer::Span traceSpan("page", __func__);
     windowManager->switchToWindowEx( mwc::PAGE_E_TRANSACTION,
                       new wnd::Transactions( windowManager->getInWndParent()));
 }
@@ -269,21 +288,25 @@ void DesktopWndManager::pageTransactions() {
 // slatepack - slatepack string value to show.
 // backStateId - state ID of the caller. On 'back' will switch to this state Id
 void DesktopWndManager::pageShowSlatepack(QString slatepack, int backStateId, QString txExtension, bool enableFinalize) {
+    tracer::Span traceSpan("page", __func__);
     windowManager->switchToWindowEx( mwc::PAGE_G_SLATEPACK,
                                      new wnd::ResultedSlatepack( windowManager->getInWndParent(), slatepack, backStateId, txExtension, enableFinalize ));
 }
 
 void DesktopWndManager::pageAccounts() {
+    tracer::Span traceSpan("page", __func__);
     windowManager->switchToWindowEx( mwc::PAGE_K_ACCOUNTS,
                new wnd::Accounts( windowManager->getInWndParent()));
 }
 
 void DesktopWndManager::pageAccountTransfer() {
+    tracer::Span traceSpan("page", __func__);
     windowManager->switchToWindowEx( mwc::PAGE_K_ACCOUNT_TRANSFER,
                new wnd::AccountTransfer( windowManager->getInWndParent()));
 }
 
 void DesktopWndManager::pageNodeInfo() {
+    tracer::Span traceSpan("page", __func__);
     state::NodeInfo * ni =  (state::NodeInfo *)state::getState(state::STATE::NODE_INFO);
     Q_ASSERT(ni);
 
@@ -308,26 +331,31 @@ void DesktopWndManager::pageNodeInfo() {
 }
 
 void DesktopWndManager::pageContacts() {
+    tracer::Span traceSpan("page", __func__);
     windowManager->switchToWindowEx( mwc::PAGE_W_CONTACTS,
               new wnd::Contacts( windowManager->getInWndParent()));
 }
 
 void DesktopWndManager::pageEvents() {
+    tracer::Span traceSpan("page", __func__);
     windowManager->switchToWindowEx( mwc::PAGE_X_EVENTS,
               new wnd::Events( windowManager->getInWndParent()));
 }
 
 void DesktopWndManager::pageWalletConfig() {
+    tracer::Span traceSpan("page", __func__);
     windowManager->switchToWindowEx( mwc::PAGE_X_WALLET_CONFIG,
               new wnd::WalletConfig( windowManager->getInWndParent()));
 }
 
 void DesktopWndManager::pageNodeConfig() {
+    tracer::Span traceSpan("page", __func__);
     windowManager->switchToWindowEx( mwc::PAGE_X_NODE_CONFIG,
              new wnd::NodeConfig( windowManager->getInWndParent()));
 }
 
 void DesktopWndManager::pageSelectMode() {
+    tracer::Span traceSpan("page", __func__);
     windowManager->switchToWindowEx( mwc::PAGE_Y_SELECT_RUNNING_MODE,
               new wnd::SelectMode( windowManager->getInWndParent()));
 }
@@ -345,29 +373,35 @@ void DesktopWndManager::pageAccountOptions() {
 }
 
 void DesktopWndManager::pageSwapList() {
+    tracer::Span traceSpan("page", __func__);
     windowManager->switchToWindowEx( mwc::PAGE_S_SWAP_LIST,
         new wnd::SwapList( windowManager->getInWndParent()));
 }
 
 void DesktopWndManager::pageSwapNew1() {
+    tracer::Span traceSpan("page", __func__);
     windowManager->switchToWindowEx( mwc::PAGE_S_SWAP_NEW + " 1/3",
                                      new wnd::NewSwap1( windowManager->getInWndParent()));
 }
 
 void DesktopWndManager::pageSwapNew2() {
+    tracer::Span traceSpan("page", __func__);
     windowManager->switchToWindowEx( mwc::PAGE_S_SWAP_NEW + " 2/3",
                                      new wnd::NewSwap2( windowManager->getInWndParent()));
 }
 void DesktopWndManager::pageSwapNew3() {
+    tracer::Span traceSpan("page", __func__);
     windowManager->switchToWindowEx( mwc::PAGE_S_SWAP_NEW + " 3/3",
                                      new wnd::NewSwap3( windowManager->getInWndParent()));
 }
 
 void DesktopWndManager::pageSwapEdit(QString swapId, QString stateCmd) {
+    tracer::Span traceSpan("page", __func__);
     windowManager->switchToWindowEx( "",
          new wnd::EditSwap( windowManager->getInWndParent(), swapId, stateCmd));
 }
 void DesktopWndManager::pageSwapTradeDetails(QString swapId) {
+    tracer::Span traceSpan("page", __func__);
     windowManager->switchToWindowEx( "",
          new wnd::TradeDetails( windowManager->getInWndParent(), swapId));
 }
@@ -31,18 +31,18 @@ ShowOutputDlg::ShowOutputDlg(QWidget *parent, const wallet::WalletOutput &output
     wallet = new bridge::Wallet(this);
     util = new bridge::Util(this);
 
-    ui->status->setText(output.status);
-    ui->height->setText(output.blockHeight);
-    ui->confirms->setText(output.numOfConfirms);
+    ui->status->setText(output.getStatus());
+    ui->height->setText(output.getBlockHeight());
+    ui->confirms->setText(output.getNumOfConfirms());
     ui->mwc->setText(util::nano2one(output.valueNano));
-    ui->locked->setText(output.lockedUntil);
+    ui->locked->setText(output.getLockedUntil());
     ui->coinBase->setText(output.coinbase ? "Yes" : "No");
     ui->tx->setText(QString::number(output.txIdx + 1));
-    ui->commitment->setText(output.outputCommitment);
+    ui->commitment->setText(output.getOutputCommitment());
 
     blockExplorerUrl = config->getBlockExplorerUrl(config->getNetwork());
 
-    commitment = output.outputCommitment;
+    commitment = output.getOutputCommitment();
 
     newOutputNote = note;
     ui->outputNote->setText(newOutputNote);
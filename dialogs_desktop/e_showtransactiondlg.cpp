@@ -72,7 +72,7 @@ ShowTransactionDlg::ShowTransactionDlg(QWidget *parent,
             commitType = "Output " + QString::number(i-transaction.numInputs+1) + ": ";
         }
 
-        ui->commitsComboBox->addItem( commitType + outputs[i].outputCommitment, QVariant(i));
+        ui->commitsComboBox->addItem( commitType + outputs[i].getOutputCommitment(), QVariant(i));
     }
 
     // Selecting first output
@@ -121,10 +121,10 @@ void ShowTransactionDlg::updateOutputData() {
     ui->out_label4->show();
     ui->out_label5->show();
     ui->out_label6->show();
-    ui->out_status->setText(out.status);
+    ui->out_status->setText(out.getStatus());
     ui->out_mwc->setText(util::nano2one( out.valueNano) );
-    ui->out_height->setText( out.blockHeight );
-    ui->out_confirms->setText( out.numOfConfirms );
+    ui->out_height->setText( out.getBlockHeight() );
+    ui->out_confirms->setText( out.getNumOfConfirms() );
     ui->out_coinBase->setText(out.coinbase?"Yes":"No");
     ui->out_tx->setText(out.txIdx<0 ? "None" : QString::number(out.txIdx+1) );
 }
@@ -140,7 +140,7 @@ void ShowTransactionDlg::on_viewCommit_clicked()
     if (!dt.isValid())
         return;
 
-    util->openUrlInBrowser("https://" + blockExplorerUrl + "/#o" + outputs[ dt.toInt() ].outputCommitment );
+    util->openUrlInBrowser("https://" + blockExplorerUrl + "/#o" + outputs[ dt.toInt() ].getOutputCommitment() );
 }
 
 void ShowTransactionDlg::on_commitsComboBox_currentIndexChanged(int index)
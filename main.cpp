@@ -38,6 +38,7 @@
 #include "core/global.h"
 #include "util/ioutils.h"
 #include "util/Log.h"
+#include "util/tracer.h"
 #include "core/Config.h"
 #include "core/HodlStatus.h"
 #include "util/ConfigReader.h"
@@ -62,6 +63,9 @@
 #include "tests/testPasswordAnalyser.h"
 #include "tests/testCalcOutputsToSpend.h"
 #include "tests/testLogs.h"
+#include "tests/testMetrics.h"
+#include "tests/testWalletDelta.h"
+#include "tests/testHistoryStore.h"
 #include "misk/DictionaryInit.h"
 #include "util/stringutils.h"
 #include "build_version.h"
@@ -151,10 +155,21 @@ QPair<bool, QString> readConfig(QApplication & app) {
                                       "Path to the mwc-gui-wallet config ",
                                       "mwc713 path",
                                       ""},
+                              {"trace",
+                                      "Write the timeline of tasks, parsers, pages and http requests in Chrome trace format (chrome://tracing, ui.perfetto.dev)",
+                                      "trace file",
+                                      ""},
                       });
 
     parser.process(app);
 
+    QString traceFile = parser.value("trace");
+    if (!traceFile.isEmpty()) {
+        QPair<bool,QString> traceRes = tracer::startTracing(traceFile);
+        if (!traceRes.first)
+            return traceRes;
+    }
+
     QString config = parser.value("config");
     if (config.isEmpty()) {
         config = config::getMwcGuiWalletConf();
@@ -200,6 +215,18 @@ QPair<bool, QString> readConfig(QApplication & app) {
     if ( timeoutMultiplierVal < 0.01 )
         timeoutMultiplierVal = 1.0;
 
+    for (int i=0; i<int(logger::LOG_CATEGORY::COUNT); i++) {
+        const logger::LOG_CATEGORY category = logger::LOG_CATEGORY(i);
+        const QString key = "log_budget_" + logger::toString(category);
+        if (!reader.isDefined(key))
+            continue;
+        logger::LogBudget budget = logger::getLogBudget(category);
+        QPair<bool,QString> res = logger::LogBudget::fromString(reader.getString(key), budget);
+        if (!res.first)
+            return QPair<bool, QString>(false, "Found invalid value for '" + key + "'. " + res.second);
+        logger::setLogBudget(category, budget);
+    }
+
     if ( mwc_path.isEmpty() || wallet713_path.isEmpty() ) {
         qDebug() << "Failed to read all expected data from config file " << config;
         return QPair<bool, QString>(false, "Not found all expected fields at config file " + config);
@@ -365,12 +392,21 @@ int main(int argc, char *argv[])
     // tests are quick, let's run them in debug
 //    test::testCalcOutputsToSpend();  // This test is long and show about 8 Message boxes.
 //    test::testLogsRotation();
+//    test::testTracer(); // Starts and stops the tracer thread
+//    test::testGzipFile(); // Writes 2.5 MB into the temp dir
     test::testLongLong2ShortStr();
     test::testUtils();
     test::testWordSequences();
     test::testWordDictionary();
     test::testPasswordAnalyser();
     test::testMessageMapper();
+    test::testLatencyHistogram();
+    test::testTaskTimeout();
+    test::testWalletDelta();
+    test::testHistoryStore();
+    test::testLogsQueue();
+    test::testEventLog();
+    test::testLogBudget();
 #endif
 #endif
 
@@ -424,7 +460,7 @@ int main(int argc, char *argv[])
             return 1;
         }
 
-        // Logger must be start AFTER readConfig because logger require mwczip location and it is defined at the configs
+        // Logger must be start AFTER readConfig, the config is logged at the start
         logger::initLogger(appContext.isLogsEnabled());
 
         logger::logInfo("mwc-qt-wallet", QString("Starting mwc-gui-wallet version ") + BUILD_VERSION + " with config:\n" + config::toString() );
@@ -562,6 +598,9 @@ int main(int argc, char *argv[])
 
         delete mwcNode; mwcNode = nullptr;
 
+        // Logs are written by the background thread, let it finish
+        logger::flushLogs();
+
         util::releaseAppGlobalLock();
 
         break;
@@ -574,6 +613,8 @@ int main(int argc, char *argv[])
     delete wndManager;
 #endif
 
+    tracer::stopTracing();
+
     return retVal;
   }
 
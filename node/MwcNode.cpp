@@ -24,6 +24,7 @@
 #include "../core/WndManager.h"
 #include "../core/Config.h"
 #include "../util/Log.h"
+#include "../util/tracer.h"
 #include <QNetworkAccessManager>
 #include <QNetworkReply>
 #include <QUrlQuery>
@@ -387,7 +388,10 @@ void MwcNode::mwcNodeReadyReadStandardOutput() {
         QString str( ioutils::FilterEscSymbols( nodeProcess->readAllStandardOutput() ) );
         qDebug() << "Get output:" << str;
         logger::logMwcNodeOut(str);
-        nodeOutputParser->processInput(str);
+        {
+            tracer::Span traceSpan("parser", "NodeOutputParser");
+            nodeOutputParser->processInput(str);
+        }
 
         nonEmittedOutput += str;
 
@@ -850,6 +854,7 @@ void MwcNode::sendRequest( const QString & tag, QString secret,
 
     if (reply) {
         reply->setProperty("tag", QVariant(tag));
+        reply->setProperty("traceId", QVariant( tracer::asyncBegin("http", "MwcNode", tag) ));
         // Respond will be send back async
     }
 }
@@ -858,6 +863,8 @@ void MwcNode::replyFinished(QNetworkReply* reply) {
     // processing reply object first
     QNetworkReply::NetworkError errCode = reply->error();
     QString tag = reply->property("tag").toString();
+    tracer::asyncEnd("http", "MwcNode", tag, reply->property("traceId").toULongLong());
+    tracer::Span traceSpan("http", "MwcNode::replyFinished", tag);
     QString strReply (reply->readAll().trimmed());
     reply->deleteLater();
     reply = nullptr;
@@ -97,6 +97,12 @@ void Send::switchToStartingWindow() {
 //   2 - amount error
 int Send::initialSendSelection( bridge::SEND_SELECTED_METHOD sendSelectedMethod, QString account, QString sendAmount ) {
 
+    // Balances restored from the cache are stale, spendable outputs are not known until the refresh
+    if (context->wallet->getWarmStartHeight() >= 0) {
+        core::getWndManager()->messageTextDlg("Please wait", "Your wallet balance is not refreshed yet. Please wait until the wallet finishes the sync and try again.");
+        return 1;
+    }
+
     QVector<wallet::AccountInfo> balance = context->wallet->getWalletBalance();
     wallet::AccountInfo selectedAccount;
     for (const auto & a : balance) {
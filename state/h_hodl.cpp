@@ -24,6 +24,7 @@
 #include <QUrlQuery>
 #include <QNetworkReply>
 #include "../util/Log.h"
+#include "../util/tracer.h"
 #include <QJsonObject>
 #include <QJsonArray>
 #include <QJsonParseError>
@@ -405,6 +406,7 @@ void Hodl::sendRequest(HTTP_CALL call, const QString & api,
         reply->setProperty("param2", QVariant(param2));
         reply->setProperty("param3", QVariant(param3));
         reply->setProperty("param4", QVariant(param4));
+        reply->setProperty("traceId", QVariant( tracer::asyncBegin("http", "Hodl", tag) ));
         // Respond will be send back async
     }
 }
@@ -423,6 +425,8 @@ static QString generateMessage( QString errMessage, int errCode ) {
 void Hodl::replyFinished(QNetworkReply* reply) {
     QNetworkReply::NetworkError errCode = reply->error();
     QString tag = reply->property("tag").toString();
+    tracer::asyncEnd("http", "Hodl", tag, reply->property("traceId").toULongLong());
+    tracer::Span traceSpan("http", "Hodl::replyFinished", tag);
 
     qDebug() << "Get back respond with tag: " << tag << "  Error code: " << errCode;
 
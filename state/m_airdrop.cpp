@@ -25,6 +25,7 @@
 #include <QJsonObject>
 #include <QUrlQuery>
 #include "../util/Log.h"
+#include "../util/tracer.h"
 #include <QFile>
 #include "../core/WndManager.h"
 #include "../bridge/BridgeManager.h"
@@ -207,6 +208,7 @@ void Airdrop::sendRequest(HTTP_CALL call, const QString & api,
         reply->setProperty("param2", QVariant(param2));
         reply->setProperty("param3", QVariant(param3));
         reply->setProperty("param4", QVariant(param4));
+        reply->setProperty("traceId", QVariant( tracer::asyncBegin("http", "Airdrop", tag) ));
         // Respond will be send back async
     }
 }
@@ -225,6 +227,8 @@ static QString generateMessage( QString errMessage, int errCode ) {
 void Airdrop::replyFinished(QNetworkReply* reply) {
     QNetworkReply::NetworkError errCode = reply->error();
     QString tag = reply->property("tag").toString();
+    tracer::asyncEnd("http", "Airdrop", tag, reply->property("traceId").toULongLong());
+    tracer::Span traceSpan("http", "Airdrop::replyFinished", tag);
 
     qDebug() << "Get back respond with tag: " << tag << "  Error code: " << errCode;
 
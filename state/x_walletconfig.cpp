@@ -101,7 +101,9 @@ core::SendCoinsParams  WalletConfig::getSendCoinsParams() const {
 // account refresh will be requested...
 void WalletConfig::setSendCoinsParams(const core::SendCoinsParams & params) {
     context->appContext->setSendCoinsParams(params);
-    context->wallet->updateWalletBalance(false,false); // Number of outputs might change, requesting update in background
+    // Number of outputs might change, requesting update in background.
+    // Balances depend on the confirmations number, wallet refreshes all accounts when it is changed.
+    context->wallet->updateWalletBalance(false,false);
 }
 
 double WalletConfig::getGuiScale() const {
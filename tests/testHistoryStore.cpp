@@ -0,0 +1,206 @@
+// Copyright 2020 The MWC Developers
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "testHistoryStore.h"
+#include "../wallet/historystore.h"
+#include "../util/crypto.h"
+#include <QFile>
+#include <QDataStream>
+#include <QTemporaryDir>
+#include <QtEndian>
+
+namespace test {
+
+using namespace wallet;
+
+static WalletTransaction tx(int64_t txIdx, bool confirmed, int64_t height) {
+    WalletTransaction t;
+    t.txIdx = txIdx;
+    t.transactionType = WalletTransaction::TRANSACTION_TYPE::SEND;
+    t.txid = "uuid-" + QString::number(txIdx);
+    t.address = "address-" + QString::number(txIdx % 2);
+    t.kernel = "kernel-" + QString::number(txIdx);
+    t.confirmed = confirmed;
+    t.height = height;
+    t.coinNano = -1000 * (txIdx+1);
+    return t;
+}
+
+// Plain FNV-1a 64, the way the index hashes could be computed without the key
+static quint64 fnv1a(const QByteArray & data) {
+    quint64 h = 14695981039346656037ULL;
+    for (char c : data)
+        h = (h ^ uchar(c)) * 1099511628211ULL;
+    return h;
+}
+
+static QByteArray hashBytes(quint64 h) {
+    uchar d[8];
+    qToLittleEndian(h, d);
+    return QByteArray( reinterpret_cast<const char *>(d), sizeof(d) );
+}
+
+// Check what was written by fillStore
+static void checkStore(const HistoryStore & store) {
+    Q_ASSERT( store.getTransactionsCount("default") == 5 );
+    Q_ASSERT( store.getMaxTxIdx("default") == 4 );
+
+    WalletTransaction t;
+    Q_ASSERT( store.getTransaction("default", 3, t) && t.txid == "uuid-3" && t.coinNano == -4000 && t.height == 103 );
+    Q_ASSERT( store.findTransactionByUuid("default", "uuid-2", t) && t.txIdx == 2 );
+    Q_ASSERT( store.findTransactionByKernel("default", "kernel-4", t) && t.txIdx == 4 );
+    Q_ASSERT( !store.findTransactionByUuid("default", "uuid-7", t) );
+    Q_ASSERT( store.findTransactionsByAddress("default", "address-1").size() == 2 );
+    Q_ASSERT( store.getTransactionsByHeight("default", 101, 102).size() == 2 );
+
+    QVector<WalletTransaction> page = store.getTransactionsPage("default", 1, 2);
+    Q_ASSERT( page.size() == 2 && page[0].txIdx == 3 && page[1].txIdx == 2 );
+
+    Q_ASSERT( store.getOutputs("default").size() == 2 );
+    Q_ASSERT( store.getTransactionOutputs("default", 4).size() == 1 );
+    Q_ASSERT( store.getTransactionsCount("another") == 0 );
+}
+
+void testHistoryStore() {
+    // Files are written into the temp dir, the real wallet data is not touched
+    QTemporaryDir dir;
+    Q_ASSERT( dir.isValid() );
+    const QString storeDir = dir.path();
+    const QString dataPath = "test_history_store_data_path";
+    // deriveKey is slow by design, test key is enough here
+    const QByteArray key = crypto::hmacSHA256("test key", "password");
+    const QString baseName = storeDir + "/history_" + crypto::calcHSA256Hash(dataPath).left(16);
+
+    QVector<WalletTransaction> txs;
+    for (int i=0; i<5; i++)
+        txs.push_back( tx(i, i<3, 100+i) );
+    QVector<WalletOutput> outs{
+        WalletOutput::create("c1000", "1", "100", "0", "Unspent", false, "11", 1000, 0),
+        WalletOutput::create("c2000", "2", "104", "0", "Unconfirmed", false, "0", 2000, 4) };
+
+    // Round trip
+    {
+        HistoryStore store(storeDir);
+        Q_ASSERT( store.open(dataPath, key) );
+        Q_ASSERT( store.updateTransactions("default", txs) == 5 );
+        Q_ASSERT( store.updateOutputs("default", outs, false, 110) == 2 );
+        checkStore(store);
+
+        // The same listing and the next block are not changes
+        Q_ASSERT( store.updateTransactions("default", txs) == 0 );
+        outs[0].numOfConfirms = 12;
+        Q_ASSERT( store.updateOutputs("default", outs, false, 111) == 0 );
+        WalletOutput out;
+        Q_ASSERT( store.getOutput("default", "c1000", out) && out.numOfConfirms == 12 && out.getStatus() == "Unspent" );
+        Q_ASSERT( store.getOutput("default", "c2000", out) && out.numOfConfirms == 0 );
+    }
+
+    // Records are encrypted
+    {
+        QFile log(baseName + ".log");
+        Q_ASSERT( log.open(QIODevice::ReadOnly) );
+        const QByteArray data = log.readAll();
+        // Strings are written by QDataStream, size goes first
+        QByteArray kernel;
+        QDataStream stream(&kernel, QIODevice::WriteOnly);
+        stream << QString("kernel-3");
+        Q_ASSERT( data.size() > 100 && !data.contains(kernel.mid(4)) );
+    }
+
+    // Index hashes are keyed, the known values can't be found there
+    QByteArray accountHash;
+    {
+        QFile idx(baseName + ".idx");
+        Q_ASSERT( idx.open(QIODevice::ReadOnly) );
+        const QByteArray data = idx.readAll();
+        for (const QString & str : {"default", "uuid-2", "kernel-4", "address-1", "c1000"}) {
+            const QByteArray utf8 = str.toUtf8();
+            QByteArray utf16( reinterpret_cast<const char *>(str.utf16()), str.size()*2 );
+            Q_ASSERT( !data.contains(hashBytes(fnv1a(utf8))) && !data.contains(hashBytes(fnv1a(utf16))) );
+            Q_ASSERT( !data.contains(crypto::HSA256(utf8).left(8)) );
+        }
+        // id, version, salt, then the first entry type, flags and account hash
+        accountHash = data.mid(8 + 16 + 8, 8);
+        Q_ASSERT( accountHash.size() == 8 );
+    }
+
+    // Reopen with the memory mapped index
+    {
+        HistoryStore store(storeDir);
+        Q_ASSERT( store.open(dataPath, key) );
+        checkStore(store);
+        Q_ASSERT( store.updateTransactions("default", txs) == 0 );
+    }
+
+    // Index is lost, it is rebuilt from the log
+    Q_ASSERT( QFile::remove(baseName + ".idx") );
+    {
+        HistoryStore store(storeDir);
+        Q_ASSERT( store.open(dataPath, key) );
+        checkStore(store);
+        Q_ASSERT( store.updateOutputs("default", outs, false, 111) == 0 );
+    }
+
+    // Broken tail is dropped. Log gets a new salt, so the next records don't reuse the key stream.
+    {
+        QFile log(baseName + ".log");
+        Q_ASSERT( log.open(QIODevice::ReadWrite) );
+        const QByteArray salt = log.read(8 + 16).mid(8);
+        const qint64 logSize = log.size();
+        Q_ASSERT( log.seek(logSize) && log.write("broken tail") == 11 );
+        log.close();
+
+        HistoryStore store(storeDir);
+        Q_ASSERT( store.open(dataPath, key) );
+        checkStore(store);
+        Q_ASSERT( log.open(QIODevice::ReadOnly) );
+        Q_ASSERT( log.size() == logSize && log.read(8 + 16).mid(8) != salt );
+    }
+
+    // Changed record is detected by MAC. The first record is transaction 0.
+    {
+        QFile log(baseName + ".log");
+        Q_ASSERT( log.open(QIODevice::ReadWrite) );
+        // id, version, salt, key check, record header
+        const qint64 pos = 8 + 16 + 16 + 12 + 4;
+        Q_ASSERT( log.seek(pos) );
+        char ch = 0;
+        Q_ASSERT( log.getChar(&ch) && log.seek(pos) && log.putChar(char(ch ^ 0x01)) );
+        log.close();
+
+        HistoryStore store(storeDir);
+        Q_ASSERT( store.open(dataPath, key) );
+        WalletTransaction t;
+        Q_ASSERT( !store.getTransaction("default", 0, t) );
+        Q_ASSERT( store.getTransaction("default", 1, t) && t.txid == "uuid-1" );
+    }
+
+    // Another password, data can't be read and it is dropped
+    {
+        HistoryStore store(storeDir);
+        Q_ASSERT( store.open(dataPath, crypto::hmacSHA256("test key", "another password")) );
+        Q_ASSERT( store.getTransactionsCount("default") == 0 );
+        Q_ASSERT( store.updateTransactions("default", txs) == 5 );
+
+        // The same account gets another hash with another key
+        QFile idx(baseName + ".idx");
+        Q_ASSERT( idx.open(QIODevice::ReadOnly) );
+        const QByteArray data = idx.readAll();
+        Q_ASSERT( data.size() > 40 && !data.contains(accountHash) );
+    }
+
+    HistoryStore::remove(dataPath, storeDir);
+}
+
+}
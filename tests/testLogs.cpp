@@ -15,15 +15,26 @@
 #include "testLogs.h"
 #include <QString>
 #include <QDir>
+#include <QFile>
 #include "../util/ioutils.h"
 #include <QStringList>
-#include "../core/Config.h"
 #include "../util/Log.h"
+#include "../util/mpscringbuffer.h"
+#include "../util/eventlog.h"
+#include "../util/tracer.h"
+#include "../util/FolderCompressor.h"
+#include <QtEndian>
+#include <QJsonDocument>
+#include <QJsonArray>
+#include <QJsonObject>
+#include <QSet>
+#include <QThread>
+#include <QVector>
+#include <thread>
 
 namespace test {
 
 // Write about 1 Gb of the logs and check how it will be rotated. Note, test will be slow.
-// Test expect mwczip  util.
 void testLogsRotation() {
 
     // Clean up logs first...
@@ -38,9 +49,6 @@ void testLogsRotation() {
         logDir.remove(fn);
     }
 
-    // It is a local test that is normally disabled. So using my custom build
-    config::setMwcZipPath("/Users/mw/mwc713/target/release/mwczip");
-
     logger::initLogger(true);
 
     for (int t=0; t<5000000; t++) {
@@ -48,5 +56,299 @@ void testLogsRotation() {
     }
 }
 
+void testLogsQueue() {
+    util::MpscRingBuffer<QString> queue(1000);
+    Q_ASSERT(queue.capacity() == 1024);
+
+    QString item;
+    Q_ASSERT(!queue.pop(item));
+    for (int i=0; i<1024; i++)
+        Q_ASSERT( queue.push(QString::number(i)) );
+    Q_ASSERT( !queue.push("full") );
+    Q_ASSERT( queue.size() == 1024 );
+    for (int i=0; i<1024; i++) {
+        Q_ASSERT( queue.pop(item) );
+        Q_ASSERT( item == QString::number(i) );
+    }
+    Q_ASSERT( queue.size() == 0 );
+
+    // Every producer writes its own increasing sequence, the order must be kept per producer.
+    // Items are several times more than the capacity, so the buffer wraps and gets full. Test runs at every debug start.
+    const int producers = 4;
+    const int items = 5000;
+    std::vector<std::thread> threads;
+    for (int p=0; p<producers; p++) {
+        threads.emplace_back( [&queue, p]() {
+            for (int i=0; i<items; i++) {
+                while ( !queue.push(QString::number(p) + ":" + QString::number(i)) )
+                    QThread::yieldCurrentThread();
+            }
+        } );
+    }
+
+    QVector<int> next(producers, 0);
+    int received = 0;
+    while (received < producers*items) {
+        if (!queue.pop(item)) {
+            QThread::yieldCurrentThread();
+            continue;
+        }
+        QStringList parts = item.split(':');
+        int p = parts[0].toInt();
+        Q_ASSERT( parts[1].toInt() == next[p] );
+        next[p]++;
+        received++;
+    }
+
+    for (auto & th : threads)
+        th.join();
+    Q_ASSERT( !queue.pop(item) );
+}
+
+void testEventLog() {
+    eventlog::Event evt = eventlog::makeEvent(eventlog::KIND::TASK, "TaskTransactions");
+    evt.who = "Mwc713EventManager";
+    evt.phase = "done";
+    evt.queueMs = 12;
+    evt.durationMs = 340;
+    evt.count = 25;
+    evt.message = "quote \" backslash \\ new line \n tab \t ctrl \x01 unicode \u00e9 \U0001F600";
+
+    QByteArray line = evt.toJsonLine();
+    Q_ASSERT( !line.contains('\n') );
+
+    eventlog::Event res;
+    Q_ASSERT( eventlog::Event::fromJsonLine(line, res) );
+    Q_ASSERT( res.kind == evt.kind && res.mono == evt.mono && res.time == evt.time );
+    Q_ASSERT( res.name == evt.name && res.who == evt.who && res.phase == evt.phase );
+    Q_ASSERT( res.queueMs == 12 && res.durationMs == 340 && res.count == 25 && res.bytes == -1 );
+    Q_ASSERT( res.message == evt.message );
+
+    Q_ASSERT( !eventlog::Event::fromJsonLine("{\"k\":\"task\",\"t\":1", res) ); // cut line
+    Q_ASSERT( !eventlog::Event::fromJsonLine("{\"k\":\"other\"}", res) );
+}
+
+void testLogBudget() {
+    logger::LogBudget budget;
+    Q_ASSERT( !logger::LogBudget::fromString("10,4", budget).first );
+    Q_ASSERT( !logger::LogBudget::fromString("10,-4,30", budget).first );
+    Q_ASSERT( logger::LogBudget::fromString(" 10, 4 ,30", budget).first );
+    Q_ASSERT( budget.linesPerSec == 10.0 && budget.bytesPerSec == 4096.0 && budget.burstSecs == 30.0 );
+
+    // 2 lines per second, burst 5 lines
+    budget.linesPerSec = 2.0;
+    budget.bytesPerSec = 0.0;
+    budget.burstSecs = 2.5;
+    const qint64 sec = 1000000;
+    qint64 now = 100*sec;
+
+    logger::LogLimiter limiter;
+    limiter.setBudget(budget, now);
+    QVector<QString> notes;
+
+    int admitted = 0;
+    for (int i=0; i<20; i++) {
+        if (limiter.admit("line " + QString::number(i), now, notes))
+            admitted++;
+    }
+    Q_ASSERT( admitted == 5 && notes.isEmpty() );
+
+    // One second later there are tokens for 2 lines, the first one comes with the skipped note
+    now += sec;
+    Q_ASSERT( limiter.admit("line next", now, notes) );
+    Q_ASSERT( notes.size() == 1 && notes[0].startsWith("15 lines") );
+    notes.clear();
+
+    // Repeats are folded
+    for (int i=0; i<100; i++)
+        Q_ASSERT( limiter.admit("same", now, notes) == (i==0) );
+    Q_ASSERT( notes.isEmpty() );
+    now += 10*sec;
+    Q_ASSERT( limiter.admit("other", now, notes) );
+    Q_ASSERT( notes.size() == 1 && notes[0] == "last line repeated 99 times" );
+    notes.clear();
+
+    logger::LogCategoryStats stats = limiter.getStats();
+    Q_ASSERT( stats.lines == 122 && stats.suppressedLines == 15 && stats.foldedLines == 99 );
+
+    // Unlimited budget still folds the repeats
+    limiter.setBudget(logger::LogBudget(), now);
+    for (int i=0; i<1000; i++)
+        Q_ASSERT( limiter.admit("unlimited " + QString::number(i), now, notes) );
+    Q_ASSERT( !limiter.admit("unlimited 999", now, notes) );
+    limiter.finish(notes);
+    Q_ASSERT( notes.size() == 1 && notes[0] == "last line repeated 1 times" );
+
+    // Notes are written before the line they are about
+    QStringList written;
+    auto write = [&written](const QString & text, bool note) { written.push_back( (note ? "note: " : "") + text ); };
+    Q_ASSERT( limiter.admitAndWrite("write", now, write) );
+    Q_ASSERT( !limiter.admitAndWrite("write", now, write) );
+    Q_ASSERT( limiter.admitAndWrite("write next", now, write) );
+    Q_ASSERT( written == QStringList({"write", "note: last line repeated 1 times", "write next"}) );
+}
+
+void testTracer() {
+    if (tracer::isTracing())
+        return; // Real tracing is running
+
+    const QString fileName = QDir::tempPath() + "/mwc-qt-wallet-trace-test.json";
+    Q_ASSERT( tracer::startTracing(fileName).first );
+
+    quint64 id = 0;
+    {
+        tracer::Span span("test", "main span");
+        id = tracer::asyncBegin("test", "request \"quoted\"");
+    }
+    std::thread th( [id]() {
+        tracer::Span span("test", QString("thread span"));
+        tracer::asyncEnd("test", "request \"quoted\"", id);
+    } );
+    th.join();
+    tracer::stopTracing();
+    Q_ASSERT( !tracer::isTracing() );
+
+    QFile file(fileName);
+    Q_ASSERT( file.open(QFile::ReadOnly) );
+    QJsonParseError error;
+    QJsonDocument doc = QJsonDocument::fromJson(file.readAll(), &error);
+    file.close();
+    QFile::remove(fileName);
+    Q_ASSERT( error.error == QJsonParseError::NoError && doc.isArray() );
+
+    QSet<int> spanLanes;
+    QSet<int> namedLanes;
+    int asyncEvents = 0;
+    for (const QJsonValue & v : doc.array()) {
+        QJsonObject evt = v.toObject();
+        const QString ph = evt["ph"].toString();
+        if (ph == "X") {
+            Q_ASSERT( evt["dur"].toDouble() >= 0 );
+            spanLanes.insert( evt["tid"].toInt() );
+        }
+        else if (ph == "b" || ph == "e") {
+            Q_ASSERT( evt["name"].toString() == "request \"quoted\"" );
+            Q_ASSERT( evt["id"].toString() == "0x" + QString::number(id, 16) );
+            asyncEvents++;
+        }
+        else if (ph == "M" && evt["name"].toString() == "thread_name") {
+            namedLanes.insert( evt["tid"].toInt() );
+        }
+    }
+    Q_ASSERT( spanLanes.size() == 2 && asyncEvents == 2 );
+    Q_ASSERT( namedLanes.contains(spanLanes) );
+}
+
+static quint32 testCrc32(const QByteArray & data) {
+    quint32 crc = 0xFFFFFFFF;
+    for (char ch : data) {
+        crc ^= quint8(ch);
+        for (int k=0; k<8; k++)
+            crc = (crc & 1) ? 0xEDB88320U ^ (crc >> 1) : crc >> 1;
+    }
+    return ~crc;
+}
+
+static quint32 testAdler32(const QByteArray & data) {
+    quint32 a = 1, b = 0;
+    for (char ch : data) {
+        a = (a + quint8(ch)) % 65521;
+        b = (b + a) % 65521;
+    }
+    return (b << 16) | a;
+}
+
+// Size of the gzip member header (RFC 1952), -1 if it is not valid
+static int testGzipHeaderSize(const QByteArray & member) {
+    const uchar * d = reinterpret_cast<const uchar *>(member.constData());
+    if (member.size() < 10 || d[0] != 0x1f || d[1] != 0x8b || d[2] != 8)
+        return -1;
+    const uchar flags = d[3];
+    int pos = 10;
+    if (flags & 0x04) { // FEXTRA
+        if (member.size() < pos + 2)
+            return -1;
+        pos += 2 + qFromLittleEndian<quint16>(d + pos);
+    }
+    for (uchar flag : {uchar(0x08), uchar(0x10)}) { // FNAME, FCOMMENT, zero terminated
+        if (flags & flag) {
+            const int zero = member.indexOf('\0', pos);
+            if (zero < 0)
+                return -1;
+            pos = zero + 1;
+        }
+    }
+    if (flags & 0x02) // FHCRC
+        pos += 2;
+    return pos <= member.size() ? pos : -1;
+}
+
+// Qt can inflate zlib streams only (qUncompress format: size, zlib header, deflate, adler32).
+// zlib checks adler32 after inflate, so it is taken from the expected data.
+static QByteArray testInflate(const QByteArray & deflate, const QByteArray & expected) {
+    uchar sizeBE[4];
+    qToBigEndian<quint32>(quint32(expected.size()), sizeBE);
+    uchar adlerBE[4];
+    qToBigEndian<quint32>(testAdler32(expected), adlerBE);
+    return qUncompress( QByteArray(reinterpret_cast<const char *>(sizeBE), 4) + QByteArray("\x78\x9c", 2) + deflate +
+                        QByteArray(reinterpret_cast<const char *>(adlerBE), 4) );
+}
+
+void testGzipFile() {
+    const QString srcName = QDir::tempPath() + "/mwc-qt-wallet-gzip-test.log";
+    const QString gzName = srcName + ".gz";
+
+    // 2.5 chunks of log like lines with some noise
+    QByteArray src;
+    quint32 rnd = 12345;
+    for (int i=0; src.size() < 5*512*1024; i++) {
+        rnd = rnd * 1103515245 + 12345;
+        src += "17.10.2026 10:00:00.123 MWC713 line " + QByteArray::number(i) + " value " + QByteArray::number(rnd) + "\n";
+        src += char(rnd >> 24);
+    }
+    {
+        QFile f(srcName);
+        Q_ASSERT( f.open(QIODevice::WriteOnly) && f.write(src) == src.size() );
+    }
+
+    QVector<qint64> offsets;
+    QPair<bool, QString> res = compress::gzipFile(srcName, gzName, &offsets);
+    Q_ASSERT( res.first );
+
+    QFile gz(gzName);
+    Q_ASSERT( gz.open(QIODevice::ReadOnly) );
+    const QByteArray data = gz.readAll();
+    gz.close();
+    Q_ASSERT( data.size() < src.size() );
+    Q_ASSERT( !offsets.isEmpty() && offsets[0] == 0 );
+
+    // Every member: header, raw deflate, crc32, size. Member ends where the next one starts.
+    QByteArray restored;
+    int members = 0;
+    for (int m=0; m<offsets.size(); m++) {
+        const int begin = int(offsets[m]);
+        const int end = m+1 < offsets.size() ? int(offsets[m+1]) : data.size();
+        const QByteArray member = data.mid(begin, end - begin);
+
+        const int dataPos = testGzipHeaderSize(member);
+        Q_ASSERT( dataPos > 0 && member.size() >= dataPos + 8 );
+        const uchar * trailer = reinterpret_cast<const uchar *>(member.constData() + member.size() - 8);
+        const quint32 crc = qFromLittleEndian<quint32>(trailer);
+        const quint32 size = qFromLittleEndian<quint32>(trailer + 4);
+
+        const QByteArray expected = src.mid(restored.size(), int(size));
+        const QByteArray chunk = testInflate( member.mid(dataPos, member.size() - dataPos - 8), expected );
+        Q_ASSERT( chunk.size() == int(size) && testCrc32(chunk) == crc );
+        Q_ASSERT( chunk == expected );
+        restored += chunk;
+        members++;
+    }
+
+    Q_ASSERT( members == 3 );
+    Q_ASSERT( restored == src );
+
+    QFile::remove(srcName);
+    QFile::remove(gzName);
+}
 
 }
@@ -18,9 +18,23 @@
 namespace test {
 
 // Write about 1 Gb of the logs and check how it will be rotated. Note, test will be slow.
-// Test expect mwczip  util.
 void testLogsRotation();
 
+// Several producers and a single consumer over the logger queue
+void testLogsQueue();
+
+// Structured event encoding round trip
+void testEventLog();
+
+// Budget and repeats folding of the noisy log sources
+void testLogBudget();
+
+// Trace file is a valid Chrome trace JSON with a lane per thread
+void testTracer();
+
+// Rotated logs archive of several chunks is decompressed back to the original data
+void testGzipFile();
+
 }
 
 
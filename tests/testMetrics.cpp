@@ -0,0 +1,74 @@
+// Copyright 2020 The MWC Developers
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "testMetrics.h"
+#include "../wallet/mwc713metrics.h"
+#include "../wallet/mwc713events.h"
+#include <limits>
+
+namespace test {
+
+void testLatencyHistogram() {
+    using namespace wallet;
+
+    // Buckets must be continuous and cover the value
+    int prevIdx = -1;
+    for (qint64 v = 0; v < 100000; v++) {
+        const int idx = LatencyHistogram::bucketIndex(v);
+        Q_ASSERT( idx == prevIdx || idx == prevIdx+1 );
+        Q_ASSERT( LatencyHistogram::bucketHighValue(idx) >= v );
+        Q_ASSERT( idx == 0 || LatencyHistogram::bucketHighValue(idx-1) < v );
+        prevIdx = idx;
+    }
+    // The top bucket ends at the max value, no overflow
+    const int topIdx = LatencyHistogram::bucketIndex( std::numeric_limits<qint64>::max() );
+    Q_ASSERT( LatencyHistogram::bucketHighValue(topIdx) == std::numeric_limits<qint64>::max() );
+    Q_ASSERT( LatencyHistogram::bucketHighValue(topIdx-1) < LatencyHistogram::bucketHighValue(topIdx) );
+    Q_ASSERT( LatencyHistogram::bucketHighValue(topIdx+1) == std::numeric_limits<qint64>::max() );
+
+    LatencyHistogram h;
+    Q_ASSERT( h.getCount() == 0 && h.getPercentile(50.0) == 0 );
+
+    for (qint64 v = 1; v <= 1000; v++)
+        h.record(v);
+
+    Q_ASSERT( h.getCount() == 1000 );
+    Q_ASSERT( h.getMin() == 1 && h.getMax() == 1000 );
+    Q_ASSERT( qAbs(h.getMean() - 500.5) < 0.001 );
+
+    // Precision is about 3%
+    Q_ASSERT( qAbs( h.getPercentile(50.0) - 500 ) <= 500/32 );
+    Q_ASSERT( qAbs( h.getPercentile(99.0) - 990 ) <= 990/32 );
+    Q_ASSERT( h.getPercentile(100.0) == 1000 );
+
+    h.record(-5); // negative goes to 0
+    Q_ASSERT( h.getMin() == 0 );
+
+    h.clear();
+    Q_ASSERT( h.getCount() == 0 && h.getMax() == 0 );
+}
+
+void testTaskTimeout() {
+    using namespace wallet;
+
+    Q_ASSERT( Mwc713EventManager::scaleTimeoutByWalletSize(1000, 0) == 1000 );
+    Q_ASSERT( Mwc713EventManager::scaleTimeoutByWalletSize(1000, -1) == 1000 );
+    Q_ASSERT( Mwc713EventManager::scaleTimeoutByWalletSize(1000, 2000) == 2000 );
+    Q_ASSERT( Mwc713EventManager::scaleTimeoutByWalletSize(1000, 5000) == 3500 );
+    // Large wallet, timeout is capped
+    Q_ASSERT( Mwc713EventManager::scaleTimeoutByWalletSize(1000, 6000) == 4000 );
+    Q_ASSERT( Mwc713EventManager::scaleTimeoutByWalletSize(1000, 100000) == 4000 );
+}
+
+}
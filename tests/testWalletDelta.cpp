@@ -0,0 +1,73 @@
+// Copyright 2020 The MWC Developers
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "testWalletDelta.h"
+#include "../wallet/wallet.h"
+
+namespace test {
+
+static wallet::WalletTransaction tx(int64_t txIdx, bool confirmed, int64_t height) {
+    wallet::WalletTransaction t;
+    t.txIdx = txIdx;
+    t.transactionType = wallet::WalletTransaction::TRANSACTION_TYPE::SEND;
+    t.txid = "tx" + QString::number(txIdx);
+    t.confirmed = confirmed;
+    t.height = height;
+    return t;
+}
+
+void testWalletDelta() {
+    using namespace wallet;
+
+    QVector<WalletTransaction> prev{ tx(0, true, 100), tx(1, false, 0), tx(2, false, 0) };
+    QVector<WalletTransaction> next{ tx(0, true, 100), tx(1, true, 105), tx(3, false, 0) };
+
+    TransactionsDelta td = TransactionsDelta::calc("default", 110, prev, prev);
+    Q_ASSERT( td.isEmpty() && td.account == "default" && td.height == 110 );
+
+    td = TransactionsDelta::calc("default", 110, prev, next);
+    Q_ASSERT( td.inserted.size() == 1 && td.inserted[0].txIdx == 3 );
+    Q_ASSERT( td.updated.size() == 1 && td.updated[0].txIdx == 1 && td.updated[0].confirmed );
+    Q_ASSERT( td.removed == QVector<int64_t>{2} );
+
+    // Cancellation is a change
+    next[2].cancelled();
+    QVector<WalletTransaction> next2 = next;
+    next2[2].transactionType = wallet::WalletTransaction::TRANSACTION_TYPE::SEND;
+    td = TransactionsDelta::calc("default", 110, next2, next);
+    Q_ASSERT( td.inserted.isEmpty() && td.removed.isEmpty() && td.updated.size() == 1 && td.updated[0].txIdx == 3 );
+
+    QVector<WalletOutput> prevOut{
+        WalletOutput::create("c1000", "1", "100", "0", "Unspent", false, "10", 1000, 0),
+        WalletOutput::create("c2000", "2", "105", "0", "Unconfirmed", false, "0", 2000, 1) };
+    QVector<WalletOutput> nextOut{
+        WalletOutput::create("c1000", "1", "100", "0", "Locked", false, "11", 1000, 0),
+        WalletOutput::create("c3000", "3", "110", "0", "Unconfirmed", false, "0", 3000, 3) };
+
+    OutputsDelta od = OutputsDelta::calc("default", 110, prevOut, prevOut);
+    Q_ASSERT( od.isEmpty() );
+
+    // Confirmations are derived from the height, new block is not a change
+    QVector<WalletOutput> nextBlockOut = prevOut;
+    nextBlockOut[0].numOfConfirms++;
+    od = OutputsDelta::calc("default", 111, prevOut, nextBlockOut);
+    Q_ASSERT( od.isEmpty() );
+
+    od = OutputsDelta::calc("default", 110, prevOut, nextOut);
+    Q_ASSERT( od.inserted.size() == 1 && od.inserted[0].getOutputCommitment() == "c3000" );
+    Q_ASSERT( od.updated.size() == 1 && od.updated[0].getOutputCommitment() == "c1000" );
+    Q_ASSERT( od.removed == QVector<QString>{"c2000"} );
+}
+
+}
@@ -0,0 +1,25 @@
+// Copyright 2020 The MWC Developers
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MWC_QT_WALLET_TESTWALLETDELTA_H
+#define MWC_QT_WALLET_TESTWALLETDELTA_H
+
+namespace test {
+
+// Check transactions and outputs deltas between two listings
+void testWalletDelta();
+
+}
+
+#endif //MWC_QT_WALLET_TESTWALLETDELTA_H
@@ -0,0 +1,233 @@
+// Copyright 2019 The MWC Developers
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Offline query tool for the structured event logs (mwcwallet.events.jsonl, see util/eventlog.h).
+// Prints matched events or latency statistics by event name.
+// Rotated archives are gzip files, unpack them first.
+//
+// Build:  cmake -DMWC_BUILD_EVENT_TOOL=ON
+// Usage:  mwc-events [--kind <parsing|node|task|emit|info>]... [--name <name>]... [--task <task name>]...
+//                    [--phase <phase>] [--from <time>] [--to <time>] [--limit <N>] [--stats] <file>...
+// Time is 'yyyy-MM-dd hh:mm:ss' local time or msecs since epoch.
+// --task limits task events only, other kinds pass. Example, node events and one task: --kind node --kind task --task TaskSync
+
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QDateTime>
+#include <QFile>
+#include <QMap>
+#include <QSet>
+#include <QTextStream>
+#include <QVector>
+#include <algorithm>
+#include "../util/eventlog.h"
+
+namespace evtquery {
+
+struct Filter {
+    QSet<int> kinds; // eventlog::KIND
+    QSet<QString> names;
+    QSet<QString> tasks; // Applied to the task events only
+    QString phase;
+    qint64 from = -1;
+    qint64 to = -1;
+
+    bool match(const eventlog::Event & evt) const {
+        if (!kinds.isEmpty() && !kinds.contains(int(evt.kind)))
+            return false;
+        if (!names.isEmpty() && !names.contains(evt.name))
+            return false;
+        if (evt.kind == eventlog::KIND::TASK && !tasks.isEmpty() && !tasks.contains(evt.name))
+            return false;
+        if (!phase.isEmpty() && evt.phase != phase)
+            return false;
+        if (from >= 0 && evt.time < from)
+            return false;
+        if (to >= 0 && evt.time > to)
+            return false;
+        return true;
+    }
+};
+
+// Durations of the events with the same name
+struct Latency {
+    QVector<qint64> duration;
+    QVector<qint64> queue;
+    qint64 count = 0;
+};
+
+static qint64 parseTime(const QString & str, bool & ok) {
+    ok = true;
+    if (str.isEmpty())
+        return -1;
+    bool isNumber = false;
+    qint64 msecs = str.toLongLong(&isNumber);
+    if (isNumber)
+        return msecs;
+    QDateTime dt = QDateTime::fromString(str, "yyyy-MM-dd hh:mm:ss");
+    if (!dt.isValid())
+        dt = QDateTime::fromString(str, "yyyy-MM-dd");
+    ok = dt.isValid();
+    return ok ? dt.toMSecsSinceEpoch() : -1;
+}
+
+static QString percentiles(QVector<qint64> values) {
+    if (values.isEmpty())
+        return "-";
+    std::sort(values.begin(), values.end());
+    auto pct = [&values](int p) { return values[ std::min(values.size()-1, values.size()*p/100) ]; };
+    qint64 sum = 0;
+    for (qint64 v : values)
+        sum += v;
+    return "min " + QString::number(values.front()) + "  p50 " + QString::number(pct(50)) +
+           "  p90 " + QString::number(pct(90)) + "  p99 " + QString::number(pct(99)) +
+           "  max " + QString::number(values.back()) + "  avg " + QString::number(double(sum)/values.size(), 'f', 1);
+}
+
+static QString toText(const eventlog::Event & evt) {
+    QString res = QDateTime::fromMSecsSinceEpoch(evt.time).toString("dd.MM.yyyy hh:mm:ss.zzz") +
+                  " +" + QString::number(double(evt.mono)/1000.0, 'f', 3) + "ms " +
+                  eventlog::toString(evt.kind) + " " + evt.name;
+    if (!evt.who.isEmpty())
+        res += " who=" + evt.who;
+    if (!evt.phase.isEmpty())
+        res += " phase=" + evt.phase;
+    if (evt.queueMs >= 0)
+        res += " queue=" + QString::number(evt.queueMs) + "ms";
+    if (evt.durationMs >= 0)
+        res += " duration=" + QString::number(evt.durationMs) + "ms";
+    if (evt.count >= 0)
+        res += " count=" + QString::number(evt.count);
+    if (evt.bytes >= 0)
+        res += " bytes=" + QString::number(evt.bytes);
+    if (!evt.message.isEmpty())
+        res += " [" + evt.message + "]";
+    return res;
+}
+
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("mwc-events");
+
+    QCommandLineParser cmdParser;
+    cmdParser.setApplicationDescription("Query mwc-qt-wallet structured event logs");
+    cmdParser.addHelpOption();
+    cmdParser.addOptions({
+        {"kind", "Event kind: parsing, node, task, emit, info", "kind"},
+        {"name", "Event name: WALLET_EVENTS, NODE_OUTPUT_EVENT, task name or emitted signal", "name"},
+        {"task", "Task events with this task name, events of other kinds are not filtered", "task"},
+        {"phase", "Task phase: 'Starting...', 'Executing', 'done'", "phase"},
+        {"from", "Events not earlier than", "time"},
+        {"to", "Events not later than", "time"},
+        {"limit", "Print not more than N events", "N", "0"},
+        {"stats", "Print counts and latency statistics by event instead of events"},
+    });
+    cmdParser.addPositionalArgument("files", "Event log files (*.events.jsonl)");
+    cmdParser.process(app);
+
+    QTextStream out(stdout);
+    QTextStream err(stderr);
+
+    evtquery::Filter filter;
+    for (const QString & k : cmdParser.values("kind")) {
+        eventlog::KIND kind = eventlog::kindFromString(k);
+        if (kind == eventlog::KIND::UNKNOWN) {
+            err << "Unknown event kind: " << k << "\n";
+            return 1;
+        }
+        filter.kinds.insert(int(kind));
+    }
+    for (const QString & n : cmdParser.values("name"))
+        filter.names.insert(n);
+    for (const QString & n : cmdParser.values("task"))
+        filter.tasks.insert(n);
+    filter.phase = cmdParser.value("phase");
+
+    bool okFrom = true, okTo = true;
+    filter.from = evtquery::parseTime(cmdParser.value("from"), okFrom);
+    filter.to = evtquery::parseTime(cmdParser.value("to"), okTo);
+    if (!okFrom || !okTo) {
+        err << "Unable to parse time, expected 'yyyy-MM-dd hh:mm:ss' or msecs since epoch\n";
+        return 1;
+    }
+
+    const qint64 limit = cmdParser.value("limit").toLongLong();
+    const bool stats = cmdParser.isSet("stats");
+
+    const QStringList files = cmdParser.positionalArguments();
+    if (files.isEmpty()) {
+        cmdParser.showHelp(1);
+    }
+
+    QMap<QString, evtquery::Latency> latency; // key: kind/name
+    qint64 matched = 0;
+    qint64 broken = 0;
+    bool ok = true;
+
+    for (const QString & fn : files) {
+        QFile file(fn);
+        if (!file.open(QIODevice::ReadOnly)) {
+            err << "Unable to open " << fn << "\n";
+            ok = false;
+            continue;
+        }
+
+        while (!file.atEnd()) {
+            QByteArray line = file.readLine().trimmed();
+            if (line.isEmpty())
+                continue;
+
+            eventlog::Event evt;
+            if (!eventlog::Event::fromJsonLine(line, evt)) {
+                broken++; // Last line might be cut if the wallet was killed
+                continue;
+            }
+            if (!filter.match(evt))
+                continue;
+
+            matched++;
+            if (stats) {
+                evtquery::Latency & lt = latency[eventlog::toString(evt.kind) + " " + evt.name];
+                lt.count++;
+                if (evt.durationMs >= 0)
+                    lt.duration.push_back(evt.durationMs);
+                if (evt.queueMs >= 0)
+                    lt.queue.push_back(evt.queueMs);
+            }
+            else if (limit <= 0 || matched <= limit) {
+                out << evtquery::toText(evt) << "\n";
+            }
+        }
+    }
+
+    if (stats) {
+        for (auto lt = latency.constBegin(); lt != latency.constEnd(); lt++) {
+            out << lt.key() << "  count " << lt.value().count << "\n";
+            if (!lt.value().duration.isEmpty())
+                out << "    duration ms: " << evtquery::percentiles(lt.value().duration) << "\n";
+            if (!lt.value().queue.isEmpty())
+                out << "    queue ms:    " << evtquery::percentiles(lt.value().queue) << "\n";
+        }
+    }
+
+    err << "Matched events: " << matched;
+    if (broken > 0)
+        err << ", unreadable lines: " << broken;
+    err << "\n";
+
+    return ok ? 0 : 1;
+}
@@ -16,13 +16,6 @@
 
 namespace tries {
 
-LineResult::LineResult(const LineResult & other, SectionResult && next ) :
-    parseResult(other.parseResult)
-{
-    parseResult.append(next);
-}
-
-
 QDebug operator<<(QDebug dbg, const LineResult& res) {
     dbg << "LineResult(";
     for (auto & r: res.parseResult) {
@@ -32,6 +25,13 @@ QDebug operator<<(QDebug dbg, const LineResult& res) {
     return dbg;
 }
 
+// Min stream position that is referenced by the result. Return 'pos' if it is less
+qint64 LineRanges::getMinPos(qint64 pos) const {
+    for (int i=0; i<size; i++)
+        pos = std::min(pos, ranges[i].start);
+    return pos;
+}
+
 
 BaseTrieSection::BaseTrieSection(int _accumulateId) : accumulateId(_accumulateId) {}
 BaseTrieSection::~BaseTrieSection() {}
@@ -45,55 +45,90 @@ void BaseTrieSection::appendNextParsers(BaseTrieSection * _nextParser) {
 }
 
 // Current section context
-TrieSectionContext::TrieSectionContext(BaseTrieSection * const _section, const LineResult & prevResult) :
-    prevParseResults(prevResult),
-    section(_section)
-{
+void TrieSectionContext::init(BaseTrieSection * _section, const LineRanges & prevResult) {
+    prevParseResults = prevResult;
+    section = _section;
     accId = section->getAccumulateId();
+    accLen = 0;
+    sectionContext = TrieContext();
 }
 
 // return PROCESS_RESULT flags
 uint32_t TrieSectionContext::processChar( QChar ch )
 {
     uint32_t res = section->processChar(sectionContext, ch);
+    accLen++;
+    return res;
+}
 
+// Calculate results for current state. pos - stream position of the last processed char
+void TrieSectionContext::calcResult(qint64 pos, LineRanges & result) const {
+    result = prevParseResults;
     // Note, last symbol need to be excluded
     if (accId>=0)
-        accStr += ch;
-
-    return res;
+        result.add( pos - accLen + 1, std::max(accLen-1,0), accId );
 }
 
-LineResult TrieSectionContext::calcResult() const {
-    if (accId<0)
-        return prevParseResults;
-
-    return LineResult(prevParseResults, SectionResult(accStr.left( std::max(accStr.size()-1,0) ) ,accId) );
+// Min stream position that this context still need
+qint64 TrieSectionContext::getMinPos(qint64 pos) const {
+    return prevParseResults.getMinPos( pos - accLen + 1 );
 }
 
-
 // Context from the whole line
 TrieLineContext::TrieLineContext(bool _isSingleActiveContext) : isSingleActiveContext(_isSingleActiveContext) {}
 
 TrieLineContext::~TrieLineContext() {
     releaseData();
+    for (auto cnt : pool) {
+        delete cnt;
+    }
+    pool.clear();
+    freeContexts.clear();
 }
 
 void TrieLineContext::releaseData() {
     for (auto cnt : contexts) {
-        delete cnt;
+        releaseContext(cnt);
     }
-    contexts.clear();
+    contexts.resize(0);
 }
 
 void TrieLineContext::reset() {
     releaseData();
 }
 
+TrieSectionContext * TrieLineContext::acquireContext(BaseTrieSection * section, const LineRanges & prevResult) {
+    TrieSectionContext * context = nullptr;
+    if (freeContexts.isEmpty()) {
+        context = new TrieSectionContext();
+        pool.push_back(context);
+    }
+    else {
+        context = freeContexts.last();
+        freeContexts.removeLast();
+    }
+    context->init(section, prevResult);
+    return context;
+}
+
+void TrieLineContext::releaseContext(TrieSectionContext * context) {
+    freeContexts.push_back(context);
+}
+
 // Process char against whole context
-void TrieLineContext::processChar( BaseTrieSection * headSection, QChar ch ) {
+void TrieLineContext::processChar( BaseTrieSection * headSection, QChar ch, qint64 pos ) {
     // Process what we already have
+    processActiveChar(ch, pos);
+
+    // Every iteration try to start a new parser
+    if (isSingleActiveContext && !contexts.isEmpty())
+        return;
 
+    startNewSectionAndProcess( headSection, LineRanges(), ch, pos );
+}
+
+// Process char for already started sections only. Head section is not tried.
+void TrieLineContext::processActiveChar( QChar ch, qint64 pos ) {
     int sz = contexts.size();
     for ( int i=sz-1; i>=0; i-- ) {
         TrieSectionContext* cont = contexts[i];
@@ -101,7 +136,7 @@ void TrieLineContext::processChar( BaseTrieSection * headSection, QChar ch ) {
 
         if ( res & (BaseTrieSection::PROCESS_RESULT::DONE | BaseTrieSection::PROCESS_RESULT::START_NEXT) ) {
             processContext(cont, (res & BaseTrieSection::PROCESS_RESULT::DONE)!=0,
-                           (res & BaseTrieSection::PROCESS_RESULT::START_NEXT)!=0, ch);
+                           (res & BaseTrieSection::PROCESS_RESULT::START_NEXT)!=0, ch, pos);
 
         }
 
@@ -110,41 +145,67 @@ void TrieLineContext::processChar( BaseTrieSection * headSection, QChar ch ) {
         }
 
         // FAIL, DONE(not Keep) should be here
-        delete cont;
+        releaseContext(cont);
         contexts.remove(i);
     }
+}
 
-    // Every iteration try to start a new parser
-    if (isSingleActiveContext && !contexts.isEmpty())
+// Head section was matched by front-end, continue with the next sections.
+void TrieLineContext::startAfterHead( BaseTrieSection * headSection, int headLen, qint64 pos ) {
+    LineRanges headResult;
+    // Same as TrieSectionContext::calcResult, last symbol is excluded
+    if (headSection->getAccumulateId()>=0)
+        headResult.add( pos - headLen + 1, std::max(headLen-1,0), headSection->getAccumulateId() );
+
+    const QVector<BaseTrieSection*> & next = headSection->getNextParser();
+    if (next.empty()) {
+        readyResult.push_back( headResult );
         return;
+    }
+
+    for (auto ns : next) {
+        contexts.push_back( acquireContext(ns, headResult) );
+    }
+}
 
-    startNewSectionAndProcess( headSection, LineResult(), ch );
+// Min stream position that is still referenced by sections in progress.
+qint64 TrieLineContext::getMinPos(qint64 pos) const {
+    qint64 minPos = pos + 1;
+    for (auto cnt : contexts) {
+        minPos = std::min( minPos, cnt->getMinPos(pos) );
+    }
+    return minPos;
 }
 
-void TrieLineContext::processContext(TrieSectionContext* context, bool done, bool startNext, QChar ch) {
+void TrieLineContext::processContext(TrieSectionContext* context, bool done, bool startNext, QChar ch, qint64 pos) {
     Q_ASSERT(done || startNext);
     const QVector<BaseTrieSection*> & next = context->getNextSections();
 
     if (next.empty()) { // last in the chain - mean we can get results, but we can't spawn new sections
-        if ( done )
-            readyResult.push_back( context->calcResult() );
+        if ( done ) {
+            readyResult.resize( readyResult.size()+1 );
+            context->calcResult( pos, readyResult.last() );
+        }
         return;
     }
 
+    LineRanges result;
+    context->calcResult( pos, result );
+
     if (startNext) {
         for (auto ns : next) {
-            startNewSectionAndProcess( ns, context->calcResult(), ch );
+            startNewSectionAndProcess( ns, result, ch, pos );
         }
     }
     else {
         // Just append new sections
         for (auto ns : next) {
-            contexts.push_back( new TrieSectionContext(ns, context->calcResult()) );
+            contexts.push_back( acquireContext(ns, result) );
         }
     }
 }
 
-void TrieLineContext::startNewSectionAndProcess( BaseTrieSection * newSection, LineResult && prevResult, QChar ch ) {
+void TrieLineContext::startNewSectionAndProcess( BaseTrieSection * newSection, const LineRanges & prevResult, QChar ch, qint64 pos ) {
 
     { // preliminary test. Just test a symbol and discard if no match
         TrieContext tc;
@@ -157,12 +218,12 @@ void TrieLineContext::startNewSectionAndProcess( BaseTrieSection * newSection, L
             return;
     }
 
-    TrieSectionContext * newContext = new TrieSectionContext(newSection, prevResult );
+    TrieSectionContext * newContext = acquireContext(newSection, prevResult );
     uint32_t res = newContext->processChar(ch);
 
     if ( res & (BaseTrieSection::PROCESS_RESULT::DONE | BaseTrieSection::PROCESS_RESULT::START_NEXT) ) {
         processContext(newContext, (res & BaseTrieSection::PROCESS_RESULT::DONE)!=0,
-                       (res & BaseTrieSection::PROCESS_RESULT::START_NEXT)!=0, ch);
+                       (res & BaseTrieSection::PROCESS_RESULT::START_NEXT)!=0, ch, pos);
 
     }
 
@@ -172,8 +233,8 @@ void TrieLineContext::startNewSectionAndProcess( BaseTrieSection * newSection, L
         return;
     }
 
-    // Seems like nobody need that. Deleting the context
-    delete newContext;
+    // Seems like nobody need that. Returning the context back to the pool
+    releaseContext(newContext);
 }
 
 
@@ -220,12 +281,22 @@ void TrieLineParser::connectLineSections( int lastAddIdx ) {
         s2->setParentParsers(s1);
         s1->appendNextParsers(s2);
     }
+
+    // Results are stored in the fixed size LineRanges. Parsers are built at start,
+    // so a wrong configuration stops the wallet instead of losing the parsed data.
+    int accNum = 0;
+    for (auto s : sections) {
+        if (s->getAccumulateId()>=0)
+            accNum++;
+    }
+    if (accNum > LineRanges::MAX_SECTIONS)
+        qFatal("TrieLineParser %d has %d accumulated sections, max is %d", parserId, accNum, int(LineRanges::MAX_SECTIONS));
 }
 
 // return true if TrieLineContext has some result;
-bool TrieLineParser::process( QChar ch, TrieLineContext * context ) {
+bool TrieLineParser::process( QChar ch, qint64 pos, TrieLineContext * context ) {
     Q_ASSERT( sections.size()>0 );
-    context->processChar( sections.front(), ch );
+    context->processChar( sections.front(), ch, pos );
     return context->hasResults();
 }
 
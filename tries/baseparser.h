@@ -38,8 +38,6 @@ public:
     ~LineResult() = default;
     LineResult(const LineResult &) = default;
 
-    LineResult(const LineResult & other, SectionResult && next );
-
     LineResult & operator=(const LineResult &) = default;
 
     void AddResult(const SectionResult & res) {parseResult.push_back(res);}
@@ -49,6 +47,36 @@ public:
 
 QDebug operator<<(QDebug dbg, const LineResult& res);
 
+// Accumulated data of a single section while parsing is in progress.
+// Data is not copied, it is a range of the input stream. See InputParser for stream position details.
+struct SectionRange {
+    qint64 start = 0;
+    int    len = 0;
+    int    dataId = 0;
+};
+
+// Results from single chain (line) while parsing is in progress.
+// Fixed size, so copy doesn't touch the heap.
+class LineRanges {
+public:
+    enum { MAX_SECTIONS = 8 }; // Max number of the accumulated sections per TrieLineParser
+
+    // TrieLineParser checks the number of accumulated sections when it is built, so it fits
+    void add(qint64 start, int len, int dataId) {
+        Q_ASSERT(size < MAX_SECTIONS);
+        SectionRange & r = ranges[size++];
+        r.start = start;
+        r.len = len;
+        r.dataId = dataId;
+    }
+
+    // Min stream position that is referenced by the result. Return 'pos' if it is less
+    qint64 getMinPos(qint64 pos) const;
+
+    int size = 0;
+    SectionRange ranges[MAX_SECTIONS];
+};
+
 // Context for a single trie
 class TrieContext {
 public:
@@ -77,6 +105,15 @@ public:
     enum PROCESS_RESULT { FAIL = 0, DONE = 0x01, KEEP = 0x02, START_NEXT = 0x04 };
     virtual uint32_t processChar(TrieContext & context, QChar ch) = 0;
 
+    // Hint for the InputParser front-end, what the head section can start with.
+    // HEAD_ANY - no prediction, the section will be tried with every symbol.
+    // HEAD_PHRASE - case sensitive fixed phrase, see getHeadPhrase()
+    // HEAD_NEW_LINE - can start with a new line symbol only
+    enum HEAD_TYPE { HEAD_ANY = 0, HEAD_PHRASE = 1, HEAD_NEW_LINE = 2 };
+    virtual HEAD_TYPE getHeadType() const {return HEAD_ANY;}
+    // Valid for HEAD_PHRASE only
+    virtual QString getHeadPhrase() const {return "";}
+
     void setParentParsers(BaseTrieSection * prevParser);
     void appendNextParsers(BaseTrieSection * nextParser);
 
@@ -89,24 +126,32 @@ protected:
     QVector<BaseTrieSection*> nextParser; // Next parsers in the chain. Can be many
 };
 
-// Current section context
+// Current section context. Instances are pooled by TrieLineContext, init() starts a new life cycle.
 class TrieSectionContext {
 public:
-    TrieSectionContext(BaseTrieSection * const section, const LineResult & prevResult );
+    TrieSectionContext() = default;
+
+    TrieSectionContext(const TrieSectionContext&) = delete;
+    TrieSectionContext & operator=(const TrieSectionContext&) = delete;
+
+    void init(BaseTrieSection * section, const LineRanges & prevResult);
 
     // return PROCESS_RESULT flags
     uint32_t processChar( QChar ch );
 
-    // Calculate results for current state
-    LineResult calcResult() const;
+    // Calculate results for current state. pos - stream position of the last processed char
+    void calcResult(qint64 pos, LineRanges & result) const;
+
+    // Min stream position that this context still need. pos - stream position of the last processed char
+    qint64 getMinPos(qint64 pos) const;
 
     const QVector<BaseTrieSection*> & getNextSections() const { return section->getNextParser(); }
 
 protected:
-    LineResult        prevParseResults;
-    BaseTrieSection * const section; // section related to the context.
-    int               accId;      // Accumulator ID. If negative - no accumulation need to be made.
-    QString           accStr;     // Accumulated String.
+    LineRanges        prevParseResults;
+    BaseTrieSection * section = nullptr; // section related to the context.
+    int               accId = -1; // Accumulator ID. If negative - no accumulation need to be made.
+    int               accLen = 0; // Number of processed chars. Accumulated data is the range that ends at current char.
     TrieContext       sectionContext;
 };
 
@@ -119,23 +164,45 @@ public:
     TrieLineContext(const TrieLineContext&) = delete;
     TrieLineContext & operator=(const TrieLineContext&) = delete;
 
-    // Process char against whole context
-    void processChar( BaseTrieSection * headSection, QChar ch );
+    // Process char against whole context. pos - stream position of the char
+    void processChar( BaseTrieSection * headSection, QChar ch, qint64 pos );
+
+    // Process char for already started sections only. Head section is not tried.
+    void processActiveChar( QChar ch, qint64 pos );
+
+    // Head section was matched by front-end (see InputParser), continue with the next sections.
+    // Has the same effect as the head section that just returned DONE for the last symbol of the head
+    // with length headLen at position pos.
+    void startAfterHead( BaseTrieSection * headSection, int headLen, qint64 pos );
+
+    // Min stream position that is still referenced by sections in progress.
+    // pos - stream position of the last processed char
+    qint64 getMinPos(qint64 pos) const;
+
+    // true if some sections are in progress
+    bool isActive() const {return !contexts.isEmpty();}
+    bool hasSingleActiveContext() const {return isSingleActiveContext;}
 
     void reset(); // Reset whole context
 
     bool hasResults() const {return !readyResult.empty();}
-    const QVector<LineResult> & getReadyResult() const {return readyResult;}
-    // Clean up the result that we get from ready
-    void resetResults() {readyResult.clear();}
+    const QVector<LineRanges> & getReadyResult() const {return readyResult;}
+    // Clean up the result that we get from ready. Capacity is kept.
+    void resetResults() {readyResult.resize(0);}
 private:
     void releaseData();
-    void processContext(TrieSectionContext* context, bool done, bool startNext, QChar ch);
-    void startNewSectionAndProcess( BaseTrieSection * newSection, LineResult && prevResult, QChar ch );
+    void processContext(TrieSectionContext* context, bool done, bool startNext, QChar ch, qint64 pos);
+    void startNewSectionAndProcess( BaseTrieSection * newSection, const LineRanges & prevResult, QChar ch, qint64 pos );
+
+    // Section context pool. After warm up no allocations are expected.
+    TrieSectionContext * acquireContext(BaseTrieSection * section, const LineRanges & prevResult);
+    void releaseContext(TrieSectionContext * context);
 protected:
     bool isSingleActiveContext;
-    QVector< TrieSectionContext* > contexts; // owners those objects
-    QVector<LineResult> readyResult;
+    QVector< TrieSectionContext* > contexts; // running contexts, taken from the pool
+    QVector< TrieSectionContext* > pool;     // owners those objects
+    QVector< TrieSectionContext* > freeContexts; // not used contexts from the pool
+    QVector<LineRanges> readyResult;
 };
 
 
@@ -151,6 +218,7 @@ public:
     TrieLineParser & operator=(const TrieLineParser & other) = delete;
 
     int getParserId() const {return parserId;}
+    BaseTrieSection * getHeadSection() const {return sections.front();}
 
     // Adding section/line for parsing and pair them in chain
     TrieLineParser & addSection( BaseTrieSection* s );
@@ -158,7 +226,7 @@ public:
     // Non chain topology still need to be added
 
     // return true if TrieLineContext has some result;
-    bool process( QChar ch, TrieLineContext * context );
+    bool process( QChar ch, qint64 pos, TrieLineContext * context );
 private:
     // Put sections in line
     void connectLineSections( int lastAddIdx );
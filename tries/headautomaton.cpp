@@ -0,0 +1,134 @@
+// Copyright 2019 The MWC Developers
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "tries/headautomaton.h"
+#include <algorithm>
+
+namespace tries {
+
+HeadAutomaton::HeadAutomaton() {
+    clear();
+}
+
+// Drop all phrases and the state
+void HeadAutomaton::clear() {
+    phrases.clear();
+    phraseTags.clear();
+
+    std::fill( asciiClasses, asciiClasses + ASCII_SZ, 0 );
+    unicodeClasses.clear();
+    classNum = 1;
+
+    // Root only, everything is looping back to the root
+    delta = QVector<int>(classNum, 0);
+    outputs = QVector< QVector<int> >(1);
+    depth = QVector<int>(1, 0);
+    state = 0;
+}
+
+void HeadAutomaton::addPhrase(const QString & phrase, int tag) {
+    Q_ASSERT( !phrase.isEmpty() );
+    phrases.push_back(phrase);
+    phraseTags.push_back(tag);
+}
+
+int HeadAutomaton::getCharClass(QChar ch) const {
+    const ushort u = ch.unicode();
+    return u < ASCII_SZ ? asciiClasses[u] : unicodeClasses.value(u, 0);
+}
+
+// Compile the DFA
+void HeadAutomaton::build() {
+    std::fill( asciiClasses, asciiClasses + ASCII_SZ, 0 );
+    unicodeClasses.clear();
+    classNum = 1;
+
+    // Every symbol that is used by the phrases get its own class
+    for (const QString & ph : phrases) {
+        for (int i=0; i<ph.length(); i++) {
+            QChar ch = ph[i];
+            if (getCharClass(ch)!=0)
+                continue;
+
+            const ushort u = ch.unicode();
+            if (u < ASCII_SZ)
+                asciiClasses[u] = classNum;
+            else
+                unicodeClasses.insert(u, classNum);
+            classNum++;
+        }
+    }
+
+    // Building the trie. -1 - no transition yet
+    delta = QVector<int>(classNum, -1);
+    outputs = QVector< QVector<int> >(1);
+    depth = QVector<int>(1, 0);
+
+    for ( int p=0; p<phrases.size(); p++ ) {
+        const QString & ph = phrases[p];
+        int s = 0;
+        for (int i=0; i<ph.length(); i++) {
+            const int idx = s*classNum + getCharClass(ph[i]);
+            if (delta[idx]<0) {
+                delta[idx] = outputs.size();
+                outputs.push_back( QVector<int>() );
+                depth.push_back( i+1 );
+                delta.resize( delta.size() + classNum );
+                std::fill( delta.begin() + delta.size() - classNum, delta.end(), -1 );
+            }
+            s = delta[idx];
+        }
+        outputs[s].push_back( phraseTags[p] );
+    }
+
+    // Breadth first walk to calculate the fail links and resolve them into DFA transitions.
+    const int statesNum = outputs.size();
+    QVector<int> fail(statesNum, 0);
+    QVector<int> queue;
+    queue.reserve(statesNum);
+
+    for (int c=0; c<classNum; c++) {
+        int & nx = delta[c];
+        if (nx<0)
+            nx = 0;
+        else
+            queue.push_back(nx);
+    }
+
+    for ( int qi=0; qi<queue.size(); qi++ ) {
+        const int s = queue[qi];
+        const int f = fail[s];
+
+        // f is shallower, so its outputs are already merged
+        if (!outputs[f].isEmpty()) {
+            outputs[s].append( outputs[f] );
+            std::sort( outputs[s].begin(), outputs[s].end() );
+        }
+
+        for (int c=0; c<classNum; c++) {
+            int & nx = delta[s*classNum + c];
+            if (nx<0) {
+                nx = delta[f*classNum + c];
+            }
+            else {
+                fail[nx] = delta[f*classNum + c];
+                queue.push_back(nx);
+            }
+        }
+    }
+
+    state = 0;
+}
+
+}
@@ -0,0 +1,84 @@
+// Copyright 2019 The MWC Developers
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef HEADAUTOMATON_H
+#define HEADAUTOMATON_H
+
+#include <QString>
+#include <QVector>
+#include <QHash>
+
+namespace tries {
+
+// Aho-Corasick automaton that match all fixed phrase heads in a single pass.
+// It is compiled into the DFA, so every symbol cost a single table lookup.
+// Symbols that are not used by any phrase share the same class and always drop
+// the automaton into the root state.
+class HeadAutomaton {
+public:
+    HeadAutomaton();
+
+    HeadAutomaton(const HeadAutomaton&) = delete;
+    HeadAutomaton & operator=(const HeadAutomaton&) = delete;
+
+    // Drop all phrases and the state
+    void clear();
+
+    // Register the phrase. tag will be reported back when phrase is matched.
+    // build() must be called after all phrases are added
+    void addPhrase(const QString & phrase, int tag);
+
+    // Compile the DFA
+    void build();
+
+    bool isEmpty() const {return phrases.isEmpty();}
+
+    // Reset the matching state, history will be forgotten
+    void resetState() {state = 0;}
+
+    // Length of the phrase prefix that is matched by current state
+    int getStateDepth() const {return depth[state];}
+
+    // Feed next symbol. Return tags (sorted ascending) of the phrases that end at this symbol.
+    const QVector<int> & processChar(QChar ch) {
+        const ushort u = ch.unicode();
+        const int cls = u < ASCII_SZ ? asciiClasses[u] : unicodeClasses.value(u, 0);
+        state = delta[state*classNum + cls];
+        return outputs[state];
+    }
+
+private:
+    int getCharClass(QChar ch) const;
+
+private:
+    enum { ASCII_SZ = 128 };
+
+    // Input data
+    QVector<QString> phrases;
+    QVector<int>     phraseTags;
+
+    // Compiled data
+    int asciiClasses[ASCII_SZ];
+    QHash<ushort,int> unicodeClasses;
+    int classNum = 1;               // Class 0 is reserved for the symbols that are not in any phrase
+    QVector<int> delta;             // state transitions, [state*classNum + class]
+    QVector< QVector<int> > outputs; // tags of the phrases that end at the state
+    QVector<int> depth;             // length of the prefix for the state
+
+    int state = 0; // Current state, 0 is root
+};
+
+}
+
+#endif // HEADAUTOMATON_H
@@ -13,6 +13,7 @@
 // limitations under the License.
 
 #include "tries/inputparser.h"
+#include "tries/simpletriesection.h"
 
 namespace tries {
 
@@ -44,6 +45,7 @@ InputParser::~InputParser() {
 // parser must be on the heap and pnership will be transferred to this
 void InputParser::appendLineParser( TrieLineParser* parser, bool hasSingleActiveContext ) {
     lines.push_back( LineInfo( parser, new TrieLineContext(hasSingleActiveContext) ) );
+    compiled = false;
 }
 
 bool InputParser::deleteLineParser(int parserId) {
@@ -55,24 +57,98 @@ bool InputParser::deleteLineParser(int parserId) {
             lines.remove(t);
         }
     }
+    compiled = false;
     return lines.size() < sz;
 }
 
+// Merge all phrase heads into the single automaton
+void InputParser::compile() {
+    headAutomaton.clear();
+
+    for ( int t=0; t<lines.size(); t++ ) {
+        LineInfo & p = lines[t];
+        BaseTrieSection * head = p.parser->getHeadSection();
+        p.headType = head->getHeadType();
+
+        // Single active context need to know if there are running sections at the head start,
+        // automaton doesn't track that.
+        if (p.headType == BaseTrieSection::HEAD_PHRASE && p.context->hasSingleActiveContext())
+            p.headType = BaseTrieSection::HEAD_ANY;
+
+        if (p.headType == BaseTrieSection::HEAD_PHRASE) {
+            p.headLen = head->getHeadPhrase().length();
+            headAutomaton.addPhrase( head->getHeadPhrase(), t );
+        }
+    }
+
+    headAutomaton.build();
+    compiled = true;
+}
+
+// Convert stream ranges into the strings
+LineResult InputParser::materialize(const LineRanges & ranges) const {
+    LineResult res;
+    for (int i=0; i<ranges.size; i++) {
+        const SectionRange & r = ranges.ranges[i];
+        Q_ASSERT( r.start >= historyStart && r.start + r.len <= historyStart + history.length() );
+        res.AddResult( SectionResult( history.mid( int(r.start - historyStart), r.len ), r.dataId ) );
+    }
+    return res;
+}
+
 QVector<ParsingResult> InputParser::processInput(QString input) {
+    if (!compiled)
+        compile();
+
     // processing input symbol by symbol
     int len = input.length();
 
     QVector<ParsingResult> result;
 
+    // Stream position of the input first char
+    const qint64 inputStart = historyStart + history.length();
+    history.append(input);
+
     for ( int l=0; l<len; l++ ) {
         QChar ch = input[l];
+        const qint64 pos = inputStart + l;
+
+        // Lines which phrase head ends at this symbol. Sorted the same way as lines.
+        const QVector<int> & matchedHeads = headAutomaton.processChar(ch);
+        int matchedIdx = 0;
+        const bool newLine = isNewLine(ch);
+
+        for ( int t=0; t<lines.size(); t++ ) {
+            LineInfo & p = lines[t];
+
+            switch (p.headType) {
+                case BaseTrieSection::HEAD_PHRASE: {
+                    if (p.context->isActive())
+                        p.context->processActiveChar(ch, pos);
+
+                    if (matchedIdx < matchedHeads.size() && matchedHeads[matchedIdx] == t) {
+                        matchedIdx++;
+                        p.context->startAfterHead( p.parser->getHeadSection(), p.headLen, pos );
+                    }
+                    break;
+                }
+                case BaseTrieSection::HEAD_NEW_LINE: {
+                    // Head can't start, nothing to do
+                    if (!newLine && !p.context->isActive())
+                        continue;
+                    p.parser->process(ch, pos, p.context);
+                    break;
+                }
+                default:
+                    p.parser->process(ch, pos, p.context);
+                    break;
+            }
 
-        for ( LineInfo & p : lines ) {
-            if (p.parser->process(ch, p.context))
+            if (p.context->hasResults())
             { // get a result...
-                const QVector<LineResult> & res = p.context->getReadyResult();
+                const QVector<LineRanges> & res = p.context->getReadyResult();
                 for ( auto & r : res ) {
-                    result.push_back( ParsingResult(p.parser->getParserId(), r ) );
+                    result.push_back( ParsingResult(p.parser->getParserId(), materialize(r) ) );
                 }
                 p.context->resetResults();
 
@@ -81,6 +157,18 @@ QVector<ParsingResult> InputParser::processInput(QString input) {
             }
         }
     }
+
+    // Drop the history that is not referenced any more. Partially matched head still need its symbols.
+    const qint64 lastPos = inputStart + len - 1;
+    qint64 minPos = lastPos + 1 - headAutomaton.getStateDepth();
+    for ( const LineInfo & p : lines ) {
+        minPos = std::min( minPos, p.context->getMinPos(lastPos) );
+    }
+    if (minPos > historyStart) {
+        history.remove( 0, int(minPos - historyStart) );
+        historyStart = minPos;
+    }
+
     return result;
 }
 
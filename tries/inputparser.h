@@ -17,6 +17,7 @@
 
 #include <QVector>
 #include "baseparser.h"
+#include "headautomaton.h"
 #include <QDebug>
 
 namespace tries {
@@ -41,6 +42,9 @@ QDebug operator<<(QDebug dbg, const ParsingResult& res);
 struct LineInfo {
     TrieLineParser * const parser;
     TrieLineContext * const context;
+    // How the head section is handled by the front-end. Assigned by InputParser::compile()
+    BaseTrieSection::HEAD_TYPE headType = BaseTrieSection::HEAD_ANY;
+    int headLen = 0; // Length of the HEAD_PHRASE
 
     LineInfo(TrieLineParser * _parser, TrieLineContext * _context) : parser(_parser), context(_context) {}
     LineInfo() : parser(nullptr), context(nullptr) {}
@@ -66,8 +70,26 @@ public:
 
     QVector<ParsingResult> processInput(QString input);
 
+private:
+    // Merge all phrase heads into the single automaton. Called lazily on the first input after parsers was changed.
+    // Note: partially matched heads are dropped by recompile.
+    void compile();
+
+    // Convert stream ranges into the strings
+    LineResult materialize(const LineRanges & ranges) const;
+
 protected:
     QVector< LineInfo > lines;
+
+    // Tail of the input stream that is still referenced by sections in progress.
+    // Sections store their results as ranges in the stream, data is copied only for ready results.
+    QString history;
+    qint64  historyStart = 0; // stream position of the history first char
+
+    // Front-end that tracks the fixed phrase heads for all lines at once.
+    // Lines with phrase heads are activated only when their head is matched.
+    HeadAutomaton headAutomaton;
+    bool compiled = false;
 };
 
 }
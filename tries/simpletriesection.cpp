@@ -94,10 +94,6 @@ TrieAnySection::TrieAnySection(int _lenLimit, uint32_t _processMask,
 {
 }
 
-inline bool isNewLine(QChar ch) {
-    return ch==QChar::LineSeparator || ch==QChar::LineFeed || ch==QChar::CarriageReturn;
-}
-
 uint32_t TrieAnySection::processChar(TrieContext & context, QChar ch) {
     bool ok = false;
     if (processMask & PROCESS::NUMBERS)
@@ -19,6 +19,10 @@
 
 namespace tries {
 
+inline bool isNewLine(QChar ch) {
+    return ch==QChar::LineSeparator || ch==QChar::LineFeed || ch==QChar::CarriageReturn;
+}
+
 // Parsing the fixed phrase
 class TriePhraseSection : public BaseTrieSection {
 public:
@@ -26,6 +30,10 @@ public:
     TriePhraseSection(QString phrase, bool ignoreCase, int accumulateId=-1);
 
     virtual uint32_t processChar(TrieContext & context, QChar ch) override;
+
+    // Case insensitive phrases are not compiled into the front-end
+    virtual HEAD_TYPE getHeadType() const override {return ignoreCase ? HEAD_ANY : HEAD_PHRASE;}
+    virtual QString getHeadPhrase() const override {return phrase;}
 protected:
     QString phrase;
     bool ignoreCase = false;
@@ -45,6 +53,7 @@ class TrieNewLineSection : public BaseTrieSection {
 public:
     TrieNewLineSection();
     virtual uint32_t processChar(TrieContext & context, QChar ch) override;
+    virtual HEAD_TYPE getHeadType() const override {return HEAD_NEW_LINE;}
 };
 
 // Anything that match the set of letters
@@ -17,6 +17,8 @@
 #include <QDir>
 #include <QDataStream>
 #include <QCoreApplication>
+#include <QtEndian>
+#include <QVector>
 
 namespace compress {
 
@@ -200,4 +202,75 @@ QPair<bool, QString> decompressFolder(QString sourceFile, QString destinationFol
     return QPair<bool, QString>( true,"");
 }
 
-}
\ No newline at end of file
+// gzip data is processed by chunks of this size
+const int GZIP_CHUNK_SIZE = 1024*1024;
+
+static quint32 crc32(quint32 crc, const QByteArray & data) {
+    static const QVector<quint32> table = []() {
+        QVector<quint32> t(256);
+        for (quint32 n=0; n<256; n++) {
+            quint32 c = n;
+            for (int k=0; k<8; k++)
+                c = (c & 1) ? 0xEDB88320U ^ (c >> 1) : c >> 1;
+            t[int(n)] = c;
+        }
+        return t;
+    }();
+
+    crc = ~crc;
+    for (char ch : data)
+        crc = table[int((crc ^ quint8(ch)) & 0xFF)] ^ (crc >> 8);
+    return ~crc;
+}
+
+// return: <success, Error Message>
+QPair<bool, QString> gzipFile(QString sourceFile, QString destinationFile, QVector<qint64> * memberOffsets) {
+    QFile src(sourceFile);
+    if (!src.open(QIODevice::ReadOnly))
+        return QPair<bool, QString>(false, "Unable to open file " + sourceFile);
+
+    QFile dst(destinationFile);
+    if (!dst.open(QIODevice::WriteOnly))
+        return QPair<bool, QString>(false, "Unable to create archive file " + destinationFile);
+
+    // Member header: magic, deflate, no flags, no mtime, unknown OS
+    static const char header[10] = {'\x1f', '\x8b', 8, 0, 0, 0, 0, 0, 0, '\xff'};
+
+    bool first = true;
+    while (first || !src.atEnd()) {
+        first = false;
+        QByteArray chunk = src.read(GZIP_CHUNK_SIZE);
+        if (chunk.isEmpty() && src.error() != QFileDevice::NoError)
+            return QPair<bool, QString>(false, "Unable to read file " + sourceFile);
+
+        // qCompress: 4 bytes size, 2 bytes zlib header, raw deflate, 4 bytes adler32. Need only deflate
+        QByteArray deflate;
+        if (chunk.isEmpty()) {
+            deflate = QByteArray("\x03\x00", 2); // empty final block
+        }
+        else {
+            QByteArray zlib = qCompress(chunk, 6);
+            if (zlib.size() < 10)
+                return QPair<bool, QString>(false, "Unable to compress file " + sourceFile);
+            deflate = zlib.mid(6, zlib.size() - 10);
+        }
+
+        uchar trailer[8];
+        qToLittleEndian<quint32>(crc32(0, chunk), trailer);
+        qToLittleEndian<quint32>(quint32(chunk.size()), trailer + 4);
+
+        if (memberOffsets)
+            memberOffsets->push_back(dst.pos());
+
+        if ( dst.write(header, sizeof(header)) != sizeof(header) ||
+             dst.write(deflate) != deflate.size() ||
+             dst.write(reinterpret_cast<const char *>(trailer), sizeof(trailer)) != sizeof(trailer) )
+            return QPair<bool, QString>(false, "Unable to write archive file " + destinationFile);
+    }
+
+    if (!dst.flush())
+        return QPair<bool, QString>(false, "Unable to write archive file " + destinationFile);
+    return QPair<bool, QString>(true, "");
+}
+
+}
@@ -17,6 +17,7 @@
 #define MWC_QT_WALLET_FOLDERCOMPRESSOR_H
 
 #include <QPair>
+#include <QVector>
 
 namespace compress {
 
@@ -34,6 +35,12 @@ QPair<bool, QString> compressFolder(QString sourceFolder, QString destinationFil
 // return: <success, Error Message>
 QPair<bool, QString> decompressFolder(QString sourceFile, QString destinationFolder, const QString & archiveTag, bool callProcessEvents = true);
 
+// Compress the file into gzip format. Data is processed by chunks, so memory usage doesn't depend on the file size.
+// Every chunk is a gzip member, any gzip tool can read it. Safe to call from any thread.
+// memberOffsets - optional, gets the offset of every member in the destination file
+// return: <success, Error Message>
+QPair<bool, QString> gzipFile(QString sourceFile, QString destinationFile, QVector<qint64> * memberOffsets = nullptr);
+
 
 }
 
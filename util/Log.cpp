@@ -19,15 +19,33 @@
 #include <QApplication>
 #include <QDateTime>
 #include "../wallet/mwc713task.h"
-#include <QProcess>
-#include "../core/Config.h"
+#include <QThread>
+#include <QMutexLocker>
+#include <QAtomicInt>
+#include <QElapsedTimer>
 #include "../core/WndManager.h"
+#include "../core/Notification.h"
+#include "FolderCompressor.h"
+#include <algorithm>
 
 // 10 MB is a reasonable size limit.
 // Compressed will be around 1 MB.
 #define LOG_SIZE_LIMIT  10000000
 // Number of files for rotation
 #define LOG_FILES_POOL_SIZE 50
+// Rotated but not compressed yet files: yyyy_MM_dd_hh_mm_ss_zzz.<file name>
+#define ROTATED_LOG_PATTERNS QStringList{"????_??_??_??_??_??_???*.log", "????_??_??_??_??_??_???*.jsonl"}
+
+// Lines that can wait for the writer. Extra lines are dropped and counted.
+#define LOG_QUEUE_SIZE      65536
+// Writer is woken up early if that many lines are waiting
+#define LOG_WAKE_BACKLOG    4096
+// Batch is written when it is that big or the queue is empty
+#define LOG_BATCH_BYTES     (256*1024)
+// Idle writer checks the queue with this period, also max time between flushes
+#define LOG_FLUSH_PERIOD_MS 200
+// Line that keeps repeating is reported with this period
+#define LOG_FOLD_REPORT_USECS (30LL*1000000)
 
 
 namespace logger {
@@ -35,12 +53,88 @@ namespace logger {
 static LogSender *   logClient = nullptr;
 static LogReceiver * logServer = nullptr;
 
-static bool logMwc713outBlocked = false;
+static QAtomicInt logMwc713outBlocked(0); // mwc713 output is logged from the reader thread
 
 const QString LOG_FILE_NAME = "mwcwallet.log";
+const QString EVENTS_FILE_NAME = "mwcwallet.events.jsonl";
+
+QString toString(LOG_CATEGORY category) {
+    switch (category) {
+        case LOG_CATEGORY::MWC713_OUT: return "mwc713_out";
+        case LOG_CATEGORY::MWC713_IN:  return "mwc713_in";
+        case LOG_CATEGORY::NODE_OUT:   return "node_out";
+        case LOG_CATEGORY::PARSING:    return "parsing";
+        case LOG_CATEGORY::TASKS:      return "tasks";
+        default: Q_ASSERT(false); return "unknown";
+    }
+}
+
+static LogBudget defaultBudget(LOG_CATEGORY category) {
+    LogBudget budget;
+    budget.burstSecs = 30.0;
+    switch (category) {
+        // Burst covers the outputs and transactions listings of the large wallets
+        case LOG_CATEGORY::MWC713_OUT: budget.linesPerSec = 100.0; budget.bytesPerSec = 32*1024; break;
+        case LOG_CATEGORY::MWC713_IN:  budget.linesPerSec = 20.0;  budget.bytesPerSec = 8*1024;  break;
+        // Syncing node prints all the time, a few lines per second is enough to see the progress
+        case LOG_CATEGORY::NODE_OUT:   budget.linesPerSec = 10.0;  budget.bytesPerSec = 4*1024;  break;
+        case LOG_CATEGORY::PARSING:    budget.linesPerSec = 100.0; budget.bytesPerSec = 32*1024; break;
+        case LOG_CATEGORY::TASKS:      budget.linesPerSec = 50.0;  budget.bytesPerSec = 16*1024; break;
+        default: Q_ASSERT(false); break;
+    }
+    return budget;
+}
+
+static LogLimiter * getLimiters() {
+    static LogLimiter limiters[int(LOG_CATEGORY::COUNT)];
+    static bool initialized = []() {
+        for (int i=0; i<int(LOG_CATEGORY::COUNT); i++)
+            limiters[i].setBudget( defaultBudget(LOG_CATEGORY(i)), eventlog::monotonicUsecs() );
+        return true;
+    }();
+    Q_UNUSED(initialized);
+    return limiters;
+}
+
+void setLogBudget(LOG_CATEGORY category, const LogBudget & budget) {
+    getLimiters()[int(category)].setBudget(budget, eventlog::monotonicUsecs());
+}
+
+LogBudget getLogBudget(LOG_CATEGORY category) {
+    return getLimiters()[int(category)].getBudget();
+}
+
+static void writeLimiterNotes(LOG_CATEGORY category, const QVector<QString> & notes) {
+    for (const QString & note : notes)
+        logClient->doAppend2logs(true, "Logger(" + toString(category) + ")", note);
+}
+
+// Write pending repeats and skipped lines notes, logs are going to be closed or flushed
+static void finishLimiters() {
+    if (logClient == nullptr)
+        return;
+    for (int i=0; i<int(LOG_CATEGORY::COUNT); i++) {
+        QVector<QString> notes;
+        getLimiters()[i].finish(notes);
+        writeLimiterNotes(LOG_CATEGORY(i), notes);
+    }
+}
+
+// Budget and folding are for the text log only, the structured events are always written.
+// Return true if the line is written
+static bool logLimited(LOG_CATEGORY category, const QString & prefix, const QString & line) {
+    if (logServer == nullptr)
+        return false;
+    const QString notePrefix = "Logger(" + toString(category) + ")";
+    return getLimiters()[int(category)].admitAndWrite(line, eventlog::monotonicUsecs(),
+            [&](const QString & text, bool note) {
+                logClient->doAppend2logs(true, note ? notePrefix : prefix, text);
+            });
+}
 
 void initLogger( bool logsEnabled) {
     logClient = new LogSender(true);
+    eventlog::monotonicUsecs(); // events time is counted from here
 
     enableLogs(logsEnabled);
 
@@ -56,8 +150,10 @@ void cleanUpLogs() {
         return;
     }
 
-    QFile::remove(logPath.second + "/" + LOG_FILE_NAME);
-    QFile::remove(logPath.second + "/prev_" + LOG_FILE_NAME);
+    for (const QString & fn : {LOG_FILE_NAME, EVENTS_FILE_NAME}) {
+        QFile::remove(logPath.second + "/" + fn);
+        QFile::remove(logPath.second + "/prev_" + fn);
+    }
 }
 
 // enable/disable logs
@@ -73,11 +169,178 @@ void enableLogs( bool enableLogs ) {
         if (logServer == nullptr)
             return;
 
+        finishLimiters();
         delete logServer;
         logServer = nullptr;
     }
 }
 
+// Check if logs are enabled
+bool isLogsEnabled() {
+    return logServer != nullptr;
+}
+
+void flushLogs() {
+    if (logServer) {
+        finishLimiters();
+        logServer->flush();
+    }
+}
+
+LogStats getLogStats() {
+    if (logServer == nullptr)
+        return LogStats();
+
+    LogStats res = logServer->getStats();
+    for (int i=0; i<int(LOG_CATEGORY::COUNT); i++) {
+        res.categories.push_back( getLimiters()[i].getStats() );
+        res.categories.back().name = toString(LOG_CATEGORY(i));
+    }
+    return res;
+}
+
+// static
+QPair<bool,QString> LogBudget::fromString(const QString & str, LogBudget & budget) {
+    const QStringList parts = str.split(',');
+    if (parts.size() != 3)
+        return QPair<bool,QString>(false, "Expected '<lines per second>,<KB per second>,<burst seconds>', get '" + str + "'");
+
+    bool okLines = false, okKb = false, okBurst = false;
+    const double lines = parts[0].trimmed().toDouble(&okLines);
+    const double kb = parts[1].trimmed().toDouble(&okKb);
+    const double burst = parts[2].trimmed().toDouble(&okBurst);
+    if (!okLines || !okKb || !okBurst || lines < 0.0 || kb < 0.0 || burst <= 0.0)
+        return QPair<bool,QString>(false, "Invalid log budget value '" + str + "'");
+
+    budget.linesPerSec = lines;
+    budget.bytesPerSec = kb * 1024.0;
+    budget.burstSecs = burst;
+    return QPair<bool,QString>(true, "");
+}
+
+void LogLimiter::setBudget(const LogBudget & _budget, qint64 nowUsecs) {
+    QMutexLocker l(&mutex);
+    budget = _budget;
+    // Starting with the full bucket, the start up is the most interesting part of the logs
+    lineTokens = budget.linesPerSec * budget.burstSecs;
+    byteTokens = budget.bytesPerSec * budget.burstSecs;
+    refillTime = nowUsecs;
+}
+
+LogBudget LogLimiter::getBudget() const {
+    QMutexLocker l(&mutex);
+    return budget;
+}
+
+LogCategoryStats LogLimiter::getStats() const {
+    QMutexLocker l(&mutex);
+    return stats;
+}
+
+bool LogLimiter::admit(const QString & line, qint64 nowUsecs, QVector<QString> & notes) {
+    QMutexLocker l(&mutex);
+    return admitLocked(line, nowUsecs, notes);
+}
+
+bool LogLimiter::admitAndWrite(const QString & line, qint64 nowUsecs, const std::function<void(const QString & text, bool note)> & write) {
+    QMutexLocker l(&mutex);
+    QVector<QString> notes;
+    const bool admitted = admitLocked(line, nowUsecs, notes);
+    for (const QString & note : notes)
+        write(note, true);
+    if (admitted)
+        write(line, false);
+    return admitted;
+}
+
+bool LogLimiter::admitLocked(const QString & line, qint64 nowUsecs, QVector<QString> & notes) {
+    stats.lines++;
+    refill(nowUsecs);
+
+    if (budget.foldRepeats && repeatsStart >= 0 && line == lastLine) {
+        repeats++;
+        stats.foldedLines++;
+        if (nowUsecs - repeatsStart >= LOG_FOLD_REPORT_USECS) {
+            flushRepeats(notes);
+            repeatsStart = nowUsecs;
+        }
+        return false;
+    }
+
+    flushRepeats(notes);
+
+    const int bytes = line.size();
+    const bool admitted = takeTokens(bytes);
+    if (budget.foldRepeats) {
+        lastLine = line;
+        lastLineWritten = admitted;
+        repeatsStart = nowUsecs;
+    }
+
+    if (!admitted) {
+        pendingLines++;
+        pendingBytes += bytes;
+        stats.suppressedLines++;
+        stats.suppressedBytes += bytes;
+        return false;
+    }
+
+    flushSuppressed(notes);
+    return true;
+}
+
+void LogLimiter::finish(QVector<QString> & notes) {
+    QMutexLocker l(&mutex);
+    flushRepeats(notes);
+    flushSuppressed(notes);
+}
+
+void LogLimiter::refill(qint64 nowUsecs) {
+    if (nowUsecs <= refillTime)
+        return;
+    const double secs = double(nowUsecs - refillTime) / 1000000.0;
+    refillTime = nowUsecs;
+    lineTokens = std::min( lineTokens + secs * budget.linesPerSec, budget.linesPerSec * budget.burstSecs );
+    byteTokens = std::min( byteTokens + secs * budget.bytesPerSec, budget.bytesPerSec * budget.burstSecs );
+}
+
+// Bytes can go into debt, otherwise a line longer than the bucket would never pass
+bool LogLimiter::takeTokens(int bytes) {
+    const bool limitLines = budget.linesPerSec > 0.0;
+    const bool limitBytes = budget.bytesPerSec > 0.0;
+    if ( (limitLines && lineTokens < 1.0) || (limitBytes && byteTokens < 0.0) )
+        return false;
+    if (limitLines)
+        lineTokens -= 1.0;
+    if (limitBytes)
+        byteTokens -= bytes;
+    return true;
+}
+
+void LogLimiter::flushRepeats(QVector<QString> & notes) {
+    if (repeats == 0)
+        return;
+    const QString note = "last line repeated " + QString::number(repeats) + " times";
+    if (lastLineWritten && takeTokens(note.size())) {
+        notes.push_back(note);
+    }
+    else {
+        // Repeats of the skipped line, or no budget for the note. Reporting them as skipped.
+        pendingLines += repeats;
+        pendingBytes += repeats * lastLine.size();
+    }
+    repeats = 0;
+}
+
+void LogLimiter::flushSuppressed(QVector<QString> & notes) {
+    if (pendingLines == 0)
+        return;
+    notes.push_back( QString::number(pendingLines) + " lines (" + QString::number((pendingBytes + 1023) / 1024) +
+                     " KB) were skipped, log budget is exceeded" );
+    pendingLines = 0;
+    pendingBytes = 0;
+}
+
 
 void LogSender::log(bool addDate, const QString & prefix, const QString & line) {
     if (asyncLogging) {
@@ -88,10 +351,101 @@ void LogSender::log(bool addDate, const QString & prefix, const QString & line)
     }
 }
 
+// Compress rotated files in background, logging is not waiting for that.
+// Also keeps the archives pool size, the oldest files are deleted.
+class LogArchiver : public QThread {
+public:
+    LogArchiver(LogReceiver * _receiver, const QString & _logPath) : receiver(_receiver), logPath(_logPath) {}
+
+    // Any thread
+    void addFile(const QString & fileName) {
+        QMutexLocker l(&mutex);
+        files.push_back(fileName);
+        cond.wakeAll();
+    }
+    void stop() {
+        QMutexLocker l(&mutex);
+        stopped = true;
+        cond.wakeAll();
+    }
+
+protected:
+    virtual void run() override {
+        while (true) {
+            QString fileName;
+            {
+                QMutexLocker l(&mutex);
+                while (!stopped && files.isEmpty())
+                    cond.wait(&mutex);
+                if (stopped)
+                    return;
+                fileName = files.takeFirst();
+            }
+            archive(fileName);
+            cleanUpPool();
+        }
+    }
+
+private:
+    void archive(const QString & fileName) {
+        const QString srcFileName = logPath + "/" + fileName;
+        const QString resultFileName = srcFileName + ".gz";
+        const QString tmpFileName = resultFileName + ".tmp";
+
+        qDebug() << "Creating log archive: " << resultFileName;
+        QPair<bool, QString> res = compress::gzipFile(srcFileName, tmpFileName);
+        if (res.first) {
+            QFile::remove(resultFileName);
+            if (!QFile::rename(tmpFileName, resultFileName))
+                res = QPair<bool, QString>(false, "Unable to create archive file " + resultFileName);
+        }
+
+        if (res.first) {
+            QFile::remove(srcFileName);
+        }
+        else {
+            // Rotated file stays, the pool limit will take care about it
+            QFile::remove(tmpFileName);
+            receiver->reportProblem("Unable to compress the log file " + srcFileName + ". " + res.second);
+        }
+    }
+
+    void cleanUpPool() {
+        // Names are timestamps, sorting by name gives the oldest first
+        QStringList archives = QDir(logPath).entryList( QStringList{"*.zip", "*.gz"} + ROTATED_LOG_PATTERNS, QDir::Files, QDir::Name );
+        while (archives.size() > LOG_FILES_POOL_SIZE) {
+            qDebug() << "Cleaning up old archive: " << archives.front();
+            QFile::remove(logPath + "/" + archives.front());
+            archives.pop_front();
+        }
+    }
+
+private:
+    LogReceiver * receiver;
+    const QString logPath;
+
+    QMutex mutex;
+    QWaitCondition cond;
+    QStringList files;
+    bool stopped = false;
+};
+
+class LogWriterThread : public QThread {
+public:
+    LogWriterThread(LogReceiver * _receiver) : receiver(_receiver) {}
+protected:
+    virtual void run() override { receiver->writeLoop(); }
+private:
+    LogReceiver * receiver;
+};
+
 // Create logger file with some simplest rotation
 LogReceiver::LogReceiver(const QString & filename) :
-        logFileName(filename)
+        queue(LOG_QUEUE_SIZE)
 {
+    textLog.fileName = filename;
+    eventLog.fileName = EVENTS_FILE_NAME;
+
     QPair<bool,QString> path = ioutils::getAppDataPath("logs");
     if (!path.first) {
         core::getWndManager()->messageTextDlg("Error", path.second);
@@ -101,104 +455,254 @@ LogReceiver::LogReceiver(const QString & filename) :
 
     logPath = path.second;
 
-    rotateLogFileIfNeeded();
-    openLogFile();
+    archiver = new LogArchiver(this, logPath);
+    // Files that was rotated but not compressed during the last run
+    for (const QString & fn : QDir(logPath).entryList( ROTATED_LOG_PATTERNS, QDir::Files, QDir::Name ))
+        archiver->addFile(fn);
+    archiver->start(QThread::LowestPriority);
+
+    for (OutFile * out : {&textLog, &eventLog}) {
+        rotateFileIfNeeded(*out);
+        openFile(*out);
+    }
+
+    writer = new LogWriterThread(this);
+    writer->start(QThread::LowPriority);
 }
 
 LogReceiver::~LogReceiver() {
-    delete logFile;
+    if (writer) {
+        stopRequested.store(true);
+        wakeWriter.wakeAll();
+        writer->wait(); // writer drains the queue before exit
+        delete writer;
+    }
+    if (archiver) {
+        // Current file is finished, the rest will be compressed at the next start
+        archiver->stop();
+        archiver->wait();
+        delete archiver;
+    }
+    delete textLog.file;
+    delete eventLog.file;
 }
 
-void LogReceiver::rotateLogFileIfNeeded() {
-    QString logPathName = logPath + "/" + logFileName;
-    QFileInfo fi(logPathName);
-
-    if (fi.size() < LOG_SIZE_LIMIT)
-        return;
+// Any thread
+void LogReceiver::reportProblem(const QString & message) {
+    qDebug() << message;
+    QMetaObject::invokeMethod(this, "onLogProblem", Qt::QueuedConnection, Q_ARG(QString, message));
+}
 
-    qDebug() << "Rotating logs file: " << logPathName;
+void LogReceiver::onLogProblem(QString message) {
+    notify::appendNotificationMessage(notify::MESSAGE_LEVEL::WARNING, message);
+}
 
-    // First check if need to clean up
-    QStringList archives = QDir(logPath).entryList( {"*.zip"} );
-    if (archives.size()>LOG_FILES_POOL_SIZE) {
-        // Need to delete some. Since names can be sorted,
-        archives.sort(Qt::CaseSensitivity::CaseInsensitive);
-        while(archives.size()>LOG_FILES_POOL_SIZE) {
-            qDebug() << "Cleaning up old archive: " << archives.front();
-            QFile::remove(logPath + "/" + archives.front());
-            archives.pop_front();
-        }
-    }
+void LogReceiver::flush() {
+    if (writer==nullptr || QThread::currentThread() == writer)
+        return;
 
-    bool logFileOpen = (logFile != nullptr);
-    if (logFile) {
-        delete logFile;
-        logFile = nullptr;
-    }
+    QMutexLocker l( &wakeMutex );
+    const int counter = flushCounter;
+    flushRequested++;
+    wakeWriter.wakeAll();
+    // Time limit, we don't want to hang if the disk is gone
+    QElapsedTimer timer;
+    timer.start();
+    while (flushCounter == counter && timer.elapsed() < 3000)
+        flushDone.wait( &wakeMutex, 100 );
+}
 
-    // Generate the file name
-    QDateTime  now = QDateTime::currentDateTime();
-    QString archiveFileName = now.toString("yyyy_MM_dd_hh_mm_ss_zzz")+".zip";
+LogStats LogReceiver::getStats() const {
+    LogStats res;
+    res.writtenLines = writtenLines.load();
+    res.droppedLines = droppedLines.load();
+    res.backlog = int(queue.size());
+    return res;
+}
 
-    QString srcFileName = logPath + "/" + logFileName;
-    QString resultFileName = logPath + "/" + archiveFileName;
+void LogReceiver::rotateFileIfNeeded(OutFile & out) {
+    QString logPathName = logPath + "/" + out.fileName;
+    QFileInfo fi(logPathName);
 
-    // Find the mwczip location. It is expected ta the same directory where mwc713 located
+    if (fi.size() < LOG_SIZE_LIMIT)
+        return;
 
-    qDebug() << "Creating zip archive: " << resultFileName;
+    qDebug() << "Rotating logs file: " << logPathName;
 
-    // 3 is OK for the
-    int exitCode = QProcess::execute(config::getMwcZipPath(), {srcFileName, resultFileName});
+    bool logFileOpen = (out.file != nullptr);
+    if (out.file) {
+        delete out.file;
+        out.file = nullptr;
+    }
 
-    qDebug() << "mwczip exit code: " << exitCode;
+    // Rename is atomic, the log is continued in the new file right away. Compression is done by archiver.
     QDir logDir( logPath );
-
-    if (exitCode!=3) {
-        core::getWndManager()->messageTextDlg("Log files rotation", "Unable to rotate log file at "+ logPath +"\nYour previous file will be swapped with a new log data.");
-        const QString prevLogFn = "prev_"+logFileName;
-        logDir.remove(prevLogFn);
-        logDir.rename(logFileName, prevLogFn);
+    QString rotatedFileName = QDateTime::currentDateTime().toString("yyyy_MM_dd_hh_mm_ss_zzz") + "." + out.fileName;
+    if (logDir.rename(out.fileName, rotatedFileName)) {
+        archiver->addFile(rotatedFileName);
     }
     else {
-        logDir.remove(logFileName);
+        reportProblem("Unable to rotate log file at "+ logPath +"\nYour previous file will be swapped with a new log data.");
+        const QString prevLogFn = "prev_"+out.fileName;
+        logDir.remove(prevLogFn);
+        logDir.rename(out.fileName, prevLogFn);
     }
 
     if (logFileOpen)
-        openLogFile();
+        openFile(out);
 }
 
-void LogReceiver::openLogFile() {
-    QString logFn = logPath + "/" + logFileName;
-    logFile = new QFile(logFn);
-    if (!logFile->open(QFile::WriteOnly | QFile::Append)) {
-        core::getWndManager()->messageTextDlg("Critical Error", "Unable to open the logger file: " + logPath);
+void LogReceiver::openFile(OutFile & out) {
+    QString logFn = logPath + "/" + out.fileName;
+    out.file = new QFile(logFn);
+    if (!out.file->open(QFile::WriteOnly | QFile::Append)) {
+        // Writer can't show the dialogs, it is not UI thread
+        if (QThread::currentThread() != QCoreApplication::instance()->thread()) {
+            reportProblem("Unable to open the logger file: " + logFn);
+            return;
+        }
+        core::getWndManager()->messageTextDlg("Critical Error", "Unable to open the logger file: " + logFn);
         QApplication::quit();
         return;
     }
+    out.size = out.file->size();
 }
 
 
 void LogReceiver::onAppend2logs(bool addDate, QString prefix, QString line ) {
-    counter++;
-    if (counter>10000) {
-        rotateLogFileIfNeeded();
+    // Direct connection, can be called from several threads. Only queueing here, no locks and no IO.
+    LogLine ln;
+    ln.time = addDate ? QDateTime::currentMSecsSinceEpoch() : -1;
+    ln.prefix = prefix;
+    ln.line = line;
+    push(std::move(ln));
+}
+
+void LogReceiver::appendEvent(const QByteArray & jsonLine) {
+    LogLine ln;
+    ln.event = jsonLine;
+    push(std::move(ln));
+}
+
+void LogReceiver::push(LogLine && ln) {
+    if (!queue.push(std::move(ln))) {
+        droppedLines++;
+        return;
     }
+    if (queue.size() == LOG_WAKE_BACKLOG)
+        wakeWriter.wakeOne();
+}
+
+// Writer thread
+void LogReceiver::writeLoop() {
+    QByteArray batch;
+    batch.reserve(LOG_BATCH_BYTES + 4096);
+    QByteArray eventsBatch;
+    QElapsedTimer sinceFlush;
+    sinceFlush.start();
+    bool unflushed = false;
+
+    while (true) {
+        // Flush request is taken before the draining. Lines that was logged before the request are
+        // in the queue already, so they are written before flushDone.
+        const int flushReq = flushRequested.load();
+
+        LogLine ln;
+        while (batch.size() + eventsBatch.size() < LOG_BATCH_BYTES && queue.pop(ln)) {
+            if (ln.event.isEmpty()) {
+                formatLine(ln, batch);
+            }
+            else {
+                eventsBatch += ln.event;
+                eventsBatch += '\n';
+            }
+        }
+
+        const qint64 dropped = droppedLines.load();
+        if (dropped != reportedDropped) {
+            LogLine note;
+            note.time = QDateTime::currentMSecsSinceEpoch();
+            note.prefix = "Logger";
+            note.line = QString::number(dropped - reportedDropped) + " lines were dropped, logging queue is full";
+            formatLine(note, batch);
+            reportedDropped = dropped;
+        }
+
+        if (!batch.isEmpty() || !eventsBatch.isEmpty()) {
+            writeBatch(textLog, batch);
+            writeBatch(eventLog, eventsBatch);
+            unflushed = true;
+            if (queue.size() > 0)
+                continue; // Still have data, continue with the next batch
+        }
+
+        if ( unflushed && (flushReq > 0 || sinceFlush.elapsed() >= LOG_FLUSH_PERIOD_MS) ) {
+            for (OutFile * out : {&textLog, &eventLog}) {
+                if (out->file)
+                    out->file->flush();
+            }
+            unflushed = false;
+            sinceFlush.restart();
+        }
 
+        if (flushReq > 0) {
+            QMutexLocker l( &wakeMutex );
+            flushRequested -= flushReq;
+            flushCounter++;
+            flushDone.wakeAll();
+        }
 
-    QString logLine;
-    if (addDate)
-        logLine += QDateTime::currentDateTime().toString("dd.MM.yyyy hh:mm:ss.zzz") + " ";
+        if (stopRequested.load() && queue.size() == 0) {
+            for (OutFile * out : {&textLog, &eventLog}) {
+                if (out->file)
+                    out->file->flush();
+            }
+            return;
+        }
 
-    logLine += prefix + " " + line + "\n";
+        QMutexLocker l( &wakeMutex );
+        if (queue.size() == 0 && flushRequested.load() == 0 && !stopRequested.load())
+            wakeWriter.wait( &wakeMutex, LOG_FLUSH_PERIOD_MS );
+    }
+}
 
-    logFile->write( logLine.toUtf8() );
-    logFile->flush();
+void LogReceiver::formatLine(const LogLine & ln, QByteArray & batch) {
+    if (ln.time >= 0) {
+        // Formatting of the date is expensive, the second part is cached
+        const qint64 secs = ln.time / 1000;
+        if (secs != timeSecs) {
+            timeSecs = secs;
+            timeStr = QDateTime::fromMSecsSinceEpoch(secs * 1000).toString("dd.MM.yyyy hh:mm:ss.").toLatin1();
+        }
+        batch += timeStr;
+        batch += QByteArray::number(ln.time % 1000 + 1000).mid(1); // zero padded msecs
+        batch += ' ';
+    }
+    batch += ln.prefix.toUtf8();
+    batch += ' ';
+    batch += ln.line.toUtf8();
+    batch += '\n';
+    writtenLines++;
+}
+
+void LogReceiver::writeBatch(OutFile & out, QByteArray & batch) {
+    if (batch.isEmpty())
+        return;
+    if (out.file) {
+        out.file->write(batch);
+        out.size += batch.size();
+        if (out.size >= LOG_SIZE_LIMIT) {
+            out.file->flush();
+            rotateFileIfNeeded(out);
+        }
+    }
+    batch.resize(0);
 }
 
 // Global methods that do logging
 
 void blockLogMwc713out(bool blockOutput) {
-    logMwc713outBlocked = blockOutput;
+    logMwc713outBlocked.storeRelease( blockOutput ? 1 : 0 );
 }
 
 
@@ -206,20 +710,20 @@ void blockLogMwc713out(bool blockOutput) {
 void logMwc713out(QString str) {
     Q_ASSERT(logClient); // call initLogger first
 
-    if (logMwc713outBlocked) {
+    if (logMwc713outBlocked.loadAcquire()) {
         logClient->doAppend2logs(true, "mwc713>>", "CENSORED");
         return;
     }
 
     auto lns = str.split(QRegExp("[\r\n]"),QString::SkipEmptyParts);
     for (auto & l: lns) {
-        logClient->doAppend2logs(true, "mwc713>>", l);
+        logLimited(LOG_CATEGORY::MWC713_OUT, "mwc713>>", l);
     }
 }
 
 void logMwc713in(QString str) {
     Q_ASSERT(logClient); // call initLogger first
-    logClient->doAppend2logs(true, "mwc713<<", str);
+    logLimited(LOG_CATEGORY::MWC713_IN, "mwc713<<", str);
 }
 
 void logMwcNodeOut(QString str) {
@@ -227,7 +731,7 @@ void logMwcNodeOut(QString str) {
 
     auto lns = str.split(QRegExp("[\r\n]"),QString::SkipEmptyParts);
     for (auto & l: lns) {
-        logClient->doAppend2logs(true, "mwc-node>>", l);
+        logLimited(LOG_CATEGORY::NODE_OUT, "mwc-node>>", l);
     }
 
 }
@@ -238,7 +742,13 @@ void logTask( QString who, wallet::Mwc713Task * task, QString comment ) {
     Q_ASSERT(logClient); // call initLogger first
     if (task == nullptr)
         return;
-    logClient->doAppend2logs(true, who, "Task " + task->toDbgString() + "  "+comment );
+    logLimited(LOG_CATEGORY::TASKS, who, "Task " + task->toDbgString() + "  "+comment );
+
+    eventlog::Event evt = eventlog::makeEvent(eventlog::KIND::TASK, task->getTaskName());
+    evt.who = who;
+    evt.phase = comment;
+    evt.message = task->toDbgString();
+    logEvent(evt);
 }
 
 // Events activity
@@ -246,6 +756,13 @@ void logEmit(QString who, QString event, QString params) {
     // in tests there is no logger
     if (logClient) // call initLogger first
         logClient->doAppend2logs(true, who, "emit " + event + (params.length()==0 ? "" : (" with "+params)) );
+
+    if (logServer) {
+        eventlog::Event evt = eventlog::makeEvent(eventlog::KIND::EMIT, event);
+        evt.who = who;
+        evt.message = params;
+        logEvent(evt);
+    }
 }
 
 void logInfo(QString who, QString message) {
@@ -255,7 +772,7 @@ void logInfo(QString who, QString message) {
 
 void logParsingEvent(wallet::WALLET_EVENTS event, QString message ) {
     Q_ASSERT(logClient); // call initLogger first
-    if (logMwc713outBlocked) { // Skipping event during block pahse as well
+    if (logMwc713outBlocked.loadAcquire()) { // Skipping event during block pahse as well
         logClient->doAppend2logs(true, "Event>", "CENSORED" );
         return;
     }
@@ -263,12 +780,25 @@ void logParsingEvent(wallet::WALLET_EVENTS event, QString message ) {
     if (event == wallet::WALLET_EVENTS::S_LINE) // Lines are reliable and not needed into the nogs. Let's keep logs less noisy.
         return;
 
-    logClient->doAppend2logs(true, "mwc713-Event>", toString(event) + " [" + message + "]" );
+    logLimited(LOG_CATEGORY::PARSING, "mwc713-Event>", toString(event) + " [" + message + "]" );
+
+    eventlog::Event evt = eventlog::makeEvent(eventlog::KIND::PARSING, toString(event));
+    evt.message = message;
+    logEvent(evt);
 }
 
 void logNodeEvent( tries::NODE_OUTPUT_EVENT event, QString message ) {
     Q_ASSERT(logClient); // call initLogger first
-    logClient->doAppend2logs(true, "mwc-node-Event>", toString(event) + " [" + message + "]" );
+    logLimited(LOG_CATEGORY::PARSING, "mwc-node-Event>", toString(event) + " [" + message + "]" );
+
+    eventlog::Event evt = eventlog::makeEvent(eventlog::KIND::NODE, toString(event));
+    evt.message = message;
+    logEvent(evt);
+}
+
+void logEvent(const eventlog::Event & event) {
+    if (logServer)
+        logServer->appendEvent(event.toJsonLine());
 }
 
 
@@ -16,6 +16,14 @@
 #define GUI_WALLET_LOG_H
 
 #include <QObject>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QVector>
+#include <QPair>
+#include <atomic>
+#include <functional>
+#include "mpscringbuffer.h"
+#include "eventlog.h"
 #include "../wallet/mwc713events.h"
 #include "../tries/NodeOutputParser.h"
 
@@ -44,22 +52,151 @@ namespace logger {
         bool asyncLogging; // Use QT messaging or write directly. Direct writing might cause concurrency issues
     };
 
+    // Noisy log sources, every one has its own budget
+    enum class LOG_CATEGORY { MWC713_OUT = 0, MWC713_IN = 1, NODE_OUT = 2, PARSING = 3, TASKS = 4, COUNT = 5 };
+
+    // Config name: mwc713_out, mwc713_in, node_out, parsing, tasks
+    QString toString(LOG_CATEGORY category);
+
+    // Token bucket: the rate is refilled every second, burst is how many seconds of the rate can be accumulated.
+    // 0 rate - unlimited.
+    struct LogBudget {
+        double linesPerSec = 0.0;
+        double bytesPerSec = 0.0;
+        double burstSecs = 10.0;
+        bool   foldRepeats = true; // Same lines in a row are written once with the repeat counter
+
+        // Config value: "<lines per second>,<KB per second>,<burst seconds>"
+        static QPair<bool,QString> fromString(const QString & str, LogBudget & budget);
+    };
+
+    struct LogCategoryStats {
+        QString name;
+        qint64 lines = 0;           // Lines that came in
+        qint64 suppressedLines = 0; // Skipped because of the budget
+        qint64 suppressedBytes = 0;
+        qint64 foldedLines = 0;     // Skipped as repeats of the previous line
+    };
+
+    struct LogStats {
+        qint64 writtenLines = 0;
+        qint64 droppedLines = 0; // Lost because the queue was full
+        int    backlog = 0;      // Lines that are waiting for the writer
+        QVector<LogCategoryStats> categories;
+    };
+
+    // Budget and repeats folding for a single category. Lines come from several threads.
+    class LogLimiter {
+    public:
+        LogLimiter() = default;
+
+        void setBudget(const LogBudget & budget, qint64 nowUsecs);
+        LogBudget getBudget() const;
+
+        // Return true if the line can be written. notes are the lines about skipped data,
+        // they must be written before the line.
+        bool admit(const QString & line, qint64 nowUsecs, QVector<QString> & notes);
+        // Same as admit, but notes and then the admitted line are passed to write under the limiter lock.
+        // Lines from several threads can't get between the notes and the line they are about.
+        bool admitAndWrite(const QString & line, qint64 nowUsecs, const std::function<void(const QString & text, bool note)> & write);
+        // Notes about the pending repeats and skipped lines
+        void finish(QVector<QString> & notes);
+
+        LogCategoryStats getStats() const;
+    private:
+        bool admitLocked(const QString & line, qint64 nowUsecs, QVector<QString> & notes);
+        void refill(qint64 nowUsecs);
+        bool takeTokens(int bytes);
+        void flushRepeats(QVector<QString> & notes);
+        void flushSuppressed(QVector<QString> & notes);
+    private:
+        mutable QMutex mutex;
+        LogBudget budget;
+        double lineTokens = 0.0;
+        double byteTokens = 0.0;
+        qint64 refillTime = -1;
+
+        QString lastLine;
+        bool   lastLineWritten = false;
+        qint64 repeats = 0;
+        qint64 repeatsStart = -1; // -1 - no last line yet
+
+        qint64 pendingLines = 0; // suppressed since the last note
+        qint64 pendingBytes = 0;
+
+        LogCategoryStats stats;
+    };
+
+    class LogWriterThread;
+    class LogArchiver;
+
+    // Lines are queued by any thread into the lock-free ring buffer and written by the writer thread in batches.
+    // The caller never waits for the disk.
     class LogReceiver : public QObject {
         Q_OBJECT
+        friend class LogWriterThread;
+        friend class LogArchiver;
     public:
         LogReceiver(const QString & filename);
         virtual ~LogReceiver() override;
 
+        // Wait until queued lines are written and flushed. Use it before exit or on fatal errors.
+        void flush();
+        LogStats getStats() const;
+
     public slots:
         void onAppend2logs(bool addDate, QString prefix, QString line );
+    public:
+        // Structured event, JSON line. Any thread.
+        void appendEvent(const QByteArray & jsonLine);
+    private slots:
+        void onLogProblem(QString message);
     private:
-        void rotateLogFileIfNeeded();
-        void openLogFile();
+        // Rotation and compression problems go to notifications. Any thread.
+        void reportProblem(const QString & message);
+
+        struct LogLine {
+            qint64  time = -1; // msecs since epoch, -1 - no date
+            QString prefix;
+            QString line;
+            QByteArray event;  // Structured event line, other fields are not used then
+        };
+
+        struct OutFile {
+            QString fileName;
+            QFile * file = nullptr;
+            qint64  size = 0; // QFile::size() flushes, so tracking it here
+        };
+
+        void push(LogLine && ln);
+        void writeLoop();
+        void formatLine(const LogLine & ln, QByteArray & batch);
+        void writeBatch(OutFile & out, QByteArray & batch);
+
+        void rotateFileIfNeeded(OutFile & out);
+        void openFile(OutFile & out);
     private:
         QString logPath;
-        const QString logFileName;
-        QFile * logFile = nullptr;
-        int counter = 0;
+        OutFile textLog;
+        OutFile eventLog;
+
+        util::MpscRingBuffer<LogLine> queue;
+        LogWriterThread * writer = nullptr;
+        LogArchiver * archiver = nullptr;
+
+        QMutex wakeMutex;
+        QWaitCondition wakeWriter; // new data or the stop/flush request
+        QWaitCondition flushDone;
+        std::atomic<bool> stopRequested{false};
+        std::atomic<int>  flushRequested{0};
+        int flushCounter = 0; // guarded by wakeMutex
+
+        std::atomic<qint64> writtenLines{0};
+        std::atomic<qint64> droppedLines{0};
+        qint64 reportedDropped = 0; // writer thread only
+
+        qint64 timeSecs = -1; // timestamp cache, writer thread only
+        QByteArray timeStr;
     };
 
     // Must be call before first log usage
@@ -81,10 +218,24 @@ namespace logger {
     void logEmit(QString who, QString event, QString params);
     void logInfo(QString who, QString message);
 
+    // Budget for the category. Call it before initLogger, defaults are tuned for the mwc713 and node output.
+    void setLogBudget(LOG_CATEGORY category, const LogBudget & budget);
+    LogBudget getLogBudget(LOG_CATEGORY category);
+
+    // Structured events go to mwcwallet.events.jsonl next to the text log, see eventlog.h
+    void logEvent(const eventlog::Event & event);
+
     // enable/disable logs
     void enableLogs( bool enableLogs );
+    // Check if logs are enabled. Use it to skip building expensive log messages
+    bool isLogsEnabled();
     // clean all logs
     void cleanUpLogs();
+
+    // Write all queued lines now. Blocks the caller, use it before the exit or on fatal errors only.
+    void flushLogs();
+    // Logging queue and budgets counters. Empty if logs are disabled.
+    LogStats getLogStats();
 }
 
 
@@ -15,6 +15,8 @@
 #include "crypto.h"
 #include <QString>
 #include <QCryptographicHash>
+#include <QMessageAuthenticationCode>
+#include <QtEndian>
 
 // bunch of crypto related utils
 namespace crypto {
@@ -81,6 +83,43 @@ namespace crypto {
         return hash;
     }
 
+    QByteArray hmacSHA256(const QByteArray & key, const QByteArray & data) {
+        return QMessageAuthenticationCode::hash(data, key, QCryptographicHash::Sha256);
+    }
+
+    // RFC 8018, single block because output is 32 bytes
+    QByteArray pbkdf2SHA256(const QByteArray & password, const QByteArray & salt, int iterations) {
+        QMessageAuthenticationCode mac(QCryptographicHash::Sha256, password);
+        mac.addData(salt);
+        mac.addData( QByteArray::fromHex("00000001") );
+        QByteArray u = mac.result();
+        QByteArray res = u;
+        for (int i=1; i<iterations; i++) {
+            mac.reset();
+            mac.addData(u);
+            u = mac.result();
+            for (int j=0; j<res.size(); j++)
+                res[j] = char(res[j] ^ u[j]);
+        }
+        return res;
+    }
+
+    void xorKeyStream(const QByteArray & key, const QByteArray & nonce, char * data, int size) {
+        QCryptographicHash hash(QCryptographicHash::Algorithm::Sha512);
+        quint64 counter = 0;
+        for (int pos=0; pos<size; counter++) {
+            uchar ctr[8];
+            qToLittleEndian(counter, ctr);
+            hash.reset();
+            hash.addData(key);
+            hash.addData(nonce);
+            hash.addData( reinterpret_cast<const char *>(ctr), sizeof(ctr) );
+            const QByteArray block = hash.result();
+            for (int i=0; i<block.size() && pos<size; i++, pos++)
+                data[pos] = char(data[pos] ^ block[i]);
+        }
+    }
+
     // Verify Public Key.
     // Checking the length and Hex Symbols
     bool isPublicKeyValid( const QString & key ) {
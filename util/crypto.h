@@ -32,6 +32,16 @@ namespace crypto {
 
     QString calcHSA256Hash(const QString& key);
 
+    // HMAC with SHA256, return 32 bytes
+    QByteArray hmacSHA256(const QByteArray & key, const QByteArray & data);
+
+    // PBKDF2 with HMAC-SHA256, return 32 bytes key
+    QByteArray pbkdf2SHA256(const QByteArray & password, const QByteArray & salt, int iterations);
+
+    // Encrypt or decrypt the data in place. Keystream is SHA512(key|nonce|counter) blocks, so the same
+    // call does both. Key must be secret and the nonce must never be reused with the same key.
+    void xorKeyStream(const QByteArray & key, const QByteArray & nonce, char * data, int size);
+
     // Verify Public Key.
     // Checking the length and Hex Symbols
     bool isPublicKeyValid( const QString & key );
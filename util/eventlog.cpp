@@ -0,0 +1,152 @@
+// Copyright 2019 The MWC Developers
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "eventlog.h"
+#include <QElapsedTimer>
+#include <QDateTime>
+#include <QJsonDocument>
+#include <QJsonObject>
+
+namespace eventlog {
+
+QString toString(KIND kind) {
+    switch (kind) {
+        case KIND::PARSING: return "parsing";
+        case KIND::NODE:    return "node";
+        case KIND::TASK:    return "task";
+        case KIND::EMIT:    return "emit";
+        case KIND::INFO:    return "info";
+        default:            return "unknown";
+    }
+}
+
+KIND kindFromString(const QString & str) {
+    if (str == "parsing") return KIND::PARSING;
+    if (str == "node")    return KIND::NODE;
+    if (str == "task")    return KIND::TASK;
+    if (str == "emit")    return KIND::EMIT;
+    if (str == "info")    return KIND::INFO;
+    return KIND::UNKNOWN;
+}
+
+qint64 monotonicUsecs() {
+    static QElapsedTimer timer = []() { QElapsedTimer t; t.start(); return t; }();
+    return timer.nsecsElapsed() / 1000;
+}
+
+Event makeEvent(KIND kind, const QString & name) {
+    Event evt;
+    evt.kind = kind;
+    evt.mono = monotonicUsecs();
+    evt.time = QDateTime::currentMSecsSinceEpoch();
+    evt.name = name;
+    return evt;
+}
+
+// Writing is on the hot path, so JSON is built by hands
+void appendJsonString(QByteArray & res, const QString & value) {
+    res += '"';
+    for (int i=0; i<value.size(); i++) {
+        const ushort c = value[i].unicode();
+        if (c >= 0x80) {
+            // Non ASCII run is converted at once, so surrogate pairs stay together
+            int j = i;
+            while (j<value.size() && value[j].unicode() >= 0x80)
+                j++;
+            res += value.midRef(i, j-i).toUtf8();
+            i = j-1;
+        }
+        else if (c == '"' || c == '\\') {
+            res += '\\';
+            res += char(c);
+        }
+        else if (c == '\n') res += "\\n";
+        else if (c == '\r') res += "\\r";
+        else if (c == '\t') res += "\\t";
+        else if (c < 0x20) {
+            res += "\\u00";
+            res += QByteArray::number(c + 0x100, 16).mid(1);
+        }
+        else {
+            res += char(c);
+        }
+    }
+    res += '"';
+}
+
+static void appendString(QByteArray & res, const char * key, const QString & value) {
+    if (value.isEmpty())
+        return;
+    res += ",\"";
+    res += key;
+    res += "\":";
+    appendJsonString(res, value);
+}
+
+static void appendNumber(QByteArray & res, const char * key, qint64 value) {
+    if (value < 0)
+        return;
+    res += ",\"";
+    res += key;
+    res += "\":";
+    res += QByteArray::number(value);
+}
+
+QByteArray Event::toJsonLine() const {
+    QByteArray res;
+    res.reserve(128 + message.size());
+    res += "{\"k\":\"";
+    res += toString(kind).toLatin1();
+    res += "\",\"t\":";
+    res += QByteArray::number(mono);
+    res += ",\"w\":";
+    res += QByteArray::number(time);
+    appendString(res, "n", name);
+    appendString(res, "who", who);
+    appendString(res, "ph", phase);
+    appendNumber(res, "q", queueMs);
+    appendNumber(res, "d", durationMs);
+    appendNumber(res, "c", count);
+    appendNumber(res, "b", bytes);
+    appendString(res, "m", message);
+    res += '}';
+    return res;
+}
+
+// static
+bool Event::fromJsonLine(const QByteArray & line, Event & event) {
+    QJsonParseError error;
+    QJsonDocument doc = QJsonDocument::fromJson(line, &error);
+    if (error.error != QJsonParseError::NoError || !doc.isObject())
+        return false;
+
+    QJsonObject obj = doc.object();
+    event = Event();
+    event.kind = kindFromString(obj.value("k").toString());
+    if (event.kind == KIND::UNKNOWN)
+        return false;
+    event.mono = qint64(obj.value("t").toDouble());
+    event.time = qint64(obj.value("w").toDouble());
+    event.name = obj.value("n").toString();
+    event.who = obj.value("who").toString();
+    event.phase = obj.value("ph").toString();
+    event.queueMs = qint64(obj.value("q").toDouble(-1));
+    event.durationMs = qint64(obj.value("d").toDouble(-1));
+    event.count = qint64(obj.value("c").toDouble(-1));
+    event.bytes = qint64(obj.value("b").toDouble(-1));
+    event.message = obj.value("m").toString();
+    return true;
+}
+
+}
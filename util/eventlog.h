@@ -0,0 +1,65 @@
+// Copyright 2019 The MWC Developers
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MWC_QT_WALLET_EVENTLOG_H
+#define MWC_QT_WALLET_EVENTLOG_H
+
+#include <QString>
+#include <QByteArray>
+
+// Structured log records. They are written next to the text log as JSON lines, one event per line:
+//   {"k":"task","t":1523456,"w":1600000000000,"n":"TaskTransactions","who":"Mwc713EventManager","ph":"done","q":12,"d":340,"c":25,"b":10240,"m":"..."}
+//   k  - kind: parsing, node, task, emit, info
+//   t  - monotonic time, usecs since the logger start. w - wall clock, msecs since epoch
+//   n  - event name: WALLET_EVENTS, NODE_OUTPUT_EVENT, task name or emitted signal
+//   ph - task phase: task comment ('Starting...') or done.  q - time in the queue, d - duration, both msecs
+//   c  - events number, b - bytes. Optional fields are skipped if not set.
+// This file doesn't depend on the rest of the wallet, the offline tool is built with it.
+namespace eventlog {
+
+enum class KIND { UNKNOWN = 0, PARSING = 1, NODE = 2, TASK = 3, EMIT = 4, INFO = 5 };
+
+QString toString(KIND kind);
+KIND kindFromString(const QString & str);
+
+struct Event {
+    KIND    kind = KIND::UNKNOWN;
+    qint64  mono = 0;   // usecs since the logger start
+    qint64  time = 0;   // msecs since epoch
+    QString name;
+    QString who;
+    QString phase;
+    qint64  queueMs = -1;
+    qint64  durationMs = -1;
+    qint64  count = -1;
+    qint64  bytes = -1;
+    QString message;
+
+    // Line without '\n'
+    QByteArray toJsonLine() const;
+    static bool fromJsonLine(const QByteArray & line, Event & event);
+};
+
+// Event with mono and time set to now
+Event makeEvent(KIND kind, const QString & name);
+
+// Monotonic usecs since the first call
+qint64 monotonicUsecs();
+
+// Append the value as a quoted and escaped JSON string
+void appendJsonString(QByteArray & res, const QString & value);
+
+}
+
+#endif //MWC_QT_WALLET_EVENTLOG_H
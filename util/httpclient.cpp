@@ -22,6 +22,7 @@
 #include <QDataStream>
 #include "stringutils.h"
 #include "Log.h"
+#include "tracer.h"
 
 namespace util {
 
@@ -85,6 +86,7 @@ void HttpClient::sendRequest(HTTP_CALL call, const QString & url,
         reply->setProperty("param2", QVariant(param2));
         reply->setProperty("param3", QVariant(param3));
         reply->setProperty("param4", QVariant(param4));
+        reply->setProperty("traceId", QVariant( tracer::asyncBegin("http", "HttpClient", tag) ));
         // Respond will be send back async
     }
 }
@@ -92,6 +94,8 @@ void HttpClient::sendRequest(HTTP_CALL call, const QString & url,
 void HttpClient::replyFinished(QNetworkReply* reply) {
     QNetworkReply::NetworkError errCode = reply->error();
     QString tag = reply->property("tag").toString();
+    tracer::asyncEnd("http", "HttpClient", tag, reply->property("traceId").toULongLong());
+    tracer::Span traceSpan("http", "HttpClient::replyFinished", tag);
 
     qDebug() << "Get back respond with tag: " << tag << "  Error code: " << errCode;
 
@@ -0,0 +1,111 @@
+// Copyright 2019 The MWC Developers
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MWC_QT_WALLET_MPSCRINGBUFFER_H
+#define MWC_QT_WALLET_MPSCRINGBUFFER_H
+
+#include <atomic>
+#include <memory>
+#include <cstddef>
+#include <cstdint>
+
+namespace util {
+
+// Bounded lock-free queue, many producers and a single consumer.
+// Every cell has a sequence number, producers reserve the cell with CAS on the head, so nobody waits
+// for the lock. When the buffer is full push fails, the caller decides what to do with the item.
+template <class T>
+class MpscRingBuffer {
+public:
+    // capacity is rounded up to the power of 2
+    explicit MpscRingBuffer(size_t capacity) {
+        size_t sz = 2;
+        while (sz < capacity)
+            sz <<= 1;
+        mask = sz - 1;
+        cells.reset(new Cell[sz]);
+        for (size_t i = 0; i < sz; i++)
+            cells[i].seq.store(i, std::memory_order_relaxed);
+        head.store(0, std::memory_order_relaxed);
+        tail.store(0, std::memory_order_relaxed);
+    }
+
+    MpscRingBuffer(const MpscRingBuffer &) = delete;
+    MpscRingBuffer & operator=(const MpscRingBuffer &) = delete;
+
+    // Any thread. Return false if the buffer is full
+    bool push(T && item) {
+        size_t pos = head.load(std::memory_order_relaxed);
+        Cell * cell = nullptr;
+        for (;;) {
+            cell = &cells[pos & mask];
+            const size_t seq = cell->seq.load(std::memory_order_acquire);
+            const intptr_t dif = intptr_t(seq) - intptr_t(pos);
+            if (dif == 0) {
+                if (head.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                    break;
+            }
+            else if (dif < 0) {
+                return false;
+            }
+            else {
+                pos = head.load(std::memory_order_relaxed);
+            }
+        }
+        cell->data = std::move(item);
+        cell->seq.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer thread only. Return false if the buffer is empty
+    bool pop(T & item) {
+        const size_t pos = tail.load(std::memory_order_relaxed);
+        Cell & cell = cells[pos & mask];
+        const size_t seq = cell.seq.load(std::memory_order_acquire);
+        if (intptr_t(seq) - intptr_t(pos + 1) < 0)
+            return false;
+        item = std::move(cell.data);
+        cell.data = T();
+        cell.seq.store(pos + mask + 1, std::memory_order_release);
+        tail.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Approximate number of items, any thread
+    size_t size() const {
+        const size_t t = tail.load(std::memory_order_acquire);
+        const size_t h = head.load(std::memory_order_acquire);
+        return h > t ? h - t : 0;
+    }
+
+    size_t capacity() const {return mask + 1;}
+
+private:
+    struct Cell {
+        std::atomic<size_t> seq;
+        T data;
+    };
+
+    std::unique_ptr<Cell[]> cells;
+    size_t mask = 0;
+    // Padding keeps producers and consumer counters at different cache lines
+    char pad1[64];
+    std::atomic<size_t> head; // producers
+    char pad2[64];
+    std::atomic<size_t> tail; // consumer
+};
+
+}
+
+#endif //MWC_QT_WALLET_MPSCRINGBUFFER_H
@@ -0,0 +1,309 @@
+// Copyright 2019 The MWC Developers
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "tracer.h"
+#include "eventlog.h"
+#include "mpscringbuffer.h"
+#include <QCoreApplication>
+#include <QFile>
+#include <QThread>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QWaitCondition>
+#include <QSharedPointer>
+#include <atomic>
+
+// Spans that can wait for the writer. Extra spans are dropped and counted.
+#define TRACE_QUEUE_SIZE      65536
+// Writer wakes up with this period
+#define TRACE_WRITE_PERIOD_MS 500
+#define TRACE_BATCH_BYTES     (256*1024)
+
+namespace tracer {
+
+// Spans are formatted by the caller and written into the file by this thread
+class TraceWriter : public QThread {
+public:
+    TraceWriter(QFile * _file) : file(_file), queue(TRACE_QUEUE_SIZE) {}
+    virtual ~TraceWriter() override { delete file; }
+
+    // Any thread. Spans that come after finish() are dropped.
+    void push(QByteArray && event) {
+        if (finished.load())
+            return;
+        if (!queue.push(std::move(event)))
+            dropped++;
+    }
+
+    void stop() {
+        QMutexLocker l(&mutex);
+        stopped = true;
+        cond.wakeAll();
+    }
+
+    // Thread is stopped. Array is closed, so the file is a valid JSON.
+    void finish(qint64 pid) {
+        writeQueue();
+        QByteArray last = "{\"name\":\"Tracing stopped\",\"ph\":\"i\",\"s\":\"g\",\"ts\":" + QByteArray::number(eventlog::monotonicUsecs()) +
+                ",\"pid\":" + QByteArray::number(pid) + ",\"tid\":0,\"args\":{\"dropped\":" + QByteArray::number(dropped.load()) + "}}\n]\n";
+        file->write(last);
+        file->close();
+        finished.store(true);
+    }
+
+protected:
+    virtual void run() override {
+        while (true) {
+            bool stopping = false;
+            {
+                QMutexLocker l(&mutex);
+                if (!stopped)
+                    cond.wait(&mutex, TRACE_WRITE_PERIOD_MS);
+                stopping = stopped;
+            }
+            if (stopping)
+                return; // finish() writes the rest
+            writeQueue();
+        }
+    }
+
+private:
+    void writeQueue() {
+        QByteArray batch;
+        QByteArray event;
+        while (queue.pop(event)) {
+            batch += event;
+            batch += ",\n";
+            if (batch.size() >= TRACE_BATCH_BYTES) {
+                file->write(batch);
+                batch.resize(0);
+            }
+        }
+        if (!batch.isEmpty()) {
+            file->write(batch);
+            file->flush(); // Trace stays readable if the wallet is killed
+        }
+    }
+
+private:
+    QFile * file;
+    util::MpscRingBuffer<QByteArray> queue;
+    std::atomic<qint64> dropped{0};
+    std::atomic<bool> finished{false};
+
+    QMutex mutex;
+    QWaitCondition cond;
+    bool stopped = false;
+};
+
+// Spans of other threads might be pushing while tracing is stopped. Every push holds a reference,
+// the writer is deleted by the last one.
+static QMutex writerMutex;
+static QSharedPointer<TraceWriter> writer;
+static std::atomic<bool> tracing{false};
+static qint64 processId = 0;
+static std::atomic<int> laneCounter{0};
+static std::atomic<int> generation{0}; // every start writes the lanes names again
+static std::atomic<quint64> asyncCounter{0};
+
+struct Lane {
+    int tid = 0;
+    int generation = -1;
+};
+static thread_local Lane lane;
+
+static void appendIds(QByteArray & event, int tid) {
+    event += ",\"pid\":";
+    event += QByteArray::number(processId);
+    event += ",\"tid\":";
+    event += QByteArray::number(tid);
+}
+
+// Lane of the current thread. Its name is written with the first span.
+static int currentLane(TraceWriter * w) {
+    const int gen = generation.load();
+    if (lane.generation == gen)
+        return lane.tid;
+
+    if (lane.tid == 0)
+        lane.tid = ++laneCounter;
+    lane.generation = gen;
+
+    QThread * thread = QThread::currentThread();
+    const bool uiThread = QCoreApplication::instance() != nullptr && thread == QCoreApplication::instance()->thread();
+    QString name = thread->objectName();
+    if (name.isEmpty())
+        name = uiThread ? QString("UI") : "Thread " + QString::number(lane.tid);
+
+    QByteArray event = "{\"name\":\"thread_name\",\"ph\":\"M\"";
+    appendIds(event, lane.tid);
+    event += ",\"args\":{\"name\":";
+    eventlog::appendJsonString(event, name);
+    event += "}}";
+    w->push(std::move(event));
+
+    if (uiThread) {
+        // UI lane goes first, stalls are there
+        event = "{\"name\":\"thread_sort_index\",\"ph\":\"M\"";
+        appendIds(event, lane.tid);
+        event += ",\"args\":{\"sort_index\":-1}}";
+        w->push(std::move(event));
+    }
+    return lane.tid;
+}
+
+static QByteArray makeEvent(const char * category, const QString & name, char phase, qint64 ts) {
+    QByteArray event;
+    event.reserve(160 + name.size());
+    event += "{\"cat\":\"";
+    event += category;
+    event += "\",\"name\":";
+    eventlog::appendJsonString(event, name);
+    event += ",\"ph\":\"";
+    event += phase;
+    event += "\",\"ts\":";
+    event += QByteArray::number(ts);
+    return event;
+}
+
+static QSharedPointer<TraceWriter> getWriter() {
+    QMutexLocker l(&writerMutex);
+    return writer;
+}
+
+QPair<bool,QString> startTracing(const QString & fileName) {
+    QMutexLocker l(&writerMutex);
+    if (writer)
+        return QPair<bool,QString>(true, "");
+
+    QFile * file = new QFile(fileName);
+    if (!file->open(QFile::WriteOnly | QFile::Truncate)) {
+        delete file;
+        return QPair<bool,QString>(false, "Unable to open the trace file " + fileName);
+    }
+
+    processId = QCoreApplication::applicationPid();
+    eventlog::monotonicUsecs(); // same time base as the event log
+
+    // JSON array format, closing bracket is optional for the viewers. Process name goes first.
+    QByteArray head = "[\n{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":" + QByteArray::number(processId) +
+                      ",\"tid\":0,\"args\":{\"name\":\"mwc-qt-wallet\"}},\n";
+    file->write(head);
+
+    writer = QSharedPointer<TraceWriter>(new TraceWriter(file));
+    generation++;
+    writer->start(QThread::LowPriority);
+    tracing.store(true);
+    return QPair<bool,QString>(true, "");
+}
+
+void stopTracing() {
+    QSharedPointer<TraceWriter> w;
+    {
+        QMutexLocker l(&writerMutex);
+        w.swap(writer);
+        tracing.store(false);
+    }
+    if (!w)
+        return;
+    w->stop();
+    w->wait();
+    // Spans that are pushed after that are dropped
+    w->finish(processId);
+}
+
+bool isTracing() {
+    return tracing.load(std::memory_order_relaxed);
+}
+
+Span::Span(const char * _category, const char * _name) :
+        category(_category), name(_name)
+{
+    if (isTracing())
+        start = eventlog::monotonicUsecs();
+}
+
+Span::Span(const char * _category, const QString & _name) :
+        category(_category), strName(_name)
+{
+    if (isTracing())
+        start = eventlog::monotonicUsecs();
+}
+
+Span::Span(const char * _category, const char * prefix, const QString & tag) :
+        category(_category)
+{
+    if (isTracing()) {
+        strName = QString::fromLatin1(prefix) + " " + tag;
+        start = eventlog::monotonicUsecs();
+    }
+}
+
+Span::~Span() {
+    if (start < 0)
+        return;
+    QSharedPointer<TraceWriter> w = getWriter();
+    if (!w)
+        return;
+
+    const qint64 end = eventlog::monotonicUsecs();
+    QByteArray event = makeEvent(category, name ? QString::fromLatin1(name) : strName, 'X', start);
+    event += ",\"dur\":";
+    event += QByteArray::number(end - start);
+    appendIds(event, currentLane(w.data()));
+    event += '}';
+    w->push(std::move(event));
+}
+
+static void pushAsync(const char * category, const QString & name, char phase, quint64 id) {
+    QSharedPointer<TraceWriter> w = getWriter();
+    if (!w)
+        return;
+
+    QByteArray event = makeEvent(category, name, phase, eventlog::monotonicUsecs());
+    event += ",\"id\":\"0x";
+    event += QByteArray::number(id, 16);
+    event += '"';
+    appendIds(event, currentLane(w.data()));
+    event += '}';
+    w->push(std::move(event));
+}
+
+quint64 asyncBegin(const char * category, const QString & name) {
+    if (!isTracing())
+        return 0;
+    const quint64 id = ++asyncCounter;
+    pushAsync(category, name, 'b', id);
+    return id;
+}
+
+void asyncEnd(const char * category, const QString & name, quint64 id) {
+    if (id == 0)
+        return;
+    pushAsync(category, name, 'e', id);
+}
+
+quint64 asyncBegin(const char * category, const char * prefix, const QString & tag) {
+    if (!isTracing())
+        return 0;
+    return asyncBegin(category, QString::fromLatin1(prefix) + " " + tag);
+}
+
+void asyncEnd(const char * category, const char * prefix, const QString & tag, quint64 id) {
+    if (id == 0)
+        return;
+    asyncEnd(category, QString::fromLatin1(prefix) + " " + tag, id);
+}
+
+}
@@ -0,0 +1,64 @@
+// Copyright 2019 The MWC Developers
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MWC_QT_WALLET_TRACER_H
+#define MWC_QT_WALLET_TRACER_H
+
+#include <QString>
+#include <QPair>
+
+// Timeline tracer for the UI stalls investigation. Spans are written in Chrome trace event JSON,
+// the file can be opened with chrome://tracing or https://ui.perfetto.dev. Every thread has its own lane.
+// Tracing is off by default, start it with 'mwc-qt-wallet --trace <file>'.
+// Span time is the same monotonic clock as the structured event log, so both can be matched.
+namespace tracer {
+
+// Start writing into the file. The file is overwritten.
+QPair<bool,QString> startTracing(const QString & fileName);
+// Write the rest of the spans and close the file
+void stopTracing();
+
+bool isTracing();
+
+// Synchronous span in the lane of the current thread, from the constructor till the destructor.
+// When tracing is off it does nothing.
+class Span {
+public:
+    Span(const char * category, const char * name);
+    Span(const char * category, const QString & name);
+    // Name is "<prefix> <tag>", it is built only when tracing is on
+    Span(const char * category, const char * prefix, const QString & tag);
+    ~Span();
+
+    Span(const Span &) = delete;
+    Span & operator=(const Span &) = delete;
+private:
+    const char * category;
+    const char * name = nullptr;
+    QString      strName;
+    qint64       start = -1; // -1 - tracing is off
+};
+
+// Async span, might end in another call or thread: http requests, mwc713 tasks.
+// Return the span id for asyncEnd, 0 if tracing is off.
+quint64 asyncBegin(const char * category, const QString & name);
+// id 0 is ignored
+void asyncEnd(const char * category, const QString & name, quint64 id);
+// Same with the "<prefix> <tag>" name that is built only when tracing is on
+quint64 asyncBegin(const char * category, const char * prefix, const QString & tag);
+void asyncEnd(const char * category, const char * prefix, const QString & tag, quint64 id);
+
+}
+
+#endif //MWC_QT_WALLET_TRACER_H
@@ -56,7 +56,7 @@ static double optimizeBucket( QVector<wallet::WalletOutput> & resultBucket, cons
     QSet<QString> bucketCommits;
     int64_t change = -nanoCoins;
     for (const auto & out: resultBucket) {
-        bucketCommits += out.outputCommitment;
+        bucketCommits += out.getOutputCommitment();
         change += out.valueNano;
     }
     Q_ASSERT(change>=0); // Not enough funds?
@@ -66,7 +66,7 @@ static double optimizeBucket( QVector<wallet::WalletOutput> & resultBucket, cons
         foundBetterSolution = false;
         // doing single scan
         for (wallet::WalletOutput out: inputOutputs) {
-            if ( bucketCommits.contains(out.outputCommitment) )
+            if ( bucketCommits.contains(out.getOutputCommitment()) )
                 continue;
 
             // Check if can substitute
@@ -79,8 +79,8 @@ static double optimizeBucket( QVector<wallet::WalletOutput> & resultBucket, cons
                 change += out.valueNano;
                 Q_ASSERT(change>=0);
 
-                bucketCommits -= delOutput.outputCommitment;
-                bucketCommits += out.outputCommitment;
+                bucketCommits -= delOutput.getOutputCommitment();
+                bucketCommits += out.getOutputCommitment();
 
                 foundBetterSolution = true;
 
@@ -175,7 +175,7 @@ bool calcOutputsToSpend( int64_t nanoCoins, const QVector<wallet::WalletOutput>
     Q_ASSERT(!resultBucket.isEmpty());
 
     for (const auto & o : resultBucket) {
-        resultOutputs += o.outputCommitment;
+        resultOutputs += o.getOutputCommitment();
     }
     return true;
 }
@@ -210,18 +210,18 @@ bool getOutputsToSend( const QString & accountName, int outputsNumber, int64_t n
 
     for (wallet::WalletOutput o : outputs) {
         // Keep unspent only
-        if (o.status != "Unspent") // Interesting only in Unspent outputs
+        if (o.status != wallet::WalletOutput::STATUS::UNSPENT) // Interesting only in Unspent outputs
             continue;
         // Skip mined that can't spend
-        if (o.coinbase && o.numOfConfirms.toLong() <= 1440)
+        if (o.coinbase && o.numOfConfirms <= 1440)
             continue;
-        if (!o.coinbase && o.numOfConfirms.toInt() < appContext->getSendCoinsParams().inputConfirmationNumber)
+        if (!o.coinbase && o.numOfConfirms < appContext->getSendCoinsParams().inputConfirmationNumber)
             continue;
         // Skip locked
-        if (appContext->isLockedOutputs(o.outputCommitment))
+        if (appContext->isLockedOutputs(o.getOutputCommitment()))
             continue;
 
-        allOutputs.push_back(o.outputCommitment);
+        allOutputs.push_back(o.getOutputCommitment());
         totalNanoCoins += o.valueNano;
         o.weight = 1.0;
         freeOuts.insert(o.valueNano, o);  // inserts by value
@@ -243,15 +243,15 @@ findSpendableOutputs(const QString& accountName, const wallet::Wallet* wallet, c
 
     QVector<wallet::WalletOutput>  outputs = wallet->getwalletOutputs().value(accountName);
     for ( wallet::WalletOutput o : outputs) {
-        if ( o.status != "Unspent" ) // Interested only in Unspent outputs
+        if ( o.status != wallet::WalletOutput::STATUS::UNSPENT ) // Interested only in Unspent outputs
             continue;
         // Skip mined that can't spend
-        if (o.coinbase && o.numOfConfirms.toLong()<=mwc::COIN_BASE_CONFIRM_NUMBER )
+        if (o.coinbase && o.numOfConfirms<=mwc::COIN_BASE_CONFIRM_NUMBER )
             continue;
-        if (!o.coinbase && o.numOfConfirms.toInt() < appContext->getSendCoinsParams().inputConfirmationNumber)
+        if (!o.coinbase && o.numOfConfirms < appContext->getSendCoinsParams().inputConfirmationNumber)
             continue;
         // ensure outputs locked by Qt Wallet are not used
-        if (appContext->isLockOutputEnabled() && appContext->isLockedOutputs(o.outputCommitment))
+        if (appContext->isLockOutputEnabled() && appContext->isLockedOutputs(o.getOutputCommitment()))
             continue;
         spendableOutputs.insert(o.valueNano, o);
     }
@@ -397,7 +397,7 @@ uint64_t getTxnFeeFromSpendableOutputs(int64_t amount, const QMultiMap<int64_t,
     // and large number of outputs will not need to be scanned again
     if (txnFee != 0 && txnOutputList.size() == 0) {
         for (wallet::WalletOutput o : txnInputs) {
-            txnOutputList.push_back(o.outputCommitment);
+            txnOutputList.push_back(o.getOutputCommitment());
         }
     }
 
@@ -14,6 +14,7 @@
 
 #include "MockWallet.h"
 #include "../util/crypto.h"
+#include "historystore.h"
 #include <QMap>
 
 namespace wallet {
@@ -169,6 +170,17 @@ const QMap<QString, QVector<wallet::WalletOutput> > &  MockWallet::getwalletOutp
     return emptyOutputs;
 }
 
+static HistoryStore emptyHistory; // never opened
+
+const HistoryStore & MockWallet::getHistoryStore() const {
+    return emptyHistory;
+}
+
+HistoryQueryResult MockWallet::searchHistory(const HistoryQuery & query) {
+    Q_UNUSED(query)
+    return HistoryQueryResult();
+}
+
 // Request Wallet balance update. It is a multistep operation
 // Check signal: onWalletBalanceUpdated
 //          onWalletBalanceProgress
@@ -256,6 +268,16 @@ bool MockWallet::getNodeStatus() {
     return true;
 }
 
+// Mock doesn't have any task engine
+QJsonObject MockWallet::getTaskMetrics() const {
+    return QJsonObject();
+}
+
+QString MockWallet::dumpTaskMetrics(QString fileName) const {
+    Q_UNUSED(fileName)
+    return "Task metrics are not available for the mock wallet";
+}
+
 // Set account that will receive the funds
 // Check Signal:  onSetReceiveAccount( bool ok, QString AccountOrMessage );
 void MockWallet::setReceiveAccount(QString account) {
@@ -416,8 +438,8 @@ void MockWallet::sendTo(const QString &account, int64_t coinNano, const QString
 }
 
 // Show outputs for the wallet
-// Check Signal: onOutputs( QString account, int64_t height, QVector<WalletOutput> outputs)
-void MockWallet::getOutputs(QString account, bool show_spent, bool enforceSync) {
+// Check Signal: onOutputs( QString account, bool showSpent, int64_t height, QVector<WalletOutput> outputs, QString cookie)
+void MockWallet::getOutputs(QString account, bool show_spent, bool enforceSync, QString cookie) {
     Q_UNUSED(show_spent)
     Q_UNUSED(enforceSync)
 
@@ -431,12 +453,12 @@ void MockWallet::getOutputs(QString account, bool show_spent, bool enforceSync)
             "4",
             1000000000,
             2));
-    emit onOutputs( account, show_spent, 12345, outputs);
+    emit onOutputs( account, show_spent, 12345, outputs, cookie);
 }
 
 // Show all transactions for current account
-// Check Signal: onTransactions( QString account, int64_t height, QVector<WalletTransaction> Transactions)
-void MockWallet::getTransactions(QString account, bool enforceSync) {
+// Check Signal: onTransactions( QString account, int64_t height, QVector<WalletTransaction> Transactions, QString cookie)
+void MockWallet::getTransactions(QString account, bool enforceSync, QString cookie) {
     Q_UNUSED(enforceSync)
 
     WalletTransaction tx;
@@ -458,7 +480,7 @@ void MockWallet::getTransactions(QString account, bool enforceSync) {
             false,
             "3746538765238745643");
 
-    emit onTransactions( account, 12345, {tx});
+    emit onTransactions( account, 12345, {tx}, cookie);
 }
 
 // get Extended info for specific transaction
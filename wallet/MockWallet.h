@@ -141,9 +141,16 @@ public:
     // This info needed in many cases and we don't want spend time every time for that.
     virtual QVector<AccountInfo>  getWalletBalance(bool filterDeleted) const  override;
 
+    // Balances, outputs and transactions can be restored from the cache at login. They are shown until
+    // the first balance refresh is done. Return the height of that restored data, -1 if data is fresh.
+    virtual int64_t getWarmStartHeight() const override {return -1;}
+
     // Get outputs that was collected for this wallet. Outputs should be ready with balances
     virtual const QMap<QString, QVector<wallet::WalletOutput> > & getwalletOutputs() const override;
 
+    virtual const HistoryStore & getHistoryStore() const override;
+    virtual HistoryQueryResult searchHistory(const HistoryQuery & query) override;
+
     virtual QString getCurrentAccountName()  override {return currentAccount;}
 
     // Request Wallet balance update. It is a multistep operation
@@ -188,6 +195,11 @@ public:
     // Check Signal: onNodeSatatus( bool online, QString errMsg, int height, int64_t totalDifficulty, int connections )
     virtual bool getNodeStatus() override;
 
+    // Task engine metrics: latency histograms by task and queue depth by priority.
+    virtual QJsonObject getTaskMetrics() const override;
+    // Dump task engine metrics into the json file. Return error message or empty string on success
+    virtual QString dumpTaskMetrics(QString fileName) const override;
+
     // -------------- Transactions
 
     // Set account that will receive the funds
@@ -263,12 +275,14 @@ public:
                          const QStringList & outputs, bool fluff, int ttl_blocks, bool generateProof, QString expectedproofAddress )  override;
 
     // Show outputs for the wallet
-    // Check Signal: onOutputs( QString account, int64_t height, QVector<WalletOutput> outputs)
-    virtual void getOutputs(QString account, bool show_spent, bool enforceSync)  override;
+    // cookie - requester tag, it will be returned back with result. Identical requests might share the same result.
+    // Check Signal: onOutputs( QString account, bool showSpent, int64_t height, QVector<WalletOutput> outputs, QString cookie)
+    virtual void getOutputs(QString account, bool show_spent, bool enforceSync, QString cookie = "")  override;
 
     // Show all transactions for current account
-    // Check Signal: onTransactions( QString account, int64_t height, QVector<WalletTransaction> Transactions)
-    virtual void getTransactions(QString account, bool enforceSync)  override;
+    // cookie - requester tag, it will be returned back with result. Identical requests might share the same result.
+    // Check Signal: onTransactions( QString account, int64_t height, QVector<WalletTransaction> Transactions, QString cookie)
+    virtual void getTransactions(QString account, bool enforceSync, QString cookie = "")  override;
 
     // get Extended info for specific transaction
     // Check Signal: onTransactionById( bool success, QString account, int64_t height, WalletTransaction transaction, QVector<WalletOutput> outputs, QVector<QString> messages )
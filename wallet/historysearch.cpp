@@ -0,0 +1,153 @@
+// Copyright 2019 The MWC Developers
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "historysearch.h"
+#include "historystore.h"
+#include "../core/global.h"
+#include <QDateTime>
+#include <algorithm>
+
+namespace wallet {
+
+HistoryQueryResult HistorySearch::search( const HistoryStore & store, const HistoryQuery & query,
+                                          const NoteLookup & notes, int notesRevision ) {
+    HistoryQueryResult res;
+    const AccountIndex & idx = getIndex(store, query.account, notes, notesRevision);
+    const int rowNum = idx.transactions.size();
+    if (rowNum == 0)
+        return res;
+
+    // Prefixes narrow the rows first
+    QVector<bool> candidates;
+    const QString prefixes[] = {query.addressPrefix, query.uuidPrefix, query.kernelPrefix};
+    const PrefixIndex * indexes[] = {&idx.addresses, &idx.uuids, &idx.kernels};
+    for (int i=0; i<3; i++) {
+        QVector<bool> rows(rowNum, false);
+        if (!matchPrefix(*indexes[i], prefixes[i], rows))
+            continue;
+        if (candidates.isEmpty())
+            candidates = rows;
+        else
+            for (int r=0; r<rowNum; r++)
+                candidates[r] = candidates[r] && rows[r];
+    }
+
+    const QString text = query.text.trimmed().toLower();
+    const uint typeMask = query.types & (WalletTransaction::SEND | WalletTransaction::RECEIVE | WalletTransaction::COIN_BASE);
+
+    for (int r=0; r<rowNum; r++) {
+        if (!candidates.isEmpty() && !candidates[r])
+            continue;
+
+        const uint type = idx.types[r];
+        if (typeMask != 0 && (type & typeMask) == 0)
+            continue;
+        if (query.cancelled >= 0 && bool(type & WalletTransaction::CANCELLED) != bool(query.cancelled))
+            continue;
+        if (query.confirmed >= 0 && idx.transactions[r].confirmed != bool(query.confirmed))
+            continue;
+
+        const int64_t amount = idx.amounts[r];
+        if ( (query.minAmount >= 0 && amount < query.minAmount) || (query.maxAmount >= 0 && amount > query.maxAmount) )
+            continue;
+        const int64_t height = idx.heights[r];
+        if ( (query.minHeight >= 0 && height < query.minHeight) || (query.maxHeight >= 0 && height > query.maxHeight) )
+            continue;
+        if (query.fromTime >= 0 || query.toTime >= 0) {
+            const int64_t time = idx.creationTimes[r];
+            if ( time < 0 || (query.fromTime >= 0 && time < query.fromTime) || (query.toTime >= 0 && time > query.toTime) )
+                continue;
+        }
+        if (!text.isEmpty() && !idx.texts[r].contains(text))
+            continue;
+
+        if (res.total >= query.offset && res.transactions.size() < query.count)
+            res.transactions.push_back(idx.transactions[r]);
+        res.total++;
+    }
+
+    return res;
+}
+
+const HistorySearch::AccountIndex & HistorySearch::getIndex( const HistoryStore & store, const QString & account,
+                                                             const NoteLookup & notes, int notesRevision ) {
+    AccountIndex & idx = accounts[account];
+    const int storeRevision = store.getTransactionsRevision(account);
+    if (idx.storeRevision != storeRevision || idx.notesRevision != notesRevision) {
+        QVector<WalletTransaction> transactions = store.getTransactions(account);
+        std::reverse(transactions.begin(), transactions.end());
+        buildIndex(idx, transactions, notes);
+        idx.storeRevision = storeRevision;
+        idx.notesRevision = notesRevision;
+    }
+    return idx;
+}
+
+// static
+void HistorySearch::buildIndex( AccountIndex & idx, const QVector<WalletTransaction> & transactions, const NoteLookup & notes ) {
+    const int rowNum = transactions.size();
+    idx.transactions = transactions;
+    idx.types.resize(rowNum);
+    idx.amounts.resize(rowNum);
+    idx.heights.resize(rowNum);
+    idx.creationTimes.resize(rowNum);
+    idx.texts.resize(rowNum);
+    idx.addresses.clear();
+    idx.uuids.clear();
+    idx.kernels.clear();
+
+    for (int r=0; r<rowNum; r++) {
+        const WalletTransaction & tx = transactions[r];
+        idx.types[r] = tx.transactionType;
+        idx.amounts[r] = tx.coinNano < 0 ? -tx.coinNano : tx.coinNano;
+        idx.heights[r] = tx.height;
+
+        QDateTime time = QDateTime::fromString(tx.creationTime, mwc::DATETIME_TEMPLATE_THIS);
+        idx.creationTimes[r] = time.isValid() ? time.toMSecsSinceEpoch() : -1;
+
+        const QString address = tx.address.toLower();
+        const QString uuid = tx.txid.toLower();
+        const QString kernel = tx.kernel.toLower();
+        QString note;
+        if (notes && !tx.txid.isEmpty())
+            note = notes(tx.txid).toLower();
+        idx.texts[r] = uuid + "\n" + address + "\n" + kernel + "\n" + note;
+
+        if (!address.isEmpty())
+            idx.addresses.push_back(QPair<QString, int>(address, r));
+        if (!uuid.isEmpty())
+            idx.uuids.push_back(QPair<QString, int>(uuid, r));
+        if (!kernel.isEmpty())
+            idx.kernels.push_back(QPair<QString, int>(kernel, r));
+    }
+
+    std::sort(idx.addresses.begin(), idx.addresses.end());
+    std::sort(idx.uuids.begin(), idx.uuids.end());
+    std::sort(idx.kernels.begin(), idx.kernels.end());
+}
+
+// static
+bool HistorySearch::matchPrefix( const PrefixIndex & index, const QString & prefix, QVector<bool> & rows ) {
+    const QString pref = prefix.trimmed().toLower();
+    if (pref.isEmpty())
+        return false;
+
+    auto it = std::lower_bound( index.begin(), index.end(), pref,
+                                [](const QPair<QString, int> & item, const QString & value) {return item.first < value;} );
+    for ( ; it != index.end() && it->first.startsWith(pref); it++)
+        rows[it->second] = true;
+    return true;
+}
+
+}
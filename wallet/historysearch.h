@@ -0,0 +1,72 @@
+// Copyright 2019 The MWC Developers
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MWC_QT_WALLET_HISTORYSEARCH_H
+#define MWC_QT_WALLET_HISTORYSEARCH_H
+
+#include <QString>
+#include <QVector>
+#include <QHash>
+#include <QPair>
+#include <functional>
+#include "wallet.h"
+
+namespace wallet {
+
+class HistoryStore;
+
+// Search indexes over the transactions of HistoryStore. Indexes are built per account at the first
+// query and rebuilt when the account transactions or the notes revision is changed. Outputs and
+// the new blocks don't touch them.
+//   Range filters are checked over the column arrays, prefixes are found with binary search over
+//   sorted values. Text is matched against prebuilt lower case blob of every transaction.
+class HistorySearch {
+public:
+    // Note for the transaction UUID
+    typedef std::function<QString(const QString & txid)> NoteLookup;
+
+    HistoryQueryResult search( const HistoryStore & store, const HistoryQuery & query,
+                               const NoteLookup & notes, int notesRevision );
+    void clear() {accounts.clear();}
+
+private:
+    typedef QVector<QPair<QString, int>> PrefixIndex; // sorted lower case value -> row
+
+    struct AccountIndex {
+        int storeRevision = -1;
+        int notesRevision = -1;
+        QVector<WalletTransaction> transactions; // Row order: newest (highest txIdx) first
+        QVector<uint>    types;
+        QVector<int64_t> amounts;      // absolute coinNano
+        QVector<int64_t> heights;
+        QVector<int64_t> creationTimes; // msecs since epoch, -1 if unknown
+        QVector<QString> texts;
+        PrefixIndex addresses;
+        PrefixIndex uuids;
+        PrefixIndex kernels;
+    };
+
+    const AccountIndex & getIndex( const HistoryStore & store, const QString & account,
+                                   const NoteLookup & notes, int notesRevision );
+    static void buildIndex( AccountIndex & idx, const QVector<WalletTransaction> & transactions, const NoteLookup & notes );
+    // Mark rows that has value with the prefix. Return false if prefix is empty, rows are not touched then.
+    static bool matchPrefix( const PrefixIndex & index, const QString & prefix, QVector<bool> & rows );
+
+private:
+    QHash<QString, AccountIndex> accounts;
+};
+
+}
+
+#endif //MWC_QT_WALLET_HISTORYSEARCH_H
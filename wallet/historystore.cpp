@@ -0,0 +1,898 @@
+// Copyright 2019 The MWC Developers
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "historystore.h"
+#include <QDataStream>
+#include <QSet>
+#include <QUuid>
+#include <QtEndian>
+#include <algorithm>
+#include <cstring>
+#include "../util/ioutils.h"
+#include "../util/crypto.h"
+#include "../util/Log.h"
+
+namespace wallet {
+
+// Files format. Increase the version if format is changed, old store will be dropped and filled again.
+static const quint32 HISTORY_LOG_ID  = 0x5A71D0;
+static const quint32 HISTORY_IDX_ID  = 0x5A71D1;
+static const quint32 HISTORY_VERSION = 4;
+static const quint32 RECORD_MAGIC    = 0xC0DE5A71;
+
+static const int    SALT_SIZE          = 16;
+static const int    KEY_CHECK_SIZE     = 16;
+static const qint64 LOG_HEADER_SIZE    = 8 + SALT_SIZE + KEY_CHECK_SIZE; // id, version, salt, key check
+static const qint64 IDX_HEADER_SIZE    = 8 + SALT_SIZE; // id, version, salt
+static const qint64 RECORD_HEADER_SIZE = 12; // magic, type, size
+static const qint64 RECORD_MAC_SIZE    = 16; // after the encrypted data
+
+static const int KEY_ITERATIONS = 20000;
+
+static const quint32 TX_FINAL = 0x1; // confirmed or cancelled transaction
+
+// Compaction happens at open if dead records are more than live ones
+static const int COMPACT_MIN_DEAD_RECORDS = 10000;
+
+// tail - salt and key check
+static bool writeHeader(QFile & file, quint32 id, const QByteArray & tail) {
+    const quint32 header[2] = {id, HISTORY_VERSION};
+    return file.resize(0) && file.seek(0) &&
+           file.write( reinterpret_cast<const char *>(header), sizeof(header) ) == sizeof(header) &&
+           file.write(tail) == tail.size();
+}
+
+static bool readHeader(QFile & file, quint32 id, int tailSize, QByteArray & tail) {
+    quint32 header[2] = {0,0};
+    if ( !file.seek(0) || file.read( reinterpret_cast<char *>(header), sizeof(header) ) != sizeof(header) ||
+            header[0] != id || header[1] != HISTORY_VERSION )
+        return false;
+    tail = file.read(tailSize);
+    return tail.size() == tailSize;
+}
+
+// Encrypt-then-MAC. record - header and encrypted data, offset binds it to the place at the log.
+static QByteArray recordMac(const QByteArray & macKey, qint64 offset, const QByteArray & record) {
+    uchar pos[8];
+    qToLittleEndian(quint64(offset), pos);
+    return crypto::hmacSHA256(macKey, QByteArray( reinterpret_cast<const char *>(pos), sizeof(pos) ) + record).left(RECORD_MAC_SIZE);
+}
+
+static qint64 recordEnd(qint64 offset, qint64 size) {
+    return offset + RECORD_HEADER_SIZE + size + RECORD_MAC_SIZE;
+}
+
+HistoryStore::HistoryStore(const QString & _storeDir) : storeDir(_storeDir) {}
+
+HistoryStore::~HistoryStore() {
+    close();
+}
+
+// static
+QString HistoryStore::getBaseName(const QString & storeDir, const QString & dataPath) {
+    if (dataPath.isEmpty())
+        return "";
+    QString dir = storeDir;
+    if (dir.isEmpty()) {
+        QPair<bool,QString> contextPath = ioutils::getAppDataPath("context");
+        if (!contextPath.first)
+            return "";
+        dir = contextPath.second;
+    }
+
+    // Data path might contain any symbols, using hash for the file name
+    return dir + "/history_" + crypto::calcHSA256Hash(dataPath).left(16);
+}
+
+// static
+QByteArray HistoryStore::deriveKey(const QString & password, const QString & dataPath) {
+    return crypto::pbkdf2SHA256( password.toUtf8(), "mwc-qt-wallet history " + dataPath.toUtf8(), KEY_ITERATIONS );
+}
+
+quint64 HistoryStore::hash64(const QString & str) const {
+    return hash64(str.toUtf8());
+}
+
+quint64 HistoryStore::hash64(const QByteArray & data) const {
+    return qFromLittleEndian<quint64>( reinterpret_cast<const uchar *>( crypto::hmacSHA256(indexKey, data).constData() ) );
+}
+
+QByteArray HistoryStore::getKeyCheck(const QByteArray & _salt) const {
+    return crypto::hmacSHA256(key, "check" + _salt).left(KEY_CHECK_SIZE);
+}
+
+QByteArray HistoryStore::getStreamKey(const QByteArray & _salt) const {
+    return crypto::hmacSHA256(key, "log" + _salt);
+}
+
+QByteArray HistoryStore::getMacKey(const QByteArray & _salt) const {
+    return crypto::hmacSHA256(key, "mac" + _salt);
+}
+
+void HistoryStore::setSalt(const QByteArray & _salt) {
+    salt = _salt;
+    streamKey = getStreamKey(salt);
+    macKey = getMacKey(salt);
+    indexKey = crypto::hmacSHA256(key, "index" + salt);
+}
+
+bool HistoryStore::writeLogHeader(QFile & file, const QByteArray & _salt) const {
+    return writeHeader(file, HISTORY_LOG_ID, _salt + getKeyCheck(_salt));
+}
+
+// Read the log salt. Return false if the log is not compatible or written with another key.
+bool HistoryStore::checkLogHeader() {
+    QByteArray tail;
+    if ( logFile.size() < LOG_HEADER_SIZE || !readHeader(logFile, HISTORY_LOG_ID, SALT_SIZE + KEY_CHECK_SIZE, tail) )
+        return false;
+    const QByteArray logSalt = tail.left(SALT_SIZE);
+    if (tail.mid(SALT_SIZE) != getKeyCheck(logSalt)) {
+        logger::logInfo("HistoryStore", "Key is changed for " + logFile.fileName());
+        return false;
+    }
+    setSalt(logSalt);
+    return true;
+}
+
+// static
+void HistoryStore::cryptRecord(const QByteArray & _streamKey, qint64 offset, QByteArray & data) {
+    uchar nonce[8];
+    qToLittleEndian(quint64(offset), nonce);
+    crypto::xorKeyStream(_streamKey, QByteArray( reinterpret_cast<const char *>(nonce), sizeof(nonce) ), data.data(), data.size() );
+}
+
+// static
+QByteArray HistoryStore::makeRecord(const QByteArray & _streamKey, const QByteArray & _macKey, qint64 offset, quint32 type, const QByteArray & data) {
+    const quint32 header[3] = {RECORD_MAGIC, type, quint32(data.size())};
+    QByteArray encrypted = data;
+    cryptRecord(_streamKey, offset, encrypted);
+    QByteArray record = QByteArray( reinterpret_cast<const char *>(header), sizeof(header) ) + encrypted;
+    return record + recordMac(_macKey, offset, record);
+}
+
+bool HistoryStore::open(const QString & dataPath, const QByteArray & _key) {
+    close();
+
+    const QString baseName = getBaseName(storeDir, dataPath);
+    if (baseName.isEmpty() || _key.isEmpty())
+        return false;
+    key = _key;
+
+    logFile.setFileName(baseName + ".log");
+    idxFile.setFileName(baseName + ".idx");
+    if ( !logFile.open(QIODevice::ReadWrite) )
+        return false;
+    if ( !idxFile.open(QIODevice::ReadWrite) ) {
+        logFile.close();
+        return false;
+    }
+
+    bool ok = false;
+    if ( checkLogHeader() ) {
+        ok = loadIndex();
+        if (!ok) {
+            // Index is behind the log or broken. Log is the source of truth.
+            logger::logInfo("HistoryStore", "Rebuilding index for " + logFile.fileName());
+            ok = rebuildIndex();
+        }
+        if (ok && deadRecords > COMPACT_MIN_DEAD_RECORDS && deadRecords > entryCount() - deadRecords)
+            ok = compact();
+    }
+    else {
+        // New, incompatible store or another key
+        ok = resetFiles();
+    }
+
+    if (!ok) {
+        logger::logInfo("HistoryStore", "Unable to open history store at " + logFile.fileName());
+        close();
+    }
+    revision++;
+    return ok;
+}
+
+void HistoryStore::close() {
+    unmapIndex();
+    newEntries.clear();
+    accounts.clear();
+    deadRecords = 0;
+    chainHeight = -1;
+    key.clear();
+    salt.clear();
+    streamKey.clear();
+    macKey.clear();
+    indexKey.clear();
+    revision++;
+    if (logFile.isOpen())
+        logFile.close();
+    if (idxFile.isOpen())
+        idxFile.close();
+}
+
+// static
+void HistoryStore::remove(const QString & dataPath, const QString & storeDir) {
+    const QString baseName = getBaseName(storeDir, dataPath);
+    if (baseName.isEmpty())
+        return;
+    QFile::remove(baseName + ".log");
+    QFile::remove(baseName + ".idx");
+}
+
+void HistoryStore::unmapIndex() {
+    if (mapped)
+        idxFile.unmap( reinterpret_cast<uchar *>( const_cast<IndexEntry *>(mapped) ) );
+    mapped = nullptr;
+    mappedCount = 0;
+}
+
+bool HistoryStore::resetFiles() {
+    unmapIndex();
+    newEntries.clear();
+    accounts.clear();
+    deadRecords = 0;
+    setSalt( QUuid::createUuid().toRfc4122() );
+    return writeLogHeader(logFile, salt) && writeHeader(idxFile, HISTORY_IDX_ID, salt) &&
+           logFile.flush() && idxFile.flush();
+}
+
+bool HistoryStore::loadIndex() {
+    const qint64 idxSize = idxFile.size();
+    QByteArray idxSalt;
+    // Index belongs to another log if salt is different
+    if ( idxSize < IDX_HEADER_SIZE || !readHeader(idxFile, HISTORY_IDX_ID, SALT_SIZE, idxSalt) || idxSalt != salt )
+        return false;
+    if ( (idxSize - IDX_HEADER_SIZE) % qint64(sizeof(IndexEntry)) != 0 )
+        return false;
+
+    const int count = int( (idxSize - IDX_HEADER_SIZE) / qint64(sizeof(IndexEntry)) );
+    if (count == 0)
+        return logFile.size() == LOG_HEADER_SIZE;
+
+    uchar * data = idxFile.map(IDX_HEADER_SIZE, qint64(count) * qint64(sizeof(IndexEntry)) );
+    if (data == nullptr)
+        return false;
+    mapped = reinterpret_cast<const IndexEntry *>(data);
+    mappedCount = count;
+
+    // Both files are appended together, the last entry must end exactly at the log end
+    const IndexEntry & last = mapped[count-1];
+    if ( recordEnd(last.offset, last.size) != logFile.size() ) {
+        unmapIndex();
+        return false;
+    }
+
+    for (int i=0; i<count; i++)
+        applyEntry(i);
+    for (auto & acc : accounts)
+        updateFinalMark(acc);
+    return true;
+}
+
+bool HistoryStore::rebuildIndex(bool compactBrokenTail) {
+    unmapIndex();
+    newEntries.clear();
+    accounts.clear();
+    deadRecords = 0;
+
+    if (!writeHeader(idxFile, HISTORY_IDX_ID, salt))
+        return false;
+
+    const qint64 logSize = logFile.size();
+    qint64 pos = LOG_HEADER_SIZE;
+    if (!logFile.seek(pos))
+        return false;
+
+    while ( pos + RECORD_HEADER_SIZE <= logSize ) {
+        quint32 header[3] = {0,0,0};
+        if ( logFile.read( reinterpret_cast<char *>(header), sizeof(header) ) != sizeof(header) || header[0] != RECORD_MAGIC )
+            break;
+        const qint64 size = header[2];
+        if ( recordEnd(pos, size) > logSize )
+            break;
+        QByteArray data = logFile.read(size);
+        const QByteArray mac = logFile.read(RECORD_MAC_SIZE);
+        if ( data.size() != size ||
+             mac != recordMac(macKey, pos, QByteArray( reinterpret_cast<const char *>(header), sizeof(header) ) + data) )
+            break;
+        cryptRecord(streamKey, pos, data);
+
+        QDataStream in(data);
+        in.setVersion(QDataStream::Qt_5_7);
+        QString account;
+        in >> account;
+
+        IndexEntry e;
+        const RECORD_TYPE type = RECORD_TYPE(header[1]);
+        if (type == RECORD_TYPE::TRANSACTION) {
+            WalletTransaction tx;
+            if (!tx.loadData(in))
+                break;
+            e = makeTxEntry(account, tx, data);
+        }
+        else if (type == RECORD_TYPE::OUTPUT) {
+            WalletOutput out;
+            if (!out.loadData(in))
+                break;
+            e = makeOutputEntry(account, out, data);
+        }
+        else if (type == RECORD_TYPE::TRANSACTION_REMOVED || type == RECORD_TYPE::OUTPUT_REMOVED) {
+            qint64 key = -1;
+            in >> key;
+            if (in.status() != QDataStream::Ok)
+                break;
+            e = makeEntry(type, account);
+            e.key = key;
+        }
+        else
+            break;
+
+        e.offset = pos;
+        e.size = size;
+        if ( idxFile.write( reinterpret_cast<const char *>(&e), sizeof(e) ) != sizeof(e) )
+            return false;
+        newEntries.push_back(e);
+        applyEntry(newEntries.size()-1);
+
+        pos = recordEnd(pos, size);
+    }
+
+    // Broken tail is lost, it will be restored by the next listing. New records can't be written
+    // over it with the same salt, the key stream would be reused. Log is rewritten with a new salt.
+    if (pos < logSize) {
+        if (!compactBrokenTail)
+            return false;
+        logger::logInfo("HistoryStore", "Broken tail at " + logFile.fileName() + ", offset " + QString::number(pos));
+        return compact();
+    }
+
+    for (auto & acc : accounts)
+        updateFinalMark(acc);
+    return logFile.flush() && idxFile.flush();
+}
+
+// Rewrite the log with live records only
+bool HistoryStore::compact() {
+    QVector<int> live;
+    for (const auto & acc : accounts) {
+        for (int n : acc.transactions)
+            live.push_back(n);
+        for (int n : acc.outputs)
+            live.push_back(n);
+    }
+    std::sort(live.begin(), live.end());
+
+    // New log gets new salt, records are encrypted again
+    const QByteArray newSalt = QUuid::createUuid().toRfc4122();
+    const QByteArray newStreamKey = getStreamKey(newSalt);
+    const QByteArray newMacKey = getMacKey(newSalt);
+
+    const QString logName = logFile.fileName();
+    QFile newLog(logName + ".tmp");
+    if ( !newLog.open(QIODevice::ReadWrite | QIODevice::Truncate) || !writeLogHeader(newLog, newSalt) )
+        return false;
+
+    for (int n : live) {
+        const IndexEntry & e = entry(n);
+        QByteArray data;
+        if (!readRecord(e, data))
+            continue; // Broken record is dropped, the next listing restores it
+        const QByteArray record = makeRecord(newStreamKey, newMacKey, newLog.pos(), e.type, data);
+        if ( newLog.write(record) != record.size() )
+            return false;
+    }
+    newLog.close();
+
+    logger::logInfo("HistoryStore", "Compacted " + logName + ", records " + QString::number(entryCount()) + " -> " + QString::number(live.size()) );
+
+    unmapIndex();
+    logFile.close();
+    if ( !QFile::remove(logName) || !QFile::rename(newLog.fileName(), logName) )
+        return false;
+    if ( !logFile.open(QIODevice::ReadWrite) )
+        return false;
+    setSalt(newSalt);
+    return rebuildIndex(false);
+}
+
+void HistoryStore::recoverLog() {
+    logger::logInfo("HistoryStore", "Unable to append to " + logFile.fileName());
+    if (!compact()) {
+        logger::logInfo("HistoryStore", "Unable to recover " + logFile.fileName() + ", store is closed");
+        close();
+    }
+}
+
+const HistoryStore::IndexEntry & HistoryStore::entry(int n) const {
+    Q_ASSERT(n>=0 && n<entryCount());
+    return n < mappedCount ? mapped[n] : newEntries[n - mappedCount];
+}
+
+void HistoryStore::removeTxKeys(AccountIndex & acc, const IndexEntry & e) {
+    if (e.height >= 0)
+        acc.txByHeight.remove(e.height, e.key);
+    acc.txByUuid.remove(e.uuidHash, e.key);
+    if (e.kernelHash)
+        acc.txByKernel.remove(e.kernelHash, e.key);
+    if (e.addressHash)
+        acc.txByAddress.remove(e.addressHash, e.key);
+}
+
+void HistoryStore::applyEntry(int n) {
+    const IndexEntry & e = entry(n);
+    AccountIndex & acc = accounts[e.accountHash];
+    acc.txOrder.clear();
+
+    switch ( RECORD_TYPE(e.type) ) {
+        case RECORD_TYPE::TRANSACTION: {
+            acc.txRevision = ++txRevisionCounter;
+            auto it = acc.transactions.find(e.key);
+            if (it != acc.transactions.end()) {
+                removeTxKeys(acc, entry(it.value()));
+                it.value() = n;
+                deadRecords++;
+            }
+            else {
+                acc.transactions.insert(e.key, n);
+            }
+            if (e.height >= 0)
+                acc.txByHeight.insert(e.height, e.key);
+            acc.txByUuid.insert(e.uuidHash, e.key);
+            if (e.kernelHash)
+                acc.txByKernel.insert(e.kernelHash, e.key);
+            if (e.addressHash)
+                acc.txByAddress.insert(e.addressHash, e.key);
+            acc.maxHeight = qMax(acc.maxHeight, int64_t(e.height));
+            break;
+        }
+        case RECORD_TYPE::TRANSACTION_REMOVED: {
+            acc.txRevision = ++txRevisionCounter;
+            auto it = acc.transactions.find(e.key);
+            if (it != acc.transactions.end()) {
+                removeTxKeys(acc, entry(it.value()));
+                acc.transactions.erase(it);
+                deadRecords++;
+            }
+            deadRecords++; // tombstone itself
+            break;
+        }
+        case RECORD_TYPE::OUTPUT: {
+            auto it = acc.outputs.find(e.key);
+            if (it != acc.outputs.end()) {
+                acc.outputsByTx.remove(entry(it.value()).ref, e.key);
+                it.value() = n;
+                deadRecords++;
+            }
+            else {
+                acc.outputs.insert(e.key, n);
+            }
+            if (e.ref >= 0)
+                acc.outputsByTx.insert(e.ref, e.key);
+            acc.maxHeight = qMax(acc.maxHeight, int64_t(e.height));
+            break;
+        }
+        case RECORD_TYPE::OUTPUT_REMOVED: {
+            auto it = acc.outputs.find(e.key);
+            if (it != acc.outputs.end()) {
+                acc.outputsByTx.remove(entry(it.value()).ref, e.key);
+                acc.outputs.erase(it);
+                deadRecords++;
+            }
+            deadRecords++;
+            break;
+        }
+    }
+}
+
+void HistoryStore::updateFinalMark(AccountIndex & acc) {
+    acc.finalTxIdxMark = -1;
+    for (auto it = acc.transactions.constBegin(); it != acc.transactions.constEnd(); it++) {
+        if ( (entry(it.value()).flags & TX_FINAL) == 0 )
+            break;
+        acc.finalTxIdxMark = it.key();
+    }
+}
+
+int HistoryStore::append(const IndexEntry & e, const QByteArray & data) {
+    if (!isOpen())
+        return -1;
+
+    IndexEntry ne = e;
+    ne.offset = logFile.size();
+    ne.size = data.size();
+
+    const QByteArray record = makeRecord(streamKey, macKey, ne.offset, ne.type, data);
+    if ( !logFile.seek(ne.offset) || logFile.write(record) != record.size() ||
+         !idxFile.seek(idxFile.size()) ||
+         idxFile.write( reinterpret_cast<const char *>(&ne), sizeof(ne) ) != sizeof(ne) ) {
+        // Partial record can't be simply truncated, the next one would reuse the key stream at this offset
+        recoverLog();
+        return -1;
+    }
+
+    newEntries.push_back(ne);
+    revision++;
+    return entryCount()-1;
+}
+
+bool HistoryStore::readRecord(const IndexEntry & e, QByteArray & data) const {
+    if ( !logFile.seek(e.offset) )
+        return false;
+    const qint64 recordSize = RECORD_HEADER_SIZE + e.size;
+    const QByteArray record = logFile.read(recordSize + RECORD_MAC_SIZE);
+    if ( record.size() != recordSize + RECORD_MAC_SIZE ||
+         record.mid(int(recordSize)) != recordMac(macKey, e.offset, record.left(int(recordSize))) ) {
+        logger::logInfo("HistoryStore", "Broken record at " + logFile.fileName() + ", offset " + QString::number(e.offset));
+        return false;
+    }
+    data = record.mid(int(RECORD_HEADER_SIZE), int(e.size));
+    cryptRecord(streamKey, e.offset, data);
+    return true;
+}
+
+bool HistoryStore::readTransaction(int n, const QString & account, WalletTransaction & tx) const {
+    QByteArray data;
+    if (!readRecord(entry(n), data))
+        return false;
+    QDataStream in(data);
+    in.setVersion(QDataStream::Qt_5_7);
+    QString acc;
+    in >> acc;
+    return acc == account && tx.loadData(in);
+}
+
+bool HistoryStore::readOutput(int n, const QString & account, WalletOutput & output) const {
+    QByteArray data;
+    if (!readRecord(entry(n), data))
+        return false;
+    QDataStream in(data);
+    in.setVersion(QDataStream::Qt_5_7);
+    QString acc;
+    in >> acc;
+    if (acc != account || !output.loadData(in))
+        return false;
+
+    // The same as mwc713 calculates them
+    if (output.status == WalletOutput::STATUS::UNCONFIRMED)
+        output.numOfConfirms = 0;
+    else if (chainHeight >= 0 && output.blockHeight > 0)
+        output.numOfConfirms = qMax( int64_t(0), chainHeight - output.blockHeight + 1 );
+    return true;
+}
+
+HistoryStore::IndexEntry HistoryStore::makeEntry(RECORD_TYPE type, const QString & account) const {
+    IndexEntry e;
+    memset(&e, 0, sizeof(e));
+    e.type = quint32(type);
+    e.accountHash = hash64(account);
+    e.key = -1;
+    e.ref = -1;
+    e.height = -1;
+    return e;
+}
+
+HistoryStore::IndexEntry HistoryStore::makeTxEntry(const QString & account, const WalletTransaction & tx, const QByteArray & data) const {
+    IndexEntry e = makeEntry(RECORD_TYPE::TRANSACTION, account);
+    e.key = tx.txIdx;
+    e.height = tx.height > 0 ? tx.height : -1;
+    if ( tx.confirmed || (tx.transactionType & WalletTransaction::TRANSACTION_TYPE::CANCELLED) )
+        e.flags |= TX_FINAL;
+    e.uuidHash = hash64(tx.txid);
+    e.kernelHash = tx.kernel.isEmpty() ? 0 : hash64(tx.kernel);
+    e.addressHash = tx.address.isEmpty() ? 0 : hash64(tx.address);
+    e.dataHash = hash64(data);
+    return e;
+}
+
+HistoryStore::IndexEntry HistoryStore::makeOutputEntry(const QString & account, const WalletOutput & output, const QByteArray & data) const {
+    IndexEntry e = makeEntry(RECORD_TYPE::OUTPUT, account);
+    e.key = qint64( hash64(output.getOutputCommitment()) );
+    e.ref = output.txIdx;
+    e.height = output.blockHeight;
+    e.flags = quint32(output.status);
+    e.dataHash = hash64(data);
+    return e;
+}
+
+// static
+QByteArray HistoryStore::serialize(const QString & account, const WalletTransaction * tx, const WalletOutput * output) {
+    QByteArray data;
+    QDataStream out(&data, QIODevice::WriteOnly);
+    out.setVersion(QDataStream::Qt_5_7);
+    out << account;
+    if (tx)
+        tx->saveData(out);
+    if (output) {
+        // Confirmations are changing with every block, they are derived at read
+        WalletOutput stored = *output;
+        stored.numOfConfirms = -1;
+        stored.saveData(out);
+    }
+    return data;
+}
+
+// static
+QByteArray HistoryStore::serializeRemoved(const QString & account, qint64 key) {
+    QByteArray data;
+    QDataStream out(&data, QIODevice::WriteOnly);
+    out.setVersion(QDataStream::Qt_5_7);
+    out << account;
+    out << key;
+    return data;
+}
+
+int HistoryStore::updateTransactions(const QString & account, const QVector<WalletTransaction> & transactions) {
+    if (!isOpen())
+        return 0;
+
+    AccountIndex & acc = accounts[hash64(account)];
+    int appended = 0;
+
+    QSet<int64_t> listed;
+    listed.reserve(transactions.size());
+    for (const auto & tx : transactions) {
+        listed.insert(tx.txIdx);
+
+        auto it = acc.transactions.constFind(tx.txIdx);
+        // Final transactions under the high-water mark don't change, no need to compare them
+        if (it != acc.transactions.constEnd() && tx.txIdx <= acc.finalTxIdxMark)
+            continue;
+
+        const QByteArray data = serialize(account, &tx, nullptr);
+        const IndexEntry e = makeTxEntry(account, tx, data);
+        if (it != acc.transactions.constEnd() && entry(it.value()).dataHash == e.dataHash)
+            continue;
+
+        const int n = append(e, data);
+        if (n<0)
+            return appended;
+        applyEntry(n);
+        appended++;
+    }
+
+    QVector<int64_t> removed;
+    for (auto it = acc.transactions.constBegin(); it != acc.transactions.constEnd(); it++) {
+        if (!listed.contains(it.key()))
+            removed.push_back(it.key());
+    }
+    for (int64_t txIdx : removed) {
+        IndexEntry e = makeEntry(RECORD_TYPE::TRANSACTION_REMOVED, account);
+        e.key = txIdx;
+        const int n = append(e, serializeRemoved(account, txIdx));
+        if (n<0)
+            return appended;
+        applyEntry(n);
+        appended++;
+    }
+
+    if (appended>0) {
+        updateFinalMark(acc);
+        logFile.flush();
+        idxFile.flush();
+    }
+    return appended;
+}
+
+int HistoryStore::updateOutputs(const QString & account, const QVector<WalletOutput> & outputs, bool showSpent, int64_t height) {
+    if (!isOpen())
+        return 0;
+
+    chainHeight = qMax(chainHeight, height);
+
+    AccountIndex & acc = accounts[hash64(account)];
+    int appended = 0;
+
+    QSet<qint64> listed;
+    listed.reserve(outputs.size());
+    for (const auto & out : outputs) {
+        const QByteArray data = serialize(account, nullptr, &out);
+        const IndexEntry e = makeOutputEntry(account, out, data);
+        listed.insert(e.key);
+
+        auto it = acc.outputs.constFind(e.key);
+        if (it != acc.outputs.constEnd() && entry(it.value()).dataHash == e.dataHash)
+            continue;
+
+        const int n = append(e, data);
+        if (n<0)
+            return appended;
+        applyEntry(n);
+        appended++;
+    }
+
+    QVector<qint64> removed;
+    for (auto it = acc.outputs.constBegin(); it != acc.outputs.constEnd(); it++) {
+        if ( listed.contains(it.key()) )
+            continue;
+        // Spent outputs are not listed without showSpent
+        if ( showSpent || entry(it.value()).flags != quint32(WalletOutput::STATUS::SPENT) )
+            removed.push_back(it.key());
+    }
+    for (qint64 key : removed) {
+        IndexEntry e = makeEntry(RECORD_TYPE::OUTPUT_REMOVED, account);
+        e.key = key;
+        const int n = append(e, serializeRemoved(account, key));
+        if (n<0)
+            return appended;
+        applyEntry(n);
+        appended++;
+    }
+
+    if (appended>0) {
+        logFile.flush();
+        idxFile.flush();
+    }
+    return appended;
+}
+
+const HistoryStore::AccountIndex * HistoryStore::getAccount(const QString & account) const {
+    auto it = accounts.constFind(hash64(account));
+    return it == accounts.constEnd() ? nullptr : &it.value();
+}
+
+int HistoryStore::getTransactionsRevision(const QString & account) const {
+    const AccountIndex * acc = getAccount(account);
+    return acc==nullptr ? 0 : acc->txRevision;
+}
+
+int64_t HistoryStore::getMaxTxIdx(const QString & account) const {
+    const AccountIndex * acc = getAccount(account);
+    return (acc==nullptr || acc->transactions.isEmpty()) ? -1 : acc->transactions.lastKey();
+}
+
+int64_t HistoryStore::getMaxHeight(const QString & account) const {
+    const AccountIndex * acc = getAccount(account);
+    return acc==nullptr ? -1 : acc->maxHeight;
+}
+
+int HistoryStore::getTransactionsCount(const QString & account) const {
+    const AccountIndex * acc = getAccount(account);
+    return acc==nullptr ? 0 : acc->transactions.size();
+}
+
+QVector<WalletTransaction> HistoryStore::getTransactionsPage(const QString & account, int offset, int count) const {
+    QVector<WalletTransaction> res;
+    const AccountIndex * acc = getAccount(account);
+    if (acc==nullptr || offset<0 || count<=0)
+        return res;
+
+    if (acc->txOrder.isEmpty())
+        acc->txOrder = QVector<int64_t>::fromList( acc->transactions.keys() );
+
+    const int sz = acc->txOrder.size();
+    for (int i=offset; i<sz && i<offset+count; i++) {
+        WalletTransaction tx;
+        if ( readTransaction( acc->transactions.value( acc->txOrder[sz-1-i] ), account, tx ) )
+            res.push_back(tx);
+    }
+    return res;
+}
+
+QVector<WalletTransaction> HistoryStore::getTransactions(const QString & account) const {
+    QVector<WalletTransaction> res;
+    const AccountIndex * acc = getAccount(account);
+    if (acc==nullptr)
+        return res;
+
+    res.reserve(acc->transactions.size());
+    for (int n : acc->transactions) {
+        WalletTransaction tx;
+        if (readTransaction(n, account, tx))
+            res.push_back(tx);
+    }
+    return res;
+}
+
+bool HistoryStore::getTransaction(const QString & account, int64_t txIdx, WalletTransaction & tx) const {
+    const AccountIndex * acc = getAccount(account);
+    if (acc==nullptr)
+        return false;
+    auto it = acc->transactions.constFind(txIdx);
+    return it != acc->transactions.constEnd() && readTransaction(it.value(), account, tx);
+}
+
+bool HistoryStore::findTransactionByUuid(const QString & account, const QString & uuid, WalletTransaction & tx) const {
+    const AccountIndex * acc = getAccount(account);
+    if (acc==nullptr)
+        return false;
+    // Hash might collide, checking the record
+    for (int64_t txIdx : acc->txByUuid.values(hash64(uuid))) {
+        if (getTransaction(account, txIdx, tx) && tx.txid == uuid)
+            return true;
+    }
+    return false;
+}
+
+bool HistoryStore::findTransactionByKernel(const QString & account, const QString & kernel, WalletTransaction & tx) const {
+    const AccountIndex * acc = getAccount(account);
+    if (acc==nullptr || kernel.isEmpty())
+        return false;
+    for (int64_t txIdx : acc->txByKernel.values(hash64(kernel))) {
+        if (getTransaction(account, txIdx, tx) && tx.kernel == kernel)
+            return true;
+    }
+    return false;
+}
+
+QVector<WalletTransaction> HistoryStore::findTransactionsByAddress(const QString & account, const QString & address) const {
+    QVector<WalletTransaction> res;
+    const AccountIndex * acc = getAccount(account);
+    if (acc==nullptr || address.isEmpty())
+        return res;
+
+    QList<int64_t> txs = acc->txByAddress.values(hash64(address));
+    std::sort(txs.begin(), txs.end());
+    for (int64_t txIdx : txs) {
+        WalletTransaction tx;
+        if (getTransaction(account, txIdx, tx) && tx.address == address)
+            res.push_back(tx);
+    }
+    return res;
+}
+
+QVector<WalletTransaction> HistoryStore::getTransactionsByHeight(const QString & account, int64_t fromHeight, int64_t toHeight) const {
+    QVector<WalletTransaction> res;
+    const AccountIndex * acc = getAccount(account);
+    if (acc==nullptr)
+        return res;
+
+    for (auto it = acc->txByHeight.lowerBound(fromHeight); it != acc->txByHeight.constEnd() && it.key() <= toHeight; it++) {
+        WalletTransaction tx;
+        if (getTransaction(account, it.value(), tx))
+            res.push_back(tx);
+    }
+    return res;
+}
+
+QVector<WalletOutput> HistoryStore::getOutputs(const QString & account) const {
+    QVector<WalletOutput> res;
+    const AccountIndex * acc = getAccount(account);
+    if (acc==nullptr)
+        return res;
+
+    res.reserve(acc->outputs.size());
+    for (int n : acc->outputs) {
+        WalletOutput out;
+        if (readOutput(n, account, out))
+            res.push_back(out);
+    }
+    // The same order as mwc713 lists them
+    std::sort(res.begin(), res.end(), [](const WalletOutput & o1, const WalletOutput & o2) {return o1.mmrIndex < o2.mmrIndex;} );
+    return res;
+}
+
+bool HistoryStore::getOutput(const QString & account, const QString & commitment, WalletOutput & output) const {
+    const AccountIndex * acc = getAccount(account);
+    if (acc==nullptr)
+        return false;
+    auto it = acc->outputs.constFind( qint64(hash64(commitment)) );
+    return it != acc->outputs.constEnd() && readOutput(it.value(), account, output) &&
+           output.getOutputCommitment() == commitment;
+}
+
+QVector<WalletOutput> HistoryStore::getTransactionOutputs(const QString & account, int64_t txIdx) const {
+    QVector<WalletOutput> res;
+    const AccountIndex * acc = getAccount(account);
+    if (acc==nullptr)
+        return res;
+
+    for (qint64 key : acc->outputsByTx.values(txIdx)) {
+        WalletOutput out;
+        auto it = acc->outputs.constFind(key);
+        if (it != acc->outputs.constEnd() && readOutput(it.value(), account, out))
+            res.push_back(out);
+    }
+    return res;
+}
+
+}
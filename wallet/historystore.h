@@ -0,0 +1,189 @@
+// Copyright 2019 The MWC Developers
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MWC_QT_WALLET_HISTORYSTORE_H
+#define MWC_QT_WALLET_HISTORYSTORE_H
+
+#include <QString>
+#include <QVector>
+#include <QMap>
+#include <QHash>
+#include <QMultiHash>
+#include <QMultiMap>
+#include <QFile>
+#include "wallet.h"
+
+namespace wallet {
+
+// Local copy of the wallet history: transactions and outputs by account. Lookups, pages and ranges
+// are served from here, mwc713 is not involved.
+// Data is stored per wallet data path into the app context directory:
+//   history_<hash>.log - append-only records. The newer record for the same key replaces the older one.
+//                        Records are encrypted with the key from the wallet password and have a MAC.
+//   history_<hash>.idx - fixed size entry for every log record. It is memory mapped at open, so the
+//                        in-memory indexes are built without reading the log. Strings are keyed hashes.
+// The store is fed with full 'txs'/'outputs' listings. Only new and changed entries are appended.
+// Output confirmations are not stored, they are derived from the chain height on read.
+// Not thread safe, it is used from the wallet thread only.
+class HistoryStore {
+public:
+    // storeDir - directory for the store files, app context directory if empty
+    explicit HistoryStore(const QString & storeDir = "");
+    ~HistoryStore();
+
+    // Key for open(), it is slow by design. Call it once per login.
+    static QByteArray deriveKey(const QString & password, const QString & dataPath);
+
+    // Open the store for the wallet data path. Return false if files can't be opened, store stays closed then.
+    // If the store was written with another key, it is dropped and filled again.
+    bool open(const QString & dataPath, const QByteArray & key);
+    void close();
+    bool isOpen() const {return logFile.isOpen();}
+    // Incremented on every data change, so users can cache derived data
+    int getRevision() const {return revision;}
+    // Changed only when transactions of the account are changed. 0 if account has no data.
+    int getTransactionsRevision(const QString & account) const;
+
+    // Delete store files for the data path. Store for this path must be closed.
+    static void remove(const QString & dataPath, const QString & storeDir = "");
+
+    // Reconcile the store with the full listing of the account. Return number of appended records.
+    int updateTransactions(const QString & account, const QVector<WalletTransaction> & transactions);
+    // showSpent - listing includes spent outputs. Otherwise missing spent outputs are kept.
+    // height - chain height of the listing, read outputs get confirmations from it.
+    int updateOutputs(const QString & account, const QVector<WalletOutput> & outputs, bool showSpent, int64_t height);
+
+    // High-water marks of the stored data, -1 if nothing is stored
+    int64_t getMaxTxIdx(const QString & account) const;
+    int64_t getMaxHeight(const QString & account) const;
+
+    int getTransactionsCount(const QString & account) const;
+    // Page of transactions, newest (highest txIdx) first
+    QVector<WalletTransaction> getTransactionsPage(const QString & account, int offset, int count) const;
+    // All transactions in txIdx order
+    QVector<WalletTransaction> getTransactions(const QString & account) const;
+    bool getTransaction(const QString & account, int64_t txIdx, WalletTransaction & tx) const;
+    bool findTransactionByUuid(const QString & account, const QString & uuid, WalletTransaction & tx) const;
+    bool findTransactionByKernel(const QString & account, const QString & kernel, WalletTransaction & tx) const;
+    QVector<WalletTransaction> findTransactionsByAddress(const QString & account, const QString & address) const;
+    // Transactions with height in [fromHeight, toHeight], in height order
+    QVector<WalletTransaction> getTransactionsByHeight(const QString & account, int64_t fromHeight, int64_t toHeight) const;
+
+    QVector<WalletOutput> getOutputs(const QString & account) const;
+    bool getOutput(const QString & account, const QString & commitment, WalletOutput & output) const;
+    QVector<WalletOutput> getTransactionOutputs(const QString & account, int64_t txIdx) const;
+
+private:
+    enum class RECORD_TYPE : quint32 { TRANSACTION = 1, TRANSACTION_REMOVED = 2, OUTPUT = 3, OUTPUT_REMOVED = 4 };
+
+    // On disk index entry. Strings are represented by hashes, record is read to check the match.
+    struct IndexEntry {
+        quint32 type;
+        quint32 flags;       // transaction: TX_FINAL if it can't change any more, output: STATUS
+        quint64 accountHash;
+        qint64  key;         // transaction: txIdx, output: commitment hash
+        qint64  ref;         // output: txIdx
+        qint64  height;
+        quint64 uuidHash;
+        quint64 kernelHash;
+        quint64 addressHash;
+        quint64 dataHash;    // record data hash, to detect changes
+        qint64  offset;      // record offset at the log
+        qint64  size;        // record data size
+    };
+
+    struct AccountIndex {
+        QMap<int64_t, int> transactions; // txIdx -> entry
+        QMultiMap<int64_t, int64_t> txByHeight; // height -> txIdx
+        QMultiHash<quint64, int64_t> txByUuid;
+        QMultiHash<quint64, int64_t> txByKernel;
+        QMultiHash<quint64, int64_t> txByAddress;
+        QHash<qint64, int> outputs; // commitment hash -> entry
+        QMultiHash<int64_t, qint64> outputsByTx; // txIdx -> commitment hash
+        int64_t maxHeight = -1;
+        int64_t finalTxIdxMark = -1; // All transactions up to this txIdx are final
+        int txRevision = 0;
+        mutable QVector<int64_t> txOrder; // Page cache, empty - need to rebuild
+    };
+
+    static QString getBaseName(const QString & storeDir, const QString & dataPath);
+    // HMAC with the index key. Index is not encrypted, so the hashes of the known kernels or
+    // addresses can't be computed without the key. It must be the same for every run, the index is stored.
+    quint64 hash64(const QString & str) const;
+    quint64 hash64(const QByteArray & data) const;
+
+    // Switch keys to the files salt
+    void setSalt(const QByteArray & salt);
+    QByteArray getKeyCheck(const QByteArray & salt) const;
+    QByteArray getStreamKey(const QByteArray & salt) const;
+    QByteArray getMacKey(const QByteArray & salt) const;
+    bool checkLogHeader();
+    bool writeLogHeader(QFile & file, const QByteArray & salt) const;
+    // Encrypt or decrypt the record data that is located at offset
+    static void cryptRecord(const QByteArray & streamKey, qint64 offset, QByteArray & data);
+    // Header, encrypted data and MAC of the record that is located at offset
+    static QByteArray makeRecord(const QByteArray & streamKey, const QByteArray & macKey, qint64 offset, quint32 type, const QByteArray & data);
+
+    bool loadIndex();
+    // Broken log tail is dropped by compaction if compactBrokenTail, otherwise it is an error
+    bool rebuildIndex(bool compactBrokenTail = true);
+    void unmapIndex();
+    bool resetFiles();
+    bool compact();
+    // Append failed. Log is compacted with a new salt, store is closed if that fails too.
+    void recoverLog();
+
+    const IndexEntry & entry(int n) const;
+    int  entryCount() const {return mappedCount + newEntries.size();}
+    void applyEntry(int n);
+    void removeTxKeys(AccountIndex & acc, const IndexEntry & e);
+    void updateFinalMark(AccountIndex & acc);
+
+    int  append(const IndexEntry & e, const QByteArray & data);
+    bool readRecord(const IndexEntry & e, QByteArray & data) const;
+    bool readTransaction(int n, const QString & account, WalletTransaction & tx) const;
+    bool readOutput(int n, const QString & account, WalletOutput & output) const;
+
+    IndexEntry makeEntry(RECORD_TYPE type, const QString & account) const;
+    IndexEntry makeTxEntry(const QString & account, const WalletTransaction & tx, const QByteArray & data) const;
+    IndexEntry makeOutputEntry(const QString & account, const WalletOutput & output, const QByteArray & data) const;
+    static QByteArray serialize(const QString & account, const WalletTransaction * tx, const WalletOutput * output);
+    static QByteArray serializeRemoved(const QString & account, qint64 key);
+
+    const AccountIndex * getAccount(const QString & account) const;
+
+private:
+    QString storeDir;
+    mutable QFile logFile;
+    QFile idxFile;
+    const IndexEntry * mapped = nullptr; // Index entries from the idx file
+    int mappedCount = 0;
+    QVector<IndexEntry> newEntries;     // Entries that was appended after the open
+
+    QHash<quint64, AccountIndex> accounts; // Key: account hash
+    int deadRecords = 0; // Records that was replaced or removed
+    int revision = 0;
+    int txRevisionCounter = 0; // Never reset, so account revisions are unique across reopen
+    int64_t chainHeight = -1; // For the output confirmations
+
+    QByteArray key;       // From the wallet password
+    QByteArray salt;      // Random for every new log, so the key stream is never reused
+    QByteArray streamKey; // Records encryption key for the current log
+    QByteArray macKey;    // Records MAC key for the current log
+    QByteArray indexKey;  // Index hashes key for the current log
+};
+
+}
+
+#endif //MWC_QT_WALLET_HISTORYSTORE_H
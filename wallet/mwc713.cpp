@@ -18,8 +18,12 @@
 #include <QDir>
 #include <QThread>
 #include <QTimer>
+#include <algorithm>
+#include <vector>
 #include "../tries/mwc713inputparser.h"
 #include "mwc713events.h"
+#include "mwc713reader.h"
+#include "walletcache.h"
 #include <QApplication>
 #include "core/Notification.h"
 #include "tasks/TaskStarting.h"
@@ -62,10 +66,19 @@ MWC713::MWC713(QString _mwc713path, QString _mwc713configPath, core::AppContext
     QObject::connect(appContext, &core::AppContext::onOutputLockChanged, this, &MWC713::onOutputLockChanged, Qt::QueuedConnection);
 
     defaultConfig = readWalletConfig( mwc::MWC713_DEFAULT_CONFIG );
+
+    outputReader = new Mwc713Reader(outputsLinesBufferSize);
+
+    cacheSaveTimer = new QTimer(this);
+    cacheSaveTimer->setSingleShot(true);
+    QObject::connect(cacheSaveTimer, &QTimer::timeout, this, &MWC713::saveWalletCache);
 }
 
 MWC713::~MWC713() {
     processStop(startedMode != STARTED_MODE::INIT);
+
+    delete outputReader;
+    outputReader = nullptr;
 }
 
 
@@ -191,7 +204,8 @@ void MWC713::resetData(STARTED_MODE _startedMode ) {
     httpInfo = "";
     hasHttpTls = false;
     walletPasswordHash = "";
-    outputsLines.clear();
+    historyKey.clear();
+    outputReader->clearOutputsLines();
     currentAccount = "default";
     recieveAccount = "default";
     currentConfig = WalletConfig();
@@ -240,7 +254,7 @@ void MWC713::start()  {
 
     // Start the binary
     Q_ASSERT(mwc713process == nullptr);
-    Q_ASSERT(inputParser == nullptr);
+    Q_ASSERT(eventCollector == nullptr);
 
     qDebug() << "Starting MWC713 at " << mwc713Path << " for config " << mwc713configPath;
 
@@ -249,7 +263,8 @@ void MWC713::start()  {
     if (mwc713process==nullptr)
         return;
 
-    inputParser = new tries::Mwc713InputParser();
+    tries::Mwc713InputParser * inputParser = new tries::Mwc713InputParser();
+    outputReader->attachParser(inputParser);
 
     eventCollector = new Mwc713EventManager(this);
     eventCollector->connectWith(inputParser);
@@ -270,7 +285,7 @@ void MWC713::start()  {
 void MWC713::start2init(QString password) {
     // Start the binary
     Q_ASSERT(mwc713process == nullptr);
-    Q_ASSERT(inputParser == nullptr);
+    Q_ASSERT(eventCollector == nullptr);
 
     QString path = appContext->getCurrentWalletInstance(false);
     if (!updateWalletConfig(path, false))
@@ -278,6 +293,10 @@ void MWC713::start2init(QString password) {
 
     resetData(STARTED_MODE::INIT);
 
+    // New wallet, the cached data from the previous one is not valid
+    WalletCache::remove( getWalletConfig().getDataPath() );
+    HistoryStore::remove( getWalletConfig().getDataPath() );
+
     qDebug() << "Starting MWC713 as init at " << mwc713Path << " for config " << mwc713configPath;
 
     // Creating process and starting
@@ -286,7 +305,8 @@ void MWC713::start2init(QString password) {
     if (mwc713process==nullptr)
         return;
 
-    inputParser = new tries::Mwc713InputParser();
+    tries::Mwc713InputParser * inputParser = new tries::Mwc713InputParser();
+    outputReader->attachParser(inputParser);
 
     eventCollector = new Mwc713EventManager(this);
     eventCollector->connectWith(inputParser);
@@ -299,6 +319,7 @@ void MWC713::start2init(QString password) {
     eventCollector->addTask( TASK_PRIORITY::TASK_NOW, { TSK(new TaskInit(this), TaskInit::TIMEOUT)});
 
     walletPasswordHash = crypto::calcHSA256Hash(password);
+    historyKey = HistoryStore::deriveKey(password, getWalletConfig().getDataPath());
 }
 
 // Recover the wallet with a mnemonic phrase
@@ -311,12 +332,15 @@ void MWC713::start2recover(const QVector<QString> & seed, QString password) {
 
     // Start the binary
     Q_ASSERT(mwc713process == nullptr);
-    Q_ASSERT(inputParser == nullptr);
+    Q_ASSERT(eventCollector == nullptr);
 
     QString path = appContext->getCurrentWalletInstance(false);
     if (!updateWalletConfig(path, true))
         return;
 
+    WalletCache::remove( getWalletConfig().getDataPath() );
+    HistoryStore::remove( getWalletConfig().getDataPath() );
+
     qDebug() << "Starting MWC713 as init at " << mwc713Path << " for config " << mwc713configPath;
 
     QString seedStr;
@@ -332,7 +356,8 @@ void MWC713::start2recover(const QVector<QString> & seed, QString password) {
     if (mwc713process==nullptr)
         return;
 
-    inputParser = new tries::Mwc713InputParser();
+    tries::Mwc713InputParser * inputParser = new tries::Mwc713InputParser();
+    outputReader->attachParser(inputParser);
 
     eventCollector = new Mwc713EventManager(this);
     eventCollector->connectWith(inputParser);
@@ -344,6 +369,7 @@ void MWC713::start2recover(const QVector<QString> & seed, QString password) {
     eventCollector->addListener( new TaskRecoverProgressListener(this) );
 
     walletPasswordHash = crypto::calcHSA256Hash(password);
+    historyKey = HistoryStore::deriveKey(password, getWalletConfig().getDataPath());
 }
 
 void MWC713::launchExitCommand() {
@@ -397,12 +423,31 @@ void MWC713::processStop(bool exitNicely) {
 
     mwc713disconnect();
 
+    // Last data must go to the cache before it is cleaned
+    if (cacheSaveTimer->isActive()) {
+        cacheSaveTimer->stop();
+        saveWalletCache();
+    }
+    cacheDataPath = "";
+    warmStartHeight = -1;
+    lastTransactions.clear();
+    historyStore.close();
+    historySearch.clear();
+
     // reset mwc713 interna; state
     //initStatus = InitWalletStatus::NONE;
     mwcAddress = "";
     accountInfoNoLocks.clear();
     walletOutputs.clear();
+    invalidateBalanceWithLocks();
+    accountTxCount.clear();
+    changedAccounts.clear();
+    awaitingInfoAccounts.clear();
+    fullBalanceRefresh = true;
+    balanceRefreshConfNumber = -1;
     currentAccount = "default"; // Keep current account by name. It fit better to mwc713 interactions.
+    pendingQueries.clear();
+    invalidateQueryCache();
     collectedAccountInfo.clear();
 
     emit onListenersStatus(false, false);
@@ -417,10 +462,8 @@ void MWC713::processStop(bool exitNicely) {
     emit onMwcAddressWithIndex("",1);
     emit onTorAddress("");
 
-    if (inputParser) {
-        inputParser->deleteLater();
-        inputParser = nullptr;
-    }
+    // Parser will be deleted after all pending output will be processed
+    outputReader->detachParser();
 
     if (eventCollector) {
         eventCollector->clear();
@@ -440,6 +483,7 @@ void MWC713::setStartingCommand(QString actionName) {
 void MWC713::loginWithPassword(QString password)  {
     qDebug() << "MWC713::loginWithPassword call";
     walletPasswordHash = crypto::calcHSA256Hash(password);
+    historyKey = HistoryStore::deriveKey(password, getWalletConfig().getDataPath());
     eventCollector->addTask( TASK_PRIORITY::TASK_NORMAL, { TSK(new TaskUnlock(this, password), TaskUnlock::TIMEOUT)});
 }
 
@@ -572,7 +616,7 @@ bool MWC713::hasTls() const {
 }
 
 QVector<AccountInfo>  MWC713::getWalletBalance(bool filterDeleted) const  {
-    QVector<AccountInfo> accountInfo = applyOutputLocksToBalance();
+    const QVector<AccountInfo> & accountInfo = getBalanceWithLocks();
     if (!filterDeleted)
         return accountInfo;
 
@@ -614,6 +658,10 @@ void MWC713::updateWalletBalance(bool enforceSync, bool showSyncProgress, bool s
     if ( !isWalletRunningAndLoggedIn() )
         return; // ignoring request
 
+    // Sticky until the next refresh, even if refresh is already in the queue
+    if (enforceSync)
+        fullBalanceRefresh = true;
+
     // Check if already running
     Mwc713Task * task = new TaskAccountList(this);
     if ( eventCollector->hasTask(task) ) {
@@ -625,7 +673,7 @@ void MWC713::updateWalletBalance(bool enforceSync, bool showSyncProgress, bool s
 
     // Steps:
     // 1 - list accounts (this call)
-    // 2 - for every account get info ( see updateAccountList call )
+    // 2 - for every changed account get info ( see updateAccountList call )
     // 3 - restore back current account
     if (!hasPassword()) {
         // By some reasons wallet without password can be locked by itself
@@ -815,31 +863,162 @@ void MWC713::finalizeSlatepack( QString slatepack, bool fluff, QString tag ) {
     eventCollector->addTask( TASK_PRIORITY::TASK_NORMAL, {TSK(new TaskFinalizeSlatepack(this, slatepack, fluff, tag), TaskFinalizeSlatepack::TIMEOUT)} );
 }
 
+// Keys of the outputs/transactions queries, used for coalescing and for the results cache
+static QString outputsQueryKey(const QString & account, bool showSpent) {
+    return "outputs|" + account + (showSpent ? "|spent" : "");
+}
+
+static QString transactionsQueryKey(const QString & account) {
+    return "txs|" + account;
+}
+
 // Show outputs for the wallet
-// Check Signal: onOutputs( QString account, int64_t height, QVector<WalletOutput> Transactions)
-void MWC713::getOutputs(QString account, bool show_spent, bool enforceSync)  {
+// Check Signal: onOutputs( QString account, bool showSpent, int64_t height, QVector<WalletOutput> outputs, QString cookie)
+void MWC713::getOutputs(QString account, bool show_spent, bool enforceSync, QString cookie)  {
+    QString queryKey = outputsQueryKey(account, show_spent);
+
+    // Recent result is good enough, unless the caller asks for the sync
+    auto cached = outputsCache.constFind(queryKey);
+    if ( !enforceSync && cached != outputsCache.constEnd() && QDateTime::currentMSecsSinceEpoch() - cached->time <= queryStaleWindow ) {
+        logger::logEmit( "MWC713", "onOutputs", "account="+cached->account + " from cache, cookie=" + cookie );
+        emit onOutputs( cached->account, cached->showSpent, cached->height, cached->outputs, cookie );
+        return;
+    }
+
+    if (enforceSync) {
+        // Pending query might run without the sync, so not attaching to it
+        queryKey += "|sync" + QString::number(++syncQueryCounter);
+    }
+    else {
+        // The same query is already in the task Q, attaching to it
+        auto pending = pendingQueries.find(queryKey);
+        if ( pending != pendingQueries.end() ) {
+            if (!pending->contains(cookie))
+                pending->push_back(cookie);
+            return;
+        }
+    }
+    pendingQueries.insert(queryKey, {cookie});
+
     QVector<QPair<Mwc713Task*,int64_t>> taskGroup = create_sync_if_need(true, enforceSync);
     // Need to switch account first
 
     taskGroup.push_back( TSK(new TaskAccountSwitch(this, account), TaskAccountSwitch::TIMEOUT) );
-    taskGroup.push_back( TSK(new TaskOutputs(this, show_spent), TaskOutputs::TIMEOUT ));
+    taskGroup.push_back( TSK(new TaskOutputs(this, show_spent, queryKey), TaskOutputs::TIMEOUT ));
     if (account!=currentAccount)
         taskGroup.push_back( TSK(new TaskAccountSwitch(this, currentAccount), TaskAccountSwitch::TIMEOUT) );
 
     eventCollector->addTask( TASK_PRIORITY::TASK_NORMAL, taskGroup);
 }
 
-void MWC713::getTransactions(QString account, bool enforceSync)  {
+// Local data only, mwc713 is not involved
+HistoryQueryResult MWC713::searchHistory(const HistoryQuery & query) {
+    if (!historyStore.isOpen()) {
+        HistoryQueryResult res;
+        res.error = "Local transactions history is not available. Please check the log for details.";
+        return res;
+    }
+    return historySearch.search( historyStore, query,
+                                 [this](const QString & txid) {return appContext->getNote("tx_" + txid);},
+                                 appContext->getNotesRevision() );
+}
+
+// Check Signal: onTransactions( QString account, int64_t height, QVector<WalletTransaction> Transactions, QString cookie)
+void MWC713::getTransactions(QString account, bool enforceSync, QString cookie)  {
+    QString queryKey = transactionsQueryKey(account);
+
+    // Recent result is good enough, unless the caller asks for the sync
+    auto cached = transactionsCache.constFind(queryKey);
+    if ( !enforceSync && cached != transactionsCache.constEnd() && QDateTime::currentMSecsSinceEpoch() - cached->time <= queryStaleWindow ) {
+        logger::logEmit( "MWC713", "onTransactions", "account="+cached->account + " from cache, cookie=" + cookie );
+        emit onTransactions( cached->account, cached->height, cached->transactions, cookie );
+        return;
+    }
+
+    if (enforceSync) {
+        // Pending query might run without the sync, so not attaching to it
+        queryKey += "|sync" + QString::number(++syncQueryCounter);
+    }
+    else {
+        // The same query is already in the task Q, attaching to it
+        auto pending = pendingQueries.find(queryKey);
+        if ( pending != pendingQueries.end() ) {
+            if (!pending->contains(cookie))
+                pending->push_back(cookie);
+            return;
+        }
+    }
+    pendingQueries.insert(queryKey, {cookie});
+
     QVector<QPair<Mwc713Task*,int64_t>> taskGroup = create_sync_if_need(true, enforceSync);
     // Need to switch account first
     taskGroup.push_back( TSK(new TaskAccountSwitch(this, account), TaskAccountSwitch::TIMEOUT ));
-    taskGroup.push_back( TSK(new TaskTransactions(this), TaskTransactions::TIMEOUT ));
+    taskGroup.push_back( TSK(new TaskTransactions(this, queryKey), TaskTransactions::TIMEOUT ));
     if (account!=currentAccount)
         taskGroup.push_back( TSK(new TaskAccountSwitch(this, currentAccount), TaskAccountSwitch::TIMEOUT ));
 
     eventCollector->addTask( TASK_PRIORITY::TASK_NORMAL, taskGroup);
 }
 
+// Drop cached outputs/transactions results. Call it when wallet data might be changed.
+void MWC713::invalidateQueryCache() {
+    outputsCache.clear();
+    transactionsCache.clear();
+}
+
+// Restore last known data at login. It will be shown until the first refresh
+void MWC713::restoreWalletCache() {
+    cacheDataPath = getWalletConfig().getDataPath();
+    // History is encrypted, it can't be opened without the password
+    if (!cacheDataPath.isEmpty() && !historyStore.isOpen() && !historyKey.isEmpty())
+        historyStore.open(cacheDataPath, historyKey);
+
+    if (cacheDataPath.isEmpty() || !accountInfoNoLocks.isEmpty())
+        return;
+
+    WalletCache cache;
+    if (!cache.load(cacheDataPath) || cache.isEmpty())
+        return;
+
+    // Balances only, outputs and transactions come with the first refresh
+    accountInfoNoLocks = cache.accounts;
+    invalidateBalanceWithLocks();
+    warmStartHeight = cache.height;
+
+    logger::logEmit( "MWC713", "onWalletBalanceUpdated", "origin from the warm start cache, height=" + QString::number(warmStartHeight) );
+    emit onWalletBalanceUpdated();
+}
+
+void MWC713::scheduleWalletCacheSave() {
+    if (cacheDataPath.isEmpty() || warmStartHeight>=0)
+        return; // Not logged in or data is not refreshed yet
+    if (!cacheSaveTimer->isActive())
+        cacheSaveTimer->start(3000);
+}
+
+void MWC713::saveWalletCache() {
+    if (cacheDataPath.isEmpty() || warmStartHeight>=0)
+        return;
+
+    WalletCache cache;
+    for (const auto & ai : accountInfoNoLocks)
+        cache.height = qMax(cache.height, ai.height);
+    cache.time = QDateTime::currentMSecsSinceEpoch();
+    cache.accounts = accountInfoNoLocks;
+    cache.save(cacheDataPath);
+}
+
+// Transaction was made for the account. Its balance will be refreshed next time.
+void MWC713::markAccountChanged(const QString & account) {
+    if (!account.isEmpty()) {
+        changedAccounts.insert(account);
+        return;
+    }
+    // Sending from the current account, receiving to the receive account
+    changedAccounts.insert(currentAccount);
+    changedAccounts.insert(recieveAccount);
+}
+
 // get Extended info for specific transaction
 // Check Signal: onTransactionById( bool success, QString account, int64_t height, WalletTransaction transaction, QVector<WalletOutput> outputs, QVector<QString> messages )
 void MWC713::getTransactionById(QString account, QString txIdxOrUUID ) {
@@ -1064,6 +1243,30 @@ bool MWC713::getNodeStatus() {
     return true;
 }
 
+// Task engine metrics: latency histograms by task and queue depth by priority.
+QJsonObject MWC713::getTaskMetrics() const {
+    return taskMetrics.toJson();
+}
+
+// Dump task engine metrics into the json file. Return error message or empty string on success
+QString MWC713::dumpTaskMetrics(QString fileName) const {
+    return taskMetrics.dumpToFile(fileName);
+}
+
+qint64 MWC713::getParsedBytes() const {
+    return outputReader==nullptr ? 0 : outputReader->getParsedBytes();
+}
+
+// Number of known outputs and transactions for all accounts
+int64_t MWC713::getWalletSize() const {
+    int64_t sz = 0;
+    for (const auto & outs : walletOutputs)
+        sz += outs.size();
+    for (int txs : accountTxCount)
+        sz += txs;
+    return sz;
+}
+
 // Airdrop special. Generating the next Pablic key for transaction
 // wallet713> getnextkey --amount 1000000
 // "Identifier(0300000000000000000000000600000000), PublicKey(38abad70a72fba1fab4b4d72061f220c0d2b4dafcc8144e778376098575c965f5526b57e1c34624da2dc20dde2312696e7cf8da676e33376aefcc4742ed9cb79)"
@@ -1098,6 +1301,7 @@ void MWC713::setLoginResult(bool ok) {
         const WalletConfig & config = getWalletConfig();
         switchAccount(appContext->getCurrentAccountName(config.getDataPath()));
         setReceiveAccount( appContext->getReceiveAccount(config.getDataPath()) );
+        restoreWalletCache();
     }
     loggedIn = ok;
     emit onLoginResult(ok);
@@ -1254,18 +1458,66 @@ void MWC713::setRecoveryProgress( int64_t progress, int64_t limit ) {
 // Apply account list. Exploring what does wallet has
 void MWC713::updateAccountList( QVector<QString> accounts ) {
     collectedAccountInfo.clear();
+    awaitingInfoAccounts.clear();
 
     core::SendCoinsParams params = appContext->getSendCoinsParams();
 
-    QVector<AccountInfo> accountInfo;
+    const int64_t curTime = QDateTime::currentMSecsSinceEpoch();
+    // Spendable and awaiting amounts are calculated by mwc713 with the confirmations number, all of them are outdated
+    const bool fullRefresh = fullBalanceRefresh || params.inputConfirmationNumber != balanceRefreshConfNumber ||
+                             curTime - lastFullBalanceRefresh > FULL_BALANCE_REFRESH_INTERVAL_MS;
+    balanceRefreshConfNumber = params.inputConfirmationNumber;
+    if (fullRefresh) {
+        fullBalanceRefresh = false;
+        lastFullBalanceRefresh = curTime;
+    }
+
+    // Every account info cost switch + info commands. Balance can change only for the accounts with
+    // transactions since the last refresh and for accounts that are waiting for confirmations.
+    // New blocks don't change others, they keep the last info.
+    QVector<QString> refreshAccounts;
+    for (const QString & acc : accounts) {
+        const AccountInfo * prevInfo = nullptr;
+        for (const auto & ai : accountInfoNoLocks) {
+            if (ai.accountName == acc) {
+                prevInfo = &ai;
+                break;
+            }
+        }
+
+        if (prevInfo!=nullptr) {
+            collectedAccountInfo.push_back(*prevInfo);
+        }
+        else {
+            // Placeholder to keep the accounts order
+            AccountInfo ai;
+            ai.setData(acc,0,0,0,0,0,false);
+            collectedAccountInfo.push_back(ai);
+        }
+
+        if ( fullRefresh || prevInfo==nullptr || prevInfo->isAwaitingSomething() || changedAccounts.contains(acc) ) {
+            refreshAccounts.push_back(acc);
+            awaitingInfoAccounts.insert(acc);
+        }
+    }
+    changedAccounts.clear();
+
+    // Current account goes last, so no need to switch back at the end
+    const int curAccIdx = refreshAccounts.indexOf(currentAccount);
+    if (curAccIdx>=0)
+        refreshAccounts.move(curAccIdx, refreshAccounts.size()-1);
+    lastInfoAccount = refreshAccounts.isEmpty() ? "" : refreshAccounts.back();
+
+    logger::logInfo("MWC713", "Balance refresh for " + QString::number(refreshAccounts.size()) + " of " +
+                    QString::number(accounts.size()) + " accounts" + (fullRefresh ? ", full refresh" : "") );
 
     QVector<QPair<Mwc713Task*,int64_t>> taskGroup;
 
     int idx = 0;
-    for (QString acc : accounts) {
+    for (const QString & acc : refreshAccounts) {
         taskGroup.push_back(TSK(new TaskAccountSwitch(this, acc), TaskAccountSwitch::TIMEOUT));
         taskGroup.push_back(TSK(new TaskAccountInfo(this, params.inputConfirmationNumber ), TaskAccountInfo::TIMEOUT));
-        taskGroup.push_back(TSK(new TaskAccountProgress(this, idx++, accounts.size() ), -1)); // Updating the progress
+        taskGroup.push_back(TSK(new TaskAccountProgress(this, idx++, refreshAccounts.size() ), -1)); // Updating the progress
     }
 
     taskGroup.push_back(TSK(new TaskAccountListFinal(this), -1)); // Finalize the task
@@ -1280,8 +1532,34 @@ void MWC713::updateAccountProgress(int accountIdx, int totalAccounts) {
 }
 
 void MWC713::updateAccountFinalize() {
+    invalidateQueryCache();
+
+    // Accounts without info response will be retried next time. New ones are not reported until then.
+    for (const QString & acc : awaitingInfoAccounts) {
+        changedAccounts.insert(acc);
+
+        bool known = false;
+        for (const auto & ai : accountInfoNoLocks) {
+            if (ai.accountName == acc) {
+                known = true;
+                break;
+            }
+        }
+        if (!known) {
+            for (int i=collectedAccountInfo.size()-1; i>=0; i--) {
+                if (collectedAccountInfo[i].accountName == acc)
+                    collectedAccountInfo.remove(i);
+            }
+        }
+    }
+    awaitingInfoAccounts.clear();
+
+    warmStartHeight = -1; // Balances are fresh now
+    scheduleWalletCacheSave();
+
     accountInfoNoLocks = collectedAccountInfo;
     collectedAccountInfo.clear();
+    invalidateBalanceWithLocks();
 
     QString accountBalanceStr;
 
@@ -1305,6 +1583,10 @@ void MWC713::updateAccountFinalize() {
         currentAccount = accountInfoNoLocks[0].accountName;
     }
 
+    // mwc713 is already at the current account if it was refreshed the last
+    if (lastInfoAccount == currentAccount)
+        return;
+
     // !!!!!! NOTE, 'false' mean that we don't save to that account. It make sence because during such long operation
     //  somebody could change account
     eventCollector->addTask( TASK_PRIORITY::TASK_NOW, { TSK(new TaskAccountSwitch(this, currentAccount), TaskAccountSwitch::TIMEOUT)}, 0 );
@@ -1315,6 +1597,7 @@ void MWC713::createNewAccount( QString newAccountName ) {
     AccountInfo acc;
     acc.setData(newAccountName,0,0,0,0,0,false);
     accountInfoNoLocks.push_back( acc );
+    invalidateBalanceWithLocks();
 
     logger::logEmit( "MWC713", "onAccountCreated",newAccountName);
     logger::logEmit( "MWC713", "onWalletBalanceUpdated","");
@@ -1327,14 +1610,18 @@ void MWC713::createNewAccount( QString newAccountName ) {
 
 void MWC713::updateRenameAccount(const QString & oldName, const QString & newName, bool createSimulation,
                          bool success, QString errorMessage) {
+    invalidateQueryCache();
 
     // Apply rename step, we don't want to rescan because of that.
     for (auto & ai : accountInfoNoLocks) {
         if (ai.accountName == oldName) {
             ai.accountName = newName;
             walletOutputs.insert(newName, walletOutputs.value(oldName));
+            if (accountTxCount.contains(oldName))
+                accountTxCount.insert(newName, accountTxCount.take(oldName));
         }
     }
+    invalidateBalanceWithLocks();
 
     if (createSimulation) {
         logger::logEmit( "MWC713", "onAccountCreated",newName);
@@ -1369,6 +1656,8 @@ void MWC713::infoResults( QString currentAccountName, int64_t height,
                 height,
                 mwcServerBroken);
 
+    awaitingInfoAccounts.remove(currentAccountName);
+
     int accIdx = 0;
     for ( ;accIdx<collectedAccountInfo.size(); accIdx++) {
         if (collectedAccountInfo[accIdx].accountName == currentAccountName)
@@ -1384,6 +1673,8 @@ void MWC713::infoResults( QString currentAccountName, int64_t height,
 }
 
 void MWC713::setSendResults(bool success, QStringList errors, QString address, int64_t txid, QString slate, QString mwc) {
+    invalidateQueryCache();
+    markAccountChanged();
     if (success) {
         appendNotificationMessage(notify::MESSAGE_LEVEL::INFO, QString("You successfully sent slate " + slate +
                                                                        " with " + mwc + " MWC to " + address));
@@ -1396,6 +1687,8 @@ void MWC713::setSendResults(bool success, QStringList errors, QString address, i
 
 
 void MWC713::reportSlateReceivedFrom( QString slate, QString mwc, QString fromAddr, QString message ) {
+    invalidateQueryCache();
+    markAccountChanged();
     QString msg = "Congratulations! You received " +mwc+ " MWC from " + fromAddr;
     if (!message.isEmpty()) {
         msg += " with message " + message + ".";
@@ -1428,6 +1721,8 @@ void MWC713::setSendFileResult( bool success, QStringList errors, QString fileNa
 }
 
 void MWC713::setReceiveFile( bool success, QStringList errors, QString inFileName, QString outFn ) {
+    invalidateQueryCache();
+    markAccountChanged();
     if (success) {
         appendNotificationMessage(notify::MESSAGE_LEVEL::INFO, QString("File receive transaction was processed for " + inFileName));
     }
@@ -1437,6 +1732,8 @@ void MWC713::setReceiveFile( bool success, QStringList errors, QString inFileNam
 }
 
 void MWC713::setFinalizeFile( bool success, QStringList errors, QString fileName ) {
+    invalidateQueryCache();
+    markAccountChanged();
     if (success) {
         appendNotificationMessage(notify::MESSAGE_LEVEL::INFO, QString("File finalized for " + fileName));
     }
@@ -1446,6 +1743,8 @@ void MWC713::setFinalizeFile( bool success, QStringList errors, QString fileName
 }
 
 void MWC713::setSubmitFile(bool success, QString message, QString fileName) {
+    invalidateQueryCache();
+    markAccountChanged();
     if (success) {
         appendNotificationMessage(notify::MESSAGE_LEVEL::INFO, QString("Published transaction for " + fileName));
     }
@@ -1460,18 +1759,51 @@ void MWC713::setSendSlatepack( QString error, QString slatepack, QString tag ) {
 
 }
 void MWC713::setReceiveSlatepack( QString error, QString slatepack, QString tag ) {
+    invalidateQueryCache();
+    markAccountChanged();
     logger::logEmit( "MWC713", "setReceiveSlatepack",  + " tag=" + tag + " error=" + error + " Slatepack: " + slatepack );
     emit onReceiveSlatepack(tag, error, slatepack );
 }
 
 void MWC713::setFinalizedSlatepack( QString error, QString txUuid, QString tag ) {
+    invalidateQueryCache();
+    markAccountChanged();
     logger::logEmit( "MWC713", "setFinalizedSlatepack",  + " tag=" + tag + " error=" + error + " txUuid: " + txUuid );
     emit onFinalizeSlatepack(tag, error, txUuid );
 }
 
-void MWC713::setTransactions( QString account, int64_t height, QVector<WalletTransaction> Transactions ) {
-    logger::logEmit( "MWC713", "onTransactions", "account="+account );
-    emit onTransactions( account, height, Transactions );
+void MWC713::setTransactions( QString queryKey, QString account, int64_t height, QVector<WalletTransaction> Transactions ) {
+    // Sync queries have own keys, but the result is the same for everybody
+    TransactionsQueryResult & cache = transactionsCache[transactionsQueryKey(account)];
+    cache.time = QDateTime::currentMSecsSinceEpoch();
+    cache.account = account;
+    cache.height = height;
+    cache.transactions = Transactions;
+
+    // Refresh usually changes few transactions, listeners can update just them
+    auto prevTx = lastTransactions.constFind(account);
+    if (prevTx != lastTransactions.constEnd()) {
+        TransactionsDelta delta = TransactionsDelta::calc(account, height, prevTx.value(), Transactions);
+        if (!delta.isEmpty()) {
+            logger::logEmit( "MWC713", "onTransactionsDelta", "account=" + account + " inserted=" + QString::number(delta.inserted.size()) +
+                                   " updated=" + QString::number(delta.updated.size()) + " removed=" + QString::number(delta.removed.size()) );
+            emit onTransactionsDelta(delta);
+        }
+    }
+
+    accountTxCount[account] = Transactions.size();
+    lastTransactions[account] = Transactions;
+    historyStore.updateTransactions(account, Transactions);
+    scheduleWalletCacheSave();
+
+    // Fan out the result to all requesters
+    QStringList cookies = pendingQueries.take(queryKey);
+    if (cookies.isEmpty())
+        cookies.push_back(""); // Nobody is waiting, still need to notify
+    for (const QString & cookie : cookies ) {
+        logger::logEmit( "MWC713", "onTransactions", "account=" + account + " cookie=" + cookie );
+        emit onTransactions( account, height, Transactions, cookie );
+    }
 }
 
 void MWC713::setTransactionById( bool success, QString account, int64_t height, WalletTransaction transaction, QVector<WalletOutput> outputs, QVector<QString> messages ) {
@@ -1480,10 +1812,47 @@ void MWC713::setTransactionById( bool success, QString account, int64_t height,
 }
 
 
-void MWC713::setOutputs( QString account, bool show_spent, int64_t height, QVector<WalletOutput> outputs) {
+void MWC713::setOutputs( QString queryKey, QString account, bool show_spent, int64_t height, QVector<WalletOutput> outputs) {
+    auto prevOut = walletOutputs.constFind(account);
+    if (prevOut != walletOutputs.constEnd()) {
+        QVector<WalletOutput> prev = prevOut.value();
+        if (!show_spent) {
+            // Previous listing might include spent outputs, they are not removed, just not listed this time
+            prev.erase( std::remove_if(prev.begin(), prev.end(), [](const WalletOutput & o) {return o.status == WalletOutput::STATUS::SPENT;}),
+                        prev.end() );
+        }
+        OutputsDelta delta = OutputsDelta::calc(account, height, prev, outputs);
+        if (!delta.isEmpty()) {
+            logger::logEmit( "MWC713", "onOutputsDelta", "account=" + account + " inserted=" + QString::number(delta.inserted.size()) +
+                                   " updated=" + QString::number(delta.updated.size()) + " removed=" + QString::number(delta.removed.size()) );
+            emit onOutputsDelta(delta);
+        }
+    }
+
     setWalletOutputs( account, outputs);
-    logger::logEmit( "MWC713", "onOutputs", "account="+account );
-    emit onOutputs( account, show_spent, height, outputs );
+    historyStore.updateOutputs(account, outputs, show_spent, height);
+
+    // Sync queries have own keys, but the result is the same for everybody
+    OutputsQueryResult & cache = outputsCache[outputsQueryKey(account, show_spent)];
+    cache.time = QDateTime::currentMSecsSinceEpoch();
+    cache.account = account;
+    cache.showSpent = show_spent;
+    cache.height = height;
+    cache.outputs = outputs;
+
+    // Fan out the result to all requesters
+    QStringList cookies = pendingQueries.take(queryKey);
+    if (cookies.isEmpty())
+        cookies.push_back(""); // Nobody is waiting, still need to notify
+    for (const QString & cookie : cookies ) {
+        logger::logEmit( "MWC713", "onOutputs", "account=" + account + " cookie=" + cookie );
+        emit onOutputs( account, show_spent, height, outputs, cookie );
+    }
+}
+
+void MWC713::releasePendingQuery( const QString & queryKey ) {
+    if (pendingQueries.remove(queryKey) > 0)
+        logger::logInfo("MWC713", "Query " + queryKey + " was released without the result");
 }
 
 void MWC713::setExportProofResults( bool success, QString fn, QString msg ) {
@@ -1497,6 +1866,8 @@ void MWC713::setVerifyProofResults( bool success, QString fn, QString msg ) {
 }
 
 void MWC713::setTransCancelResult( bool success, const QString & account, int64_t transId, QString errMsg ) {
+    invalidateQueryCache();
+    markAccountChanged(account);
     logger::logEmit( "MWC713", "onCancelTransacton", "success="+QString::number(success) );
     emit onCancelTransacton(success, account, transId, errMsg);
 }
@@ -1581,6 +1952,7 @@ void MWC713::updateSyncProgress(double progressPercent) {
 }
 
 void MWC713::updateSyncAsDone() {
+    invalidateQueryCache();
     lastSyncTime = QDateTime::currentMSecsSinceEpoch();
 }
 
@@ -1707,8 +2079,8 @@ void MWC713::mwc713errorOccurred(QProcess::ProcessError error) {
         QString stderrStr = mwc713process->readAllStandardError();
         logger::logInfo("MWC713", "stderr: " + stderrStr );
 
-        util::updateEventList(outputsLines, stdoutStr);
-        util::updateEventList(outputsLines, stderrStr);
+        outputReader->appendOutputsLines(stdoutStr);
+        outputReader->appendOutputsLines(stderrStr);
 
         mwc713process->deleteLater();
         mwc713process = nullptr;
@@ -1731,8 +2103,8 @@ void MWC713::mwc713finished(int exitCode, QProcess::ExitStatus exitStatus) {
         QString stderrStr = mwc713process->readAllStandardError();
         logger::logInfo("MWC713", "stderr: " + stderrStr );
 
-        util::updateEventList(outputsLines, stdoutStr);
-        util::updateEventList(outputsLines, stderrStr);
+        outputReader->appendOutputsLines(stdoutStr);
+        outputReader->appendOutputsLines(stderrStr);
 
         mwc713process->deleteLater();
         mwc713process = nullptr;
@@ -1754,6 +2126,10 @@ void MWC713::mwc713finished(int exitCode, QProcess::ExitStatus exitStatus) {
         if (QDateTime::currentMSecsSinceEpoch() - walletStartTime < 1000L * 15) {
             // Very likely that wallet wasn't be able to start. Lets update the message with mode details
 
+            // Let reader finish with pending output, we need all lines
+            outputReader->flush();
+            const QList<QString> outputsLines = outputReader->getOutputsLines();
+
             QString walletErrMsg;
             if (outputsLines.size()>0) {
                 // Check if there are erorrs or warnings...
@@ -1782,8 +2158,9 @@ void MWC713::mwc713finished(int exitCode, QProcess::ExitStatus exitStatus) {
     if (startedMode == STARTED_MODE::RECOVER) {
         // We are good, just a wrong passphrase. We need to report it correctly.
         // let's feed outputsLines to the parser
-        inputParser->processInput(outputsLines.join("\n") );
-        inputParser->processInput("\n" + mwc::PROMPTS_MWC713 + "\n");
+        outputReader->flush();
+        outputReader->processParserInput(outputReader->getOutputsLines().join("\n") );
+        outputReader->processParserInput("\n" + mwc::PROMPTS_MWC713 + "\n");
     }
     else {
         appendNotificationMessage(notify::MESSAGE_LEVEL::FATAL_ERROR,
@@ -1806,39 +2183,9 @@ void MWC713::mwc713readyReadStandardOutput() {
     if (mwc713process==nullptr)
         return;
 
-    QString str( ioutils::FilterEscSymbols( mwc713process->readAllStandardOutput() ) );
-    qDebug() << "Get output:" << str;
-    logger::logMwc713out(str);
-
-    // Let's filter out the possible prompt from the editor it can be located anywhere
-    // To filter out:  'wallet713>'
-    auto lns = str.split(QRegExp("[\r\n]"),QString::SkipEmptyParts);
-
-    QString filteredStr;
-    for (auto ln : lns) {
-        if (ln.startsWith("wallet713>"))
-            ln = ln.mid(strlen("wallet713>")).trimmed();
-
-        if (!filteredStr.isEmpty())
-            filteredStr += "\n";
-        filteredStr += ln;
-
-        if (!ln.isEmpty()) {
-            while(outputsLines.size()>outputsLinesBufferSize)
-                outputsLines.pop_front();
-
-            outputsLines.push_back(ln);
-        }
-    }
-
-    if (str.size()>0 && (str[0] == '\n' || str[0] == '\r') )
-        filteredStr = "\n" + filteredStr;
-
-    if ( str.size()>0 && (str[str.size()-1] == '\n' || str[str.size()-1] == '\r') ) {
-        filteredStr += "\n";
-    }
-
-    inputParser->processInput(filteredStr);
+    // Only draining the pipe here. Filtering, logging and parsing are done at the reader thread,
+    // events will come back through the queued connection in the same order.
+    outputReader->processStdout( mwc713process->readAllStandardOutput() );
 }
 
 /////////////////////////////////////////////////////////////////////////
@@ -2068,6 +2415,23 @@ void MWC713::onOutputLockChanged(QString commit) {
 
 }
 
+// Balance with locks applied, recalculated only if balances, outputs or lock settings were changed
+const QVector<AccountInfo> & MWC713::getBalanceWithLocks() const {
+    const bool lockEnabled = appContext->isLockOutputEnabled();
+    const int locksRevision = appContext->getLockedOutputsRevision();
+    const int confNumber = appContext->getSendCoinsParams().inputConfirmationNumber;
+
+    if ( !balanceWithLocksValid || lockEnabled != balanceLockEnabled ||
+            locksRevision != balanceLocksRevision || confNumber != balanceConfNumber ) {
+        balanceWithLocks = applyOutputLocksToBalance();
+        balanceWithLocksValid = true;
+        balanceLockEnabled = lockEnabled;
+        balanceLocksRevision = locksRevision;
+        balanceConfNumber = confNumber;
+    }
+    return balanceWithLocks;
+}
+
 // process accountInfoNoLocks, apply locked outputs
 QVector<AccountInfo> MWC713::applyOutputLocksToBalance() const {
     if (!appContext->isLockOutputEnabled())
@@ -2075,6 +2439,20 @@ QVector<AccountInfo> MWC713::applyOutputLocksToBalance() const {
 
     // Locks are enabled, need to firter all outputs...
 
+    const QSet<QString> & lockedOutputs = appContext->getLockedOutputs();
+    if (lockedOutputs.isEmpty())
+        return accountInfoNoLocks;
+
+    // Locked commits are few, outputs can be 100k+. Comparing binary commits, no strings in the loop
+    std::vector<WalletOutput::Commitment> lockedCommits;
+    lockedCommits.reserve( size_t(lockedOutputs.size()) );
+    for (const QString & lo : lockedOutputs) {
+        WalletOutput::Commitment c;
+        if (WalletOutput::hex2commitment(lo, c))
+            lockedCommits.push_back(c);
+    }
+    std::sort(lockedCommits.begin(), lockedCommits.end());
+
     QVector<AccountInfo> accountInfoWithLocks;
     int confNumber = appContext->getSendCoinsParams().inputConfirmationNumber;
 
@@ -2083,11 +2461,14 @@ QVector<AccountInfo> MWC713::applyOutputLocksToBalance() const {
         // Checking Outputs if they locked
         const QVector<wallet::WalletOutput> & accountOutputs = walletOutputs.value(ai.accountName);
         for ( const wallet::WalletOutput & out : accountOutputs ) {
-            int64_t dh = ai.height - out.blockHeight.toLongLong();
+            int64_t dh = ai.height - out.blockHeight;
             if (dh < int64_t(confNumber) )
                 continue;
 
-            if (appContext->isLockedOutputs(out.outputCommitment)) {
+            bool locked = out.commitmentText.isEmpty() ?
+                          std::binary_search(lockedCommits.begin(), lockedCommits.end(), out.commitment) :
+                          lockedOutputs.contains(out.commitmentText);
+            if (locked) {
                 ai.lockedByPrevTransaction += out.valueNano;
                 ai.currentlySpendable -= out.valueNano;
             }
@@ -2099,6 +2480,8 @@ QVector<AccountInfo> MWC713::applyOutputLocksToBalance() const {
 
 void MWC713::setWalletOutputs( const QString & account, const QVector<wallet::WalletOutput> & outputs) {
     walletOutputs[account] = outputs;
+    invalidateBalanceWithLocks();
+    scheduleWalletCacheSave();
 }
 
 
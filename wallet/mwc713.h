@@ -20,6 +20,12 @@
 #include <QProcess>
 #include "../core/global.h"
 #include <QMap>
+#include <QSet>
+#include "mwc713metrics.h"
+#include "historystore.h"
+#include "historysearch.h"
+
+class QTimer;
 
 namespace tries {
     class Mwc713InputParser;
@@ -33,6 +39,8 @@ namespace wallet {
 
 class Mwc713EventManager;
 class Mwc713Task;
+class Mwc713Reader;
+struct WalletCache;
 
 class MWC713 : public Wallet
 {
@@ -142,9 +150,16 @@ public:
     // This info needed in many cases and we don't want spend time every time for that.
     virtual QVector<AccountInfo>  getWalletBalance(bool filterDeleted = true) const  override;
 
+    // Balances, outputs and transactions can be restored from the cache at login. They are shown until
+    // the first balance refresh is done. Return the height of that restored data, -1 if data is fresh.
+    virtual int64_t getWarmStartHeight() const override {return warmStartHeight;}
+
     // Get outputs that was collected for this wallet. Outputs should be ready with balances
     virtual const QMap<QString, QVector<wallet::WalletOutput> > & getwalletOutputs() const override {return walletOutputs;}
 
+    virtual const HistoryStore & getHistoryStore() const override {return historyStore;}
+    virtual HistoryQueryResult searchHistory(const HistoryQuery & query) override;
+
     virtual QString getCurrentAccountName()  override {return currentAccount;}
 
     // Request Wallet balance update. It is a multistep operation
@@ -189,6 +204,11 @@ public:
     // Check Signal: onNodeSatatus( bool online, QString errMsg, int height, int64_t totalDifficulty, int connections )
     virtual bool getNodeStatus() override;
 
+    // Task engine metrics: latency histograms by task and queue depth by priority.
+    virtual QJsonObject getTaskMetrics() const override;
+    // Dump task engine metrics into the json file. Return error message or empty string on success
+    virtual QString dumpTaskMetrics(QString fileName) const override;
+
     // -------------- Transactions
 
     // Set account that will receive the funds
@@ -257,12 +277,14 @@ public:
                          const QStringList & outputs, bool fluff, int ttl_blocks, bool generateProof, QString expectedproofAddress )  override;
 
     // Show outputs for the wallet
-    // Check Signal: onOutputs( QString account, int64_t height, QVector<WalletOutput> outputs)
-    virtual void getOutputs(QString account, bool show_spent, bool enforceSync)  override;
+    // cookie - requester tag, it will be returned back with result. Identical requests might share the same result.
+    // Check Signal: onOutputs( QString account, bool showSpent, int64_t height, QVector<WalletOutput> outputs, QString cookie)
+    virtual void getOutputs(QString account, bool show_spent, bool enforceSync, QString cookie = "")  override;
 
     // Show all transactions for current account
-    // Check Signal: onTransactions( QString account, int64_t height, QVector<WalletTransaction> Transactions)
-    virtual void getTransactions(QString account, bool enforceSync)  override;
+    // cookie - requester tag, it will be returned back with result. Identical requests might share the same result.
+    // Check Signal: onTransactions( QString account, int64_t height, QVector<WalletTransaction> Transactions, QString cookie)
+    virtual void getTransactions(QString account, bool enforceSync, QString cookie = "")  override;
 
     // get Extended info for specific transaction
     // Check Signal: onTransactionById( bool success, QString account, int64_t height, WalletTransaction transaction, QVector<WalletOutput> outputs, QVector<QString> messages )
@@ -358,6 +380,14 @@ public:
 
     virtual bool isWalletRunningAndLoggedIn() const override { return ! (mwc713process== nullptr || eventCollector== nullptr || startedMode != STARTED_MODE::NORMAL || loggedIn==false ); }
 
+    // Default age of outputs/transactions result that still can be served from the cache
+    const static int64_t QUERY_STALE_WINDOW_MS = 1000*5;
+    // Safety net, all accounts balances are refreshed at least that often
+    const static int64_t FULL_BALANCE_REFRESH_INTERVAL_MS = 1000*60*10;
+    // Staleness window for outputs/transactions results. 0 - disable the cache
+    void setQueryStaleWindow(int64_t msec) { queryStaleWindow = msec; }
+    int64_t getQueryStaleWindow() const { return queryStaleWindow; }
+
 public:
     // stop mwc713 process nicely
     void processStop(bool exitNicely);
@@ -426,12 +456,18 @@ public:
     void setFinalizedSlatepack( QString error, QString txUuid, QString tag );
 
     // Transactions
-    void setTransactions( QString account, int64_t height, QVector<WalletTransaction> Transactions);
+    // queryKey - coalesced query key, result will be delivered to all requesters of this query
+    void setTransactions( QString queryKey, QString account, int64_t height, QVector<WalletTransaction> Transactions);
 
     void setTransactionById( bool success, QString account, int64_t height, WalletTransaction transaction, QVector<WalletOutput> outputs, QVector<QString> messages );
 
     // Outputs results
-    void setOutputs( QString account, bool show_spent, int64_t height, QVector<WalletOutput> outputs);
+    // queryKey - coalesced query key, result will be delivered to all requesters of this query
+    void setOutputs( QString queryKey, QString account, bool show_spent, int64_t height, QVector<WalletOutput> outputs);
+
+    // Query task is deleted without the result (dropped, timeout, wallet restart). Requesters are released,
+    // so the next identical query will start a new task.
+    void releasePendingQuery( const QString & queryKey );
 
     void setWalletOutputs( const QString & account, const QVector<WalletOutput> & outputs);
 
@@ -459,6 +495,12 @@ public:
 
     Mwc713EventManager * getEventCollector() {return eventCollector;}
 
+    Mwc713Metrics & getMetrics() {return taskMetrics;}
+    // Number of mwc713 stdout bytes that was parsed so far
+    qint64 getParsedBytes() const;
+    // Number of known outputs and transactions for all accounts
+    int64_t getWalletSize() const;
+
 
     void setRequestSwapTrades(QString cookie, QVector<wallet::SwapInfo> swapTrades, QString error);
     void setDeleteSwapTrade(QString swapId, QString errMsg);
@@ -493,6 +535,18 @@ private:
     // Request sync (update_wallet_state) if it is not at the task Q.
     QVector<QPair<Mwc713Task*,int64_t>> create_sync_if_need(bool showSyncProgress, bool enforce);
 
+    // Drop cached outputs/transactions results. Call it when wallet data might be changed.
+    void invalidateQueryCache();
+
+    // Transaction was made for the account. Its balance will be refreshed next time.
+    // Empty account - current and receive accounts
+    void markAccountChanged(const QString & account = "");
+
+    // Warm start cache. Restore is done at login, save is delayed, so bunch of updates will be saved once.
+    void restoreWalletCache();
+    void scheduleWalletCacheSave();
+    void saveWalletCache();
+
     void mwc713connect(QProcess * process, bool trackProcessExit);
     void mwc713disconnect();
 
@@ -522,6 +576,11 @@ private:
     // process accountInfoNoLocks, apply locked outputs
     QVector<AccountInfo> applyOutputLocksToBalance() const;
 
+    // Balance with locks applied, recalculated only if balances, outputs or lock settings were changed
+    const QVector<AccountInfo> & getBalanceWithLocks() const;
+    // Must be called on every accountInfoNoLocks or walletOutputs change
+    void invalidateBalanceWithLocks() {balanceWithLocksValid = false;}
+
 private:
     core::AppContext * appContext = nullptr; // app context to store current account name
     node::MwcNode * mwcNode = nullptr;
@@ -529,14 +588,17 @@ private:
     QString mwc713Path; // path to the backed binary
     QString mwc713configPath; // config file for mwc713
     QProcess * mwc713process = nullptr;
-    tries::Mwc713InputParser * inputParser = nullptr; // Parser will generate bunch of signals that wallet will listem on
     const int outputsLinesBufferSize = 15;
-    QList<QString> outputsLines; // Last few output lines. Will print in case of the crash
+    // Output processing thread. Own the parser that will generate bunch of signals that wallet will listem on.
+    // Also keep last few output lines, we will print them in case of the crash
+    Mwc713Reader * outputReader = nullptr;
 
     STARTED_MODE startedMode = STARTED_MODE::OFFLINE;
     bool   loggedIn = false; // Make sence for startedMode NORMAL. True if login was successfull
 
     Mwc713EventManager * eventCollector = nullptr;
+    // Task engine metrics. Survive mwc713 restarts
+    Mwc713Metrics taskMetrics;
 
     // Stages (flags) of the wallet
     //InitWalletStatus initStatus = InitWalletStatus::NONE;
@@ -567,17 +629,69 @@ private:
     QString recieveAccount = "default";
 
     QMap<QString, QVector<wallet::WalletOutput> > walletOutputs; // Available outputs from this wallet. Key: account name, value outputs for this account
+    QMap<QString, int> accountTxCount; // Transactions number from the last txs request. Key: account name
+
+    // Cached result of applyOutputLocksToBalance and the lock settings it was calculated with
+    mutable QVector<AccountInfo> balanceWithLocks;
+    mutable bool balanceWithLocksValid = false;
+    mutable bool balanceLockEnabled = false;
+    mutable int  balanceLocksRevision = -1;
+    mutable int  balanceConfNumber = -1;
 
     int64_t lastSyncTime = 0;
 
+    // Outputs/transactions queries coalescing. Identical queries (same account and flags) share
+    // a single mwc713 command, result is delivered to every requester with its cookie.
+    // Key: query key, value: cookies of requesters that are waiting for the result
+    QMap<QString, QStringList> pendingQueries;
+    // Queries with the sync are never shared, they get unique keys
+    int64_t syncQueryCounter = 0;
+
+    struct OutputsQueryResult {
+        int64_t time = 0;
+        QString account;
+        bool    showSpent = false;
+        int64_t height = -1;
+        QVector<WalletOutput> outputs;
+    };
+    struct TransactionsQueryResult {
+        int64_t time = 0;
+        QString account;
+        int64_t height = -1;
+        QVector<WalletTransaction> transactions;
+    };
+    // Recent results, they are served while they are younger than queryStaleWindow. Key: query key
+    QMap<QString, OutputsQueryResult> outputsCache;
+    QMap<QString, TransactionsQueryResult> transactionsCache;
+    int64_t queryStaleWindow = QUERY_STALE_WINDOW_MS;
+
     WalletConfig currentConfig;
     WalletConfig defaultConfig;
 private:
     // Temprary values, local values for states
     QString walletPasswordHash;
+    QByteArray historyKey; // HistoryStore key, derived from the password
 
     QVector<AccountInfo> collectedAccountInfo;
 
+    // Balance refresh. Only changed accounts are requested from mwc713, the rest keep the last info.
+    QSet<QString> changedAccounts; // Accounts that was affected by transactions since the last refresh
+    QSet<QString> awaitingInfoAccounts; // Accounts that was requested at the current refresh
+    QString lastInfoAccount; // mwc713 active account at the end of the refresh. Empty - nothing was switched
+    bool    fullBalanceRefresh = true; // Next refresh will request all accounts
+    int64_t lastFullBalanceRefresh = 0;
+    int     balanceRefreshConfNumber = -1; // Confirmations number of the last refresh, balances depend on it
+
+    // Warm start cache
+    QString cacheDataPath; // Data path of the logged in wallet. Empty - nothing to save
+    int64_t warmStartHeight = -1; // Height of the data that was restored from the cache. -1 - data is fresh
+    QMap<QString, QVector<WalletTransaction>> lastTransactions; // Last transactions by account
+    QTimer * cacheSaveTimer = nullptr;
+
+    // Local history, open while the wallet is logged in
+    HistoryStore historyStore;
+    HistorySearch historySearch;
+
     int64_t walletStartTime = 0;
     QString commandLine;
 };
@@ -16,8 +16,12 @@
 #include "mwc713.h"
 #include "../tries/mwc713inputparser.h"
 #include "mwc713task.h"
+#include "mwc713metrics.h"
 #include <QDateTime>
+#include <QTimer>
+#include <limits>
 #include "../util/Log.h"
+#include "../util/tracer.h"
 #include "../core/Config.h"
 #include "../core/Notification.h"
 #include "../core/WndManager.h"
@@ -76,8 +80,35 @@ QString toString(WALLET_EVENTS event) {
 }
 
 
+static QString buildTaskKey(const Mwc713Task * task) {
+    return task->getTaskName() + "\n" + task->getInputStr();
+}
+
+// Key for pendingGroups. Higher priority goes first, then FIFO
+static qint64 groupOrderKey(TASK_PRIORITY priority, int groupId) {
+    return (qint64(TASK_PRIORITY::TASK_NOW - priority) << 32) | quint32(groupId);
+}
+
+// Wallet size (outputs + transactions) that add one more static timeout to the size dependent tasks
+static const int64_t TIMEOUT_WALLET_SIZE_STEP = 2000;
+// Size dependent timeout is not longer than the static timeout multiplied by this
+static const int64_t TIMEOUT_WALLET_SIZE_MAX_FACTOR = 4;
+// Task timeout can't be less than recent execution time (percentile) multiplied by the margin
+static const double  TIMEOUT_EXEC_PERCENTILE = 95.0;
+static const int64_t TIMEOUT_EXEC_MARGIN = 3;
+
+taskInfo::taskInfo(int _groupId, TASK_PRIORITY _priority, Mwc713Task* _task, int _timeout) :
+    groupId(_groupId), priority(_priority), task(_task), timeout(_timeout), taskKey(buildTaskKey(_task)),
+    addTime(QDateTime::currentMSecsSinceEpoch()),
+    traceQueueId(tracer::asyncBegin("task-queue", _task->getTaskName())) {}
+
 Mwc713EventManager::Mwc713EventManager(MWC713 * _mwc713wallet) : mwc713wallet(_mwc713wallet) , taskQMutex(QMutex::Recursive)
 {
+    metrics = &mwc713wallet->getMetrics();
+
+    deadlineTimer = new QTimer(this);
+    deadlineTimer->setSingleShot(true);
+    connect(deadlineTimer, &QTimer::timeout, this, &Mwc713EventManager::onTaskDeadline);
 }
 
 Mwc713EventManager::~Mwc713EventManager() {
@@ -94,7 +125,15 @@ void Mwc713EventManager::clear() {
         delete t.task;
     }
     taskQ.clear();
+    for (const auto & grp : pendingGroups) {
+        for (auto t : grp)
+            delete t.task;
+    }
+    pendingGroups.clear();
+    taskKeys.clear();
+    metrics->resetQueueDepth();
     events.clear();
+    deadlineTimer->stop();
     taskExecutionTimeLimit = 0;
 }
 
@@ -102,23 +141,12 @@ void Mwc713EventManager::connectWith(tries::Mwc713InputParser * inputParser) {
     const bool connected = connect(inputParser, &tries::Mwc713InputParser::sgGenericEvent, this, &wallet::Mwc713EventManager::slReceiveEvent,Qt::QueuedConnection );
     Q_ASSERT(connected);
     Q_UNUSED(connected);
-
-    startTimer(500); // timeout checking. Twice a second is good enough for us
 }
 
 // Check if task already exist
 bool Mwc713EventManager::hasTask(Mwc713Task * task) {
-
     QMutexLocker l( &taskQMutex );
-
-    bool found = false;
-    for ( const taskInfo & ti : taskQ ) {
-            if (ti.task->getTaskName() == task->getTaskName() && ti.task->getInputStr() == task->getInputStr()) {
-                found = true;
-                break;
-            }
-    }
-    return found;
+    return taskKeys.contains( buildTaskKey(task) );
 }
 
 
@@ -126,49 +154,34 @@ bool Mwc713EventManager::hasTask(Mwc713Task * task) {
 // tasks  - pairs of task + timeouts. All tasks creates a group that is not divisible buy other tasks.
 // This tale ownership of object
 // Note:  if timeout <= 0, task will be executed immediately
-//   idx == -1 - push_back, otherwise will insert into the index position
+//   idx == -1 - add by priority, idx == 0 - insert in front of the queue, will be executed next
 // Return: true if task was added.  False - was ignored
 void Mwc713EventManager::addTask( TASK_PRIORITY priority, QVector< QPair<Mwc713Task*, int64_t>> tasks, int idx ) {
     QMutexLocker l( &taskQMutex );
 
     // timeout multiplier will be applyed to the task because we want apply this value as late as posiible.
     // User might change it at any moment.
-    if (idx<0) {
-        // search for position to insert
-        for (int pos = 0; pos<taskQ.size(); pos++) {
-            if (taskQ[pos].wasStarted || taskQ[pos].priority >= priority)
-                continue;
-
-            if (pos > 0 && taskQ[pos - 1].groupId == taskQ[pos].groupId)
-                continue;
-
-            groupId++;
-
-            for (int r = tasks.size() - 1; r >= 0; r--) {
-                taskQ.insert(pos, taskInfo(groupId, priority, tasks[r].first, tasks[r].second));
-            }
+    groupId++;
 
-            tasks.clear();
-            break;
-        }
+    QVector<taskInfo> group;
+    group.reserve(tasks.size());
+    for (auto & t : tasks) {
+        group.push_back( taskInfo(groupId, priority, t.first, t.second) );
+        taskKeys[group.back().taskKey]++;
+    }
+    metrics->changeQueueDepth(priority, group.size());
 
-        if (!tasks.isEmpty()) {
-            groupId++;
-            for (auto & t : tasks) {
-                taskQ.push_back(taskInfo(groupId, priority, t.first, t.second));
-            }
-        }
-        // Let's
+    if (idx<0) {
+        // Started group stay at taskQ, so it will never be splitted by the new one
+        pendingGroups.insert( groupOrderKey(priority, groupId), group );
     }
     else {
-        if (idx==0) {
-            Q_ASSERT(taskQ.isEmpty() || !taskQ.front().wasStarted);
-        }
+        // Front insertion is used by the tasks to run subtasks right after them, even inside the current group
+        Q_ASSERT(idx==0);
+        Q_ASSERT(taskQ.isEmpty() || !taskQ.front().wasStarted);
 
-        groupId++;
-        for (int r=tasks.size()-1; r>=0; r--) {
-            taskQ.insert(idx, taskInfo(groupId, priority, tasks[r].first, tasks[r].second ));
-        }
+        group.append(taskQ);
+        taskQ.swap(group);
     }
 
     processNextTask();
@@ -178,19 +191,79 @@ void Mwc713EventManager::addTask( TASK_PRIORITY priority, QVector< QPair<Mwc713T
 int Mwc713EventManager::cancelTasksInQueue() {
     QMutexLocker l( &taskQMutex );
 
+    fillTaskQ();
+
+    for (auto & grp : pendingGroups) {
+        for (auto & t : grp)
+            dropTask(t);
+    }
+    pendingGroups.clear();
+
     if (taskQ.isEmpty()) {
         return 0;
     }
 
+    for (int i=1; i<taskQ.size(); i++)
+        dropTask(taskQ[i]);
     taskQ.resize(1);
-    return taskQ[0].timeout;
+    return int( taskQ[0].wasStarted ? taskTimeoutMs : calcTaskTimeout(taskQ[0]) );
 }
 
+// Take the first task from taskQ
+taskInfo Mwc713EventManager::takeFirstTask() {
+    Q_ASSERT(!taskQ.isEmpty());
+    taskInfo ti = taskQ.takeFirst();
+    releaseTaskKey(ti);
+    metrics->changeQueueDepth(ti.priority, -1);
+    return ti;
+}
+
+// Remove not started task from the queue and delete it
+void Mwc713EventManager::dropTask(const taskInfo & ti) {
+    tracer::asyncEnd("task-queue", ti.task->getTaskName(), ti.traceQueueId);
+    releaseTaskKey(ti);
+    metrics->changeQueueDepth(ti.priority, -1);
+    delete ti.task;
+}
+
+// Move the next pending group into taskQ if it is empty
+void Mwc713EventManager::fillTaskQ() {
+    if (!taskQ.isEmpty() || pendingGroups.isEmpty())
+        return;
+
+    taskQ = pendingGroups.take( pendingGroups.firstKey() );
+}
+
+// Remove the task from the dedup index
+void Mwc713EventManager::releaseTaskKey(const taskInfo & ti) {
+    auto it = taskKeys.find(ti.taskKey);
+    Q_ASSERT(it != taskKeys.end());
+    if (it == taskKeys.end())
+        return;
+
+    if (--it.value() <= 0)
+        taskKeys.erase(it);
+}
+
+// Dump of the whole queue for the logs
+QString Mwc713EventManager::printTaskQueue() const {
+    QStringList taskList;
+    for (const auto & t : taskQ) {
+        taskList.push_back(t.task->toDbgString());
+    }
+    for (const auto & grp : pendingGroups) {
+        for (const auto & t : grp)
+            taskList.push_back(t.task->toDbgString());
+    }
+    return taskList.join(", ");
+}
 
 // Process next task
 void Mwc713EventManager::processNextTask() {
     QMutexLocker l( &taskQMutex );
 
+    fillTaskQ();
+
     if (taskQ.empty()) {
         if (!lastWalletProgressCommand.isEmpty()) {
             lastWalletProgressCommand = "";
@@ -208,12 +281,19 @@ void Mwc713EventManager::processNextTask() {
         qDebug() << "Executing the task: " + task.task->toDbgString();
         task.wasStarted = true; // reset state first, then process
         taskExecutionTimeLimit = 0;
+        deadlineTimer->stop();
+        taskStartCounter++;
 
-        QStringList taskList;
-        for (const auto & t : taskQ) {
-            taskList.push_back(t.task->toDbgString());
-        }
-        logger::logInfo( "Mwc713EventManager", "Task queue: " + taskList.join(", ") );
+        task.startTime = QDateTime::currentMSecsSinceEpoch();
+        task.startBytes = mwc713wallet->getParsedBytes();
+        task.eventsNum = 0;
+
+        tracer::asyncEnd("task-queue", task.task->getTaskName(), task.traceQueueId);
+        task.traceRunId = tracer::asyncBegin("task", task.task->getTaskName());
+
+        // Queue can be long, build the dump only if somebody will read it
+        if (logger::isLogsEnabled())
+            logger::logInfo( "Mwc713EventManager", "Task queue: " + printTaskQueue() );
 
         logger::logTask( "Mwc713EventManager", task.task, "Starting..." );
         task.task->onStarted();
@@ -231,54 +311,82 @@ void Mwc713EventManager::processNextTask() {
             if (!task.task->getInputStr().isEmpty()) {
                 mwc713wallet->executeMwc713command(task.task->getInputStr(), task.task->getShadowStr());
             }
-            taskExecutionTimeLimit = QDateTime::currentMSecsSinceEpoch() +  (int64_t)(task.timeout * config::getTimeoutMultiplier());
+            startDeadline( calcTaskTimeout(task) );
         }
         else {
             // execute the task now. Next task will be started
-            executeTask(taskQ.takeFirst());
+            executeTask(takeFirstTask());
         }
     }
 }
 
-void Mwc713EventManager::timerEvent(QTimerEvent *event) {
+// Timeout for the task. Static task timeout is a floor, it is extended by wallet size
+// and by the recent execution time of such tasks.
+int64_t Mwc713EventManager::calcTaskTimeout(const taskInfo & ti) const {
+    int64_t timeout = ti.timeout;
+    if (ti.task->isScaledByWalletSize())
+        timeout = scaleTimeoutByWalletSize(timeout, mwc713wallet->getWalletSize());
+
+    const int64_t recentExec = metrics->getRecentExecTime( ti.task->getTaskName(), TIMEOUT_EXEC_PERCENTILE );
+    if (recentExec>0)
+        timeout = qMax( timeout, recentExec * TIMEOUT_EXEC_MARGIN );
+
+    // Multiplier is still here because it reflect how slow is the host
+    return (int64_t)(timeout * config::getTimeoutMultiplier());
+}
+
+// static
+int64_t Mwc713EventManager::scaleTimeoutByWalletSize(int64_t timeout, int64_t walletSize) {
+    return timeout + qMin( timeout * qMax(int64_t(0), walletSize) / TIMEOUT_WALLET_SIZE_STEP,
+                           timeout * (TIMEOUT_WALLET_SIZE_MAX_FACTOR - 1) );
+}
+
+// Arm the deadline timer for the running task
+void Mwc713EventManager::startDeadline(int64_t timeoutMs) {
+    taskTimeoutMs = timeoutMs;
+    taskExecutionTimeLimit = QDateTime::currentMSecsSinceEpoch() + timeoutMs;
+    // QTimer is limited by int. For longer deadlines onTaskDeadline will rearm it
+    deadlineTimer->start( int( qMin( timeoutMs, (int64_t) std::numeric_limits<int>::max() ) ) );
+}
+
+void Mwc713EventManager::onTaskDeadline() {
     QMutexLocker l( &taskQMutex );
 
-    Q_UNUSED(event);
     if (taskExecutionTimeLimit==0)
         return;
 
-    if (taskQ.empty()) {
+    if (taskQ.empty() || !taskQ.front().wasStarted) {
         // Fine for exiting.
         taskExecutionTimeLimit = 0;
         return;
     }
 
-    /*if (QDateTime::currentMSecsSinceEpoch() > taskExecutionTimeLimit/2) {
-        mwc713wallet->executeMwc713command("");
-    }*/
-
-    QString taskName = taskQ.front().task->getTaskName();
-
-    if (QDateTime::currentMSecsSinceEpoch() > taskExecutionTimeLimit) {
-        if (core::getWndManager()->questionTextDlg("Warning", "mwc713 command execution is taking longer than expected.\nContinue to wait?",
-                          "Yes", "No",
-                          "Let mwc713 more time to process task '" + taskName + "'",
-                          "Cancel task '" + taskName + "' and restart mwc713 even it can corrupt mwc713 data",
-                          true, false) == core::WndManager::RETURN_CODE::BTN1) {
-            config::increaseTimeoutMultiplier();
-            // Update the waiting time
-
-            // Note, here we might already have another task.
-            if (!taskQ.isEmpty())
-                taskExecutionTimeLimit = QDateTime::currentMSecsSinceEpoch() +  (int64_t)(taskQ.front().timeout * config::getTimeoutMultiplier());
-            return;
-        }
+    const int64_t timeLeft = taskExecutionTimeLimit - QDateTime::currentMSecsSinceEpoch();
+    if (timeLeft > 0) {
+        deadlineTimer->start( int( qMin( timeLeft, (int64_t) std::numeric_limits<int>::max() ) ) );
+        return;
+    }
 
-        // report timeout error. Do it once
-        taskExecutionTimeLimit = 0;
-        notify::appendNotificationMessage( notify::MESSAGE_LEVEL::FATAL_ERROR,
-                "mwc713 unable to process the task '" + taskName + "'" );
+    const QString taskName = taskQ.front().task->getTaskName();
+    const int64_t taskCounter = taskStartCounter;
+
+    if (core::getWndManager()->questionTextDlg("Warning", "mwc713 command execution is taking longer than expected.\nContinue to wait?",
+                      "Yes", "No",
+                      "Let mwc713 more time to process task '" + taskName + "'",
+                      "Cancel task '" + taskName + "' and restart mwc713 even it can corrupt mwc713 data",
+                      true, false) == core::WndManager::RETURN_CODE::BTN1) {
+        // Extending this task only. Its execution time will go to the metrics, so next timeouts
+        // for such tasks will be adjusted.
+        // Note, dialog is modal, here we might already have another task with its own deadline.
+        if (taskCounter == taskStartCounter && taskExecutionTimeLimit!=0)
+            startDeadline( taskTimeoutMs*2 );
+        return;
     }
+
+    // report timeout error. Do it once
+    taskExecutionTimeLimit = 0;
+    notify::appendNotificationMessage( notify::MESSAGE_LEVEL::FATAL_ERROR,
+            "mwc713 unable to process the task '" + taskName + "'" );
 }
 
 
@@ -303,29 +411,57 @@ void Mwc713EventManager::slReceiveEvent( WALLET_EVENTS event, QString message) {
     if (taskQ.isEmpty())
         return;
 
-    events.push_back(WEvent(event, message));
-    qDebug() << "Mwc713EventManager::sReceiveEvent adding Event into the list. event=" << event << " msg='"
-             << message << "'  New size:" << events.size();
+    if (taskQ.front().wasStarted)
+        taskQ.front().eventsNum++;
+
+    // Table data can go directly to the task, no needs to buffer it
+    TableRowSink * rowSink = taskQ.front().wasStarted ? taskQ.front().task->getRowSink() : nullptr;
+    if ( rowSink == nullptr || !rowSink->processEvent( WEvent(event, message) ) ) {
+        events.push_back(WEvent(event, message));
+        qDebug() << "Mwc713EventManager::sReceiveEvent adding Event into the list. event=" << event << " msg='"
+                 << message << "'  New size:" << events.size();
+    }
 
 
     if (!taskQ.front().task->getReadyEvents().contains(event))
         return; // still waiting for events
 
-    executeTask(taskQ.takeFirst());
+    executeTask(takeFirstTask());
 }
 
 void Mwc713EventManager::executeTask(taskInfo task) {
     // Got the acceptable final event
     taskExecutionTimeLimit = 0; // stopping timeout
+    deadlineTimer->stop();
     qDebug() << "Processing task '" << task.task->getTaskName() << "'";
 
     logger::logTask("Mwc713EventManager", task.task, "Executing");
 
     // Reset before processing because processing might tale some time
-    QVector<WEvent> evts(events);
-    events.clear();
+    QVector<WEvent> evts;
+    evts.swap(events);
 
-    task.task->processTask(evts);
+    {
+        tracer::Span traceSpan("task-exec", task.task->getTaskName());
+        task.task->processTask(evts);
+    }
+    tracer::asyncEnd("task", task.task->getTaskName(), task.traceRunId);
+
+    const qint64 queueTime = task.startTime - task.addTime;
+    const qint64 execTime = QDateTime::currentMSecsSinceEpoch() - task.startTime;
+    const qint64 parsedBytes = mwc713wallet->getParsedBytes() - task.startBytes;
+    metrics->recordTask( task.task->getTaskName(), queueTime, execTime, task.eventsNum, parsedBytes );
+
+    if (logger::isLogsEnabled()) {
+        eventlog::Event evt = eventlog::makeEvent(eventlog::KIND::TASK, task.task->getTaskName());
+        evt.who = "Mwc713EventManager";
+        evt.phase = "done";
+        evt.queueMs = queueTime;
+        evt.durationMs = execTime;
+        evt.count = task.eventsNum;
+        evt.bytes = parsedBytes;
+        logger::logEvent(evt);
+    }
     delete task.task;
 
     processNextTask();
@@ -19,6 +19,10 @@
 #include <QVector>
 #include <QObject>
 #include <QMutex>
+#include <QMap>
+#include <QHash>
+
+class QTimer;
 
 namespace tries {
     class Mwc713InputParser;
@@ -28,6 +32,7 @@ namespace wallet {
 
 class Mwc713Task;
 class MWC713;
+class Mwc713Metrics;
 
 enum TASK_PRIORITY {
     TASK_IDLE = 1, // Task that are running in the background
@@ -116,15 +121,26 @@ struct taskInfo {
     Mwc713Task* task = nullptr; // task
     bool        wasStarted   = false;
     int         timeout = -1; // timeout for this task
+    QString     taskKey; // task name + input. Used for dedup
+
+    // Metrics data
+    qint64      addTime = 0;    // ms, when task was added to the queue
+    qint64      startTime = 0;  // ms, when task was started
+    qint64      startBytes = 0; // parsed mwc713 output bytes at the start
+    int         eventsNum = 0;  // events received since the start
+
+    // Timeline spans, 0 if tracing is off
+    quint64     traceQueueId = 0;
+    quint64     traceRunId = 0;
 
     taskInfo() = default;
-    taskInfo(int _groupId, TASK_PRIORITY _priority, Mwc713Task* _task, int _timeout) : groupId(_groupId), priority(_priority), task(_task), timeout(_timeout) {}
+    taskInfo(int _groupId, TASK_PRIORITY _priority, Mwc713Task* _task, int _timeout);
     taskInfo(const taskInfo&) = default;
     taskInfo & operator=(const taskInfo&) = default;
 };
 
 // Aggregator for Wallet events. Expected that there are not many events are aggregating.
-// That is whay we are not maintaining any indexes.
+// Task queue can be long, so tasks are indexed by priority and by dedup key.
 class Mwc713EventManager : public QObject
 {
     Q_OBJECT
@@ -155,12 +171,23 @@ public:
 
     // clean all tasks, events and all
     void clear();
+
+    // Static timeout extended by the wallet size. Extension is capped, a hung mwc713 must still be detected.
+    static int64_t scaleTimeoutByWalletSize(int64_t timeout, int64_t walletSize);
 public slots:
     void slReceiveEvent( WALLET_EVENTS event, QString message); // message is optional
 
+private slots:
+    // Running task deadline is reached
+    void onTaskDeadline();
+
 private:
-    // timer that we are using for timeouts
-    virtual void timerEvent(QTimerEvent *event) override;
+    // Timeout for the task. Static task timeout is a floor, it is extended by wallet size
+    // and by the recent execution time of such tasks.
+    int64_t calcTaskTimeout(const taskInfo & ti) const;
+
+    // Arm the deadline timer for the running task
+    void startDeadline(int64_t timeoutMs);
 
     // Process next task
     void processNextTask();
@@ -168,9 +195,23 @@ private:
     // Execute this task and start the next one
     void executeTask(taskInfo task);
 
+    // Take the first task from taskQ
+    taskInfo takeFirstTask();
+    // Remove not started task from the queue and delete it
+    void dropTask(const taskInfo & ti);
+    // Move the next pending group into taskQ if it is empty
+    void fillTaskQ();
+    // Remove the task from the dedup index
+    void releaseTaskKey(const taskInfo & ti);
+
+    // Dump of the whole queue for the logs
+    QString printTaskQueue() const;
+
 private:
     // Wallet
     MWC713 * mwc713wallet = nullptr;
+    // Task engine metrics, owned by the wallet
+    Mwc713Metrics * metrics = nullptr;
 
     // permanent tasks that allways active. They will process events one by one.
     // All input will come to them.
@@ -178,13 +219,22 @@ private:
     QVector< Mwc713Task* > listeners; // Owner of the tasks
 
     QMutex taskQMutex; // recursive
+    // Running task with the rest of its group and the groups that was added in front of the queue.
+    // Normally it is a single group.
     QVector< taskInfo > taskQ; // Owner of the tasks
+    // Groups that are waiting for the taskQ. Key: priority (high first) + groupId (FIFO)
+    QMap< qint64, QVector<taskInfo> > pendingGroups; // Owner of the tasks
+    // Dedup index, task key to number of such tasks in the queue
+    QHash< QString, int > taskKeys;
     int groupId = 0;
 
     // Events for a new task
     QVector<WEvent> events;
 
-    volatile qint64 taskExecutionTimeLimit = 0; // Timeout value for the task
+    QTimer * deadlineTimer = nullptr; // Single shot, armed for the running task
+    volatile qint64 taskExecutionTimeLimit = 0; // Deadline for the running task, 0 - no deadline
+    int64_t taskTimeoutMs = 0; // Timeout that was applied to the running task
+    int64_t taskStartCounter = 0; // Number of started tasks, identify the running task
 
     QString lastWalletProgressCommand;
 };
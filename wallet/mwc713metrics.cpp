@@ -0,0 +1,222 @@
+// Copyright 2019 The MWC Developers
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mwc713metrics.h"
+#include <QMutexLocker>
+#include <QJsonDocument>
+#include <QDateTime>
+#include <QtAlgorithms>
+#include <cmath>
+#include <algorithm>
+#include <limits>
+#include "../util/Files.h"
+
+namespace wallet {
+
+////////////////////////////////////////////////////////////////////
+// LatencyHistogram
+
+int LatencyHistogram::bucketIndex(qint64 value) {
+    if (value < SUB_COUNT)
+        return int( qMax(qint64(0), value) );
+
+    const int msb = 63 - qCountLeadingZeroBits( quint64(value) );
+    const int shift = msb - SUB_BITS + 1;
+    const int sub = int(value >> shift); // SUB_HALF..SUB_COUNT-1
+    return SUB_COUNT + (shift-1)*SUB_HALF + (sub - SUB_HALF);
+}
+
+qint64 LatencyHistogram::bucketHighValue(int idx) {
+    if (idx < SUB_COUNT)
+        return idx;
+
+    const int k = idx - SUB_COUNT;
+    const int shift = k / SUB_HALF + 1;
+    // The top bucket ends at 2^63-1, so it is calculated unsigned
+    if (shift > 63 - SUB_BITS)
+        return std::numeric_limits<qint64>::max();
+    const quint64 sub = quint64(k % SUB_HALF + SUB_HALF);
+    const quint64 high = ((sub+1) << shift) - 1;
+    return qint64( qMin( high, quint64(std::numeric_limits<qint64>::max()) ) );
+}
+
+void LatencyHistogram::record(qint64 value) {
+    value = qMax(qint64(0), value);
+
+    const int idx = bucketIndex(value);
+    if (idx >= counts.size())
+        counts.resize(idx+1);
+    counts[idx]++;
+
+    if (count==0) {
+        minVal = maxVal = value;
+    }
+    else {
+        minVal = qMin(minVal, value);
+        maxVal = qMax(maxVal, value);
+    }
+    count++;
+    total += value;
+}
+
+void LatencyHistogram::clear() {
+    counts.clear();
+    count = 0;
+    minVal = maxVal = 0;
+    total = 0;
+}
+
+qint64 LatencyHistogram::getPercentile(double percentile) const {
+    if (count==0)
+        return 0;
+
+    const qint64 target = qMax( qint64(1), qint64( std::ceil( percentile / 100.0 * count ) ) );
+    qint64 sum = 0;
+    for (int i=0; i<counts.size(); i++) {
+        sum += counts[i];
+        if (sum >= target)
+            return qMin( bucketHighValue(i), maxVal );
+    }
+    return maxVal;
+}
+
+QJsonObject LatencyHistogram::toJson() const {
+    QJsonObject res;
+    res["count"] = count;
+    res["min"] = getMin();
+    res["max"] = getMax();
+    res["mean"] = getMean();
+    res["p50"] = getPercentile(50.0);
+    res["p90"] = getPercentile(90.0);
+    res["p99"] = getPercentile(99.0);
+    res["p999"] = getPercentile(99.9);
+    return res;
+}
+
+////////////////////////////////////////////////////////////////////
+// TaskMetrics
+
+void TaskMetrics::addRecentExec(qint64 execMs) {
+    if (recentExecMs.size() < RECENT_SIZE) {
+        recentExecMs.push_back(execMs);
+        return;
+    }
+    recentExecMs[recentPos] = execMs;
+    recentPos = (recentPos+1) % recentExecMs.size();
+}
+
+QJsonObject TaskMetrics::toJson() const {
+    QJsonObject res;
+    res["finished"] = finished;
+    res["queuedMs"] = queuedMs.toJson();
+    res["execMs"] = execMs.toJson();
+    res["events"] = events.toJson();
+    res["bytes"] = bytes.toJson();
+    return res;
+}
+
+////////////////////////////////////////////////////////////////////
+// Mwc713Metrics
+
+Mwc713Metrics::Mwc713Metrics() {
+    resetQueueDepth();
+    startTime = QDateTime::currentMSecsSinceEpoch();
+}
+
+// Finished task record
+void Mwc713Metrics::recordTask(const QString & taskName, qint64 queuedMs, qint64 execMs, int events, qint64 bytes) {
+    QMutexLocker l( &mutex );
+    TaskMetrics & m = tasks[taskName];
+    m.finished++;
+    m.queuedMs.record(queuedMs);
+    m.execMs.record(execMs);
+    m.events.record(events);
+    m.bytes.record(bytes);
+    m.addRecentExec(execMs);
+}
+
+// Execution time percentile for the recent runs of the task.
+qint64 Mwc713Metrics::getRecentExecTime(const QString & taskName, double percentile) const {
+    QMutexLocker l( &mutex );
+    auto it = tasks.constFind(taskName);
+    if (it == tasks.constEnd() || it.value().recentExecMs.size() < RECENT_MIN_SAMPLES)
+        return -1;
+
+    QVector<qint64> samples = it.value().recentExecMs;
+    const int idx = qBound( 0, int( std::ceil( percentile / 100.0 * samples.size() ) ) - 1, samples.size()-1 );
+    std::nth_element( samples.begin(), samples.begin() + idx, samples.end() );
+    return samples[idx];
+}
+
+void Mwc713Metrics::changeQueueDepth(TASK_PRIORITY priority, int delta) {
+    Q_ASSERT(priority>=0 && priority<PRIORITY_NUM);
+    QMutexLocker l( &mutex );
+    int & depth = queueDepth[priority];
+    depth = qMax(0, depth + delta);
+    queueDepthPeak[priority] = qMax(queueDepthPeak[priority], depth);
+}
+
+void Mwc713Metrics::resetQueueDepth() {
+    QMutexLocker l( &mutex );
+    std::fill( queueDepth, queueDepth + PRIORITY_NUM, 0 );
+    std::fill( queueDepthPeak, queueDepthPeak + PRIORITY_NUM, 0 );
+}
+
+int Mwc713Metrics::getQueueDepth(TASK_PRIORITY priority) const {
+    Q_ASSERT(priority>=0 && priority<PRIORITY_NUM);
+    QMutexLocker l( &mutex );
+    return queueDepth[priority];
+}
+
+// Drop all collected data except the current queue depth
+void Mwc713Metrics::clear() {
+    QMutexLocker l( &mutex );
+    tasks.clear();
+    std::copy( queueDepth, queueDepth + PRIORITY_NUM, queueDepthPeak );
+    startTime = QDateTime::currentMSecsSinceEpoch();
+}
+
+QJsonObject Mwc713Metrics::toJson() const {
+    QMutexLocker l( &mutex );
+
+    QJsonObject queue;
+    const QVector<QPair<TASK_PRIORITY, QString>> priorities{
+            {TASK_PRIORITY::TASK_IDLE, "idle"}, {TASK_PRIORITY::TASK_NORMAL, "normal"}, {TASK_PRIORITY::TASK_NOW, "now"} };
+    for (const auto & pr : priorities) {
+        QJsonObject q;
+        q["depth"] = queueDepth[pr.first];
+        q["peak"] = queueDepthPeak[pr.first];
+        queue[pr.second] = q;
+    }
+
+    QJsonObject taskObj;
+    for (auto it = tasks.constBegin(); it != tasks.constEnd(); it++)
+        taskObj[it.key()] = it.value().toJson();
+
+    QJsonObject res;
+    res["since"] = QDateTime::fromMSecsSinceEpoch(startTime).toString(Qt::ISODate);
+    res["queue"] = queue;
+    res["tasks"] = taskObj;
+    return res;
+}
+
+// Dump json into the file. Return error message or empty string on success
+QString Mwc713Metrics::dumpToFile(const QString & fileName) const {
+    const QString json = QJsonDocument( toJson() ).toJson( QJsonDocument::JsonFormat::Indented );
+    if (!util::writeTextFile( fileName, {json} ))
+        return "Unable to write task metrics into the file " + fileName;
+    return "";
+}
+
+}
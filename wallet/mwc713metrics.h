@@ -0,0 +1,126 @@
+// Copyright 2019 The MWC Developers
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MWC713METRICS_H
+#define MWC713METRICS_H
+
+#include <QString>
+#include <QVector>
+#include <QMap>
+#include <QMutex>
+#include <QJsonObject>
+#include "mwc713events.h"
+
+namespace wallet {
+
+// HDR-style histogram for non negative values. Values are grouped by power of two, every
+// group is split into SUB_HALF linear buckets, so relative error is below 1/SUB_HALF (~3%).
+// Record is O(1), memory is growing with the max value only.
+class LatencyHistogram {
+public:
+    LatencyHistogram() = default;
+    LatencyHistogram(const LatencyHistogram &) = default;
+    LatencyHistogram & operator=(const LatencyHistogram &) = default;
+
+    void record(qint64 value);
+    void clear();
+
+    qint64 getCount() const {return count;}
+    qint64 getMin() const {return count>0 ? minVal : 0;}
+    qint64 getMax() const {return maxVal;}
+    double getMean() const {return count>0 ? double(total)/count : 0.0;}
+
+    // percentile: 0..100. Return the highest value that is equivalent to the bucket
+    qint64 getPercentile(double percentile) const;
+
+    // count, min, max, mean, p50, p90, p99, p999
+    QJsonObject toJson() const;
+
+    // Exposed for the tests
+    static int bucketIndex(qint64 value);
+    static qint64 bucketHighValue(int idx);
+
+private:
+    enum { SUB_BITS = 6, SUB_COUNT = 1<<SUB_BITS, SUB_HALF = SUB_COUNT/2 };
+
+    QVector<qint64> counts; // counts by bucket index
+    qint64 count = 0;
+    qint64 minVal = 0;
+    qint64 maxVal = 0;
+    qint64 total = 0;
+};
+
+// Statistic for a single task class (task name)
+struct TaskMetrics {
+    qint64 finished = 0;
+    LatencyHistogram queuedMs; // from addTask till the start
+    LatencyHistogram execMs;   // from the start till the processTask
+    LatencyHistogram events;   // events received while task was running
+    LatencyHistogram bytes;    // mwc713 output bytes parsed while task was running
+
+    // Last execution times, ring buffer. Histograms keep all history, the timeouts need recent data.
+    enum { RECENT_SIZE = 50 };
+    QVector<qint64> recentExecMs;
+    int recentPos = 0;
+
+    void addRecentExec(qint64 execMs);
+
+    QJsonObject toJson() const;
+};
+
+// Metrics for mwc713 task engine. Owned by MWC713 and survive mwc713 restarts.
+// Mwc713EventManager is updating it, bridge is reading it. Thread safe.
+class Mwc713Metrics {
+public:
+    Mwc713Metrics();
+
+    Mwc713Metrics(const Mwc713Metrics &) = delete;
+    Mwc713Metrics & operator=(const Mwc713Metrics &) = delete;
+
+    // Finished task record
+    void recordTask(const QString & taskName, qint64 queuedMs, qint64 execMs, int events, qint64 bytes);
+
+    // Execution time percentile for the recent runs of the task.
+    // Return -1 if there are not enough samples to judge.
+    qint64 getRecentExecTime(const QString & taskName, double percentile) const;
+
+    // Queue depth tracking. delta - number of tasks added (positive) or removed (negative)
+    void changeQueueDepth(TASK_PRIORITY priority, int delta);
+    void resetQueueDepth();
+
+    int getQueueDepth(TASK_PRIORITY priority) const;
+
+    // Drop all collected data except the current queue depth
+    void clear();
+
+    // All metrics as json: {"queue":{...}, "tasks":{"TaskSync":{...}, ...}}
+    QJsonObject toJson() const;
+
+    // Dump json into the file. Return error message or empty string on success
+    QString dumpToFile(const QString & fileName) const;
+
+private:
+    enum { PRIORITY_NUM = TASK_PRIORITY::TASK_NOW + 1 };
+    enum { RECENT_MIN_SAMPLES = 5 };
+
+    mutable QMutex mutex;
+    QMap<QString, TaskMetrics> tasks;
+    int queueDepth[PRIORITY_NUM];
+    int queueDepthPeak[PRIORITY_NUM];
+    qint64 startTime = 0;
+};
+
+}
+
+#endif // MWC713METRICS_H
@@ -0,0 +1,160 @@
+// Copyright 2019 The MWC Developers
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mwc713reader.h"
+#include <QThread>
+#include <QDebug>
+#include <QRegExp>
+#include <QMutexLocker>
+#include "../tries/mwc713inputparser.h"
+#include "../util/ioutils.h"
+#include "../util/Log.h"
+#include "../util/tracer.h"
+#include "../util/stringutils.h"
+
+namespace wallet {
+
+Mwc713Reader::Mwc713Reader(int _outputsLinesBufferSize) :
+        outputsLinesBufferSize(_outputsLinesBufferSize)
+{
+    thread = new QThread();
+    thread->setObjectName("mwc713reader");
+    moveToThread(thread);
+    thread->start();
+}
+
+Mwc713Reader::~Mwc713Reader() {
+    thread->quit();
+    thread->wait();
+
+    // Thread is stopped, it is safe to clean up from here
+    delete inputParser;
+    inputParser = nullptr;
+
+    delete thread;
+    thread = nullptr;
+}
+
+// Attach a new parser, reader take ownership.
+void Mwc713Reader::attachParser( tries::Mwc713InputParser * parser ) {
+    Q_ASSERT(parser);
+    parser->moveToThread(thread);
+    QMetaObject::invokeMethod(this, "onAttachParser", Qt::QueuedConnection, Q_ARG(QObject*, parser) );
+}
+
+void Mwc713Reader::detachParser() {
+    QMetaObject::invokeMethod(this, "onDetachParser", Qt::QueuedConnection );
+}
+
+void Mwc713Reader::processStdout( const QByteArray & data ) {
+    QMetaObject::invokeMethod(this, "onStdout", Qt::QueuedConnection, Q_ARG(QByteArray, data) );
+}
+
+void Mwc713Reader::processParserInput( const QString & str ) {
+    QMetaObject::invokeMethod(this, "onParserInput", Qt::QueuedConnection, Q_ARG(QString, str) );
+}
+
+void Mwc713Reader::appendOutputsLines( const QString & str ) {
+    QMetaObject::invokeMethod(this, "onAppendOutputsLines", Qt::QueuedConnection, Q_ARG(QString, str) );
+}
+
+// Wait until all submitted data is processed
+void Mwc713Reader::flush() {
+    Q_ASSERT( QThread::currentThread() != thread ); // Deadlock otherwise
+    QMetaObject::invokeMethod(this, "onFlush", Qt::BlockingQueuedConnection );
+}
+
+QList<QString> Mwc713Reader::getOutputsLines() {
+    QMutexLocker l( &outputsLinesMutex );
+    return outputsLines;
+}
+
+void Mwc713Reader::clearOutputsLines() {
+    QMutexLocker l( &outputsLinesMutex );
+    outputsLines.clear();
+}
+
+void Mwc713Reader::pushOutputsLine( const QString & ln ) {
+    QMutexLocker l( &outputsLinesMutex );
+    while(outputsLines.size()>outputsLinesBufferSize)
+        outputsLines.pop_front();
+
+    outputsLines.push_back(ln);
+}
+
+////////////////////////////////////////////////////////////////////
+// Reader thread
+
+void Mwc713Reader::onAttachParser( QObject * parser ) {
+    delete inputParser;
+    inputParser = static_cast<tries::Mwc713InputParser *>(parser);
+}
+
+void Mwc713Reader::onDetachParser() {
+    delete inputParser;
+    inputParser = nullptr;
+}
+
+void Mwc713Reader::onStdout( QByteArray data ) {
+    // Counting before parsing, so the task that get the events will see those bytes
+    parsedBytes.fetchAndAddOrdered( data.size() );
+
+    QString str( ioutils::FilterEscSymbols( data ) );
+    qDebug() << "Get output:" << str;
+    logger::logMwc713out(str);
+
+    // Let's filter out the possible prompt from the editor it can be located anywhere
+    // To filter out:  'wallet713>'
+    auto lns = str.split(QRegExp("[\r\n]"),QString::SkipEmptyParts);
+
+    QString filteredStr;
+    for (auto ln : lns) {
+        if (ln.startsWith("wallet713>"))
+            ln = ln.mid(strlen("wallet713>")).trimmed();
+
+        if (!filteredStr.isEmpty())
+            filteredStr += "\n";
+        filteredStr += ln;
+
+        if (!ln.isEmpty())
+            pushOutputsLine(ln);
+    }
+
+    if (str.size()>0 && (str[0] == '\n' || str[0] == '\r') )
+        filteredStr = "\n" + filteredStr;
+
+    if ( str.size()>0 && (str[str.size()-1] == '\n' || str[str.size()-1] == '\r') ) {
+        filteredStr += "\n";
+    }
+
+    if (inputParser) {
+        tracer::Span traceSpan("parser", "Mwc713InputParser");
+        inputParser->processInput(filteredStr);
+    }
+}
+
+void Mwc713Reader::onParserInput( QString str ) {
+    if (inputParser) {
+        tracer::Span traceSpan("parser", "Mwc713InputParser");
+        inputParser->processInput(str);
+    }
+}
+
+void Mwc713Reader::onAppendOutputsLines( QString str ) {
+    // Final output of the process, no buffer limit here
+    QMutexLocker l( &outputsLinesMutex );
+    util::updateEventList(outputsLines, str);
+}
+
+}
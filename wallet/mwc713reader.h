@@ -0,0 +1,96 @@
+// Copyright 2019 The MWC Developers
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MWC713READER_H
+#define MWC713READER_H
+
+#include <QObject>
+#include <QByteArray>
+#include <QList>
+#include <QMutex>
+#include <QAtomicInteger>
+
+class QThread;
+
+namespace tries {
+    class Mwc713InputParser;
+}
+
+namespace wallet {
+
+// mwc713 output processing worker. Lives at its own thread, so big outputs (txs, outputs, recovery)
+// doesn't freeze the UI. Reader get raw stdout data, filter it, maintain the last output lines
+// for crash diagnostic and feed the parser. Parser is running at the reader thread as well and
+// deliver WALLET_EVENTS to Mwc713EventManager through its queued connection.
+// All data is processed in the order it was submitted.
+class Mwc713Reader : public QObject
+{
+    Q_OBJECT
+public:
+    Mwc713Reader(int outputsLinesBufferSize);
+    virtual ~Mwc713Reader() override;
+
+    Mwc713Reader(const Mwc713Reader & other) = delete;
+    Mwc713Reader & operator=(const Mwc713Reader & other) = delete;
+
+    // Methods below are expected to be called from the owner (main) thread
+
+    // Attach a new parser, reader take ownership. Parser is moved to the reader thread,
+    // caller can connect to its signals after that call.
+    void attachParser( tries::Mwc713InputParser * parser );
+    // Delete current parser. All data submitted before will be processed first.
+    void detachParser();
+
+    // Raw mwc713 stdout data
+    void processStdout( const QByteArray & data );
+    // Data that will go directly to the parser, no filtering
+    void processParserInput( const QString & str );
+    // Add lines to the output lines buffer, no parsing
+    void appendOutputsLines( const QString & str );
+
+    // Wait until all submitted data is processed
+    void flush();
+
+    // Last few output lines. Will print in case of the crash
+    QList<QString> getOutputsLines();
+    void clearOutputsLines();
+
+    // Total number of stdout bytes that was parsed. Can be called from any thread.
+    qint64 getParsedBytes() const {return parsedBytes.load();}
+
+private slots:
+    void onAttachParser( QObject * parser );
+    void onDetachParser();
+    void onStdout( QByteArray data );
+    void onParserInput( QString str );
+    void onAppendOutputsLines( QString str );
+    void onFlush() {}
+
+private:
+    void pushOutputsLine( const QString & ln );
+
+private:
+    QThread * thread = nullptr;
+    tries::Mwc713InputParser * inputParser = nullptr; // Owned and used at the reader thread only
+
+    const int outputsLinesBufferSize;
+    QMutex outputsLinesMutex;
+    QList<QString> outputsLines; // Last few output lines. Will print in case of the crash
+
+    QAtomicInteger<qint64> parsedBytes;
+};
+
+}
+
+#endif // MWC713READER_H
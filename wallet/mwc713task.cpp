@@ -13,6 +13,7 @@
 // limitations under the License.
 
 #include "mwc713task.h"
+#include "../util/stringutils.h"
 
 namespace wallet {
 
@@ -52,5 +53,122 @@ QString printEvents(const QVector<WEvent> & events) {
     return res;
 }
 
+/////////////////////////////////////////////////////////////////////////
+// TableRowSink
+
+static QVector<int> parseHeadersLine( const QString & str, const QVector<QString> & headers ) {
+    Q_ASSERT(headers.size()>0);
+
+    QVector<int> res;
+
+    int curPos = 0;
+    for ( const auto & hdr : headers ) {
+        int pos = str.indexOf(hdr, curPos);
+        if (pos<0)
+            break;
+        res.push_back(pos);
+        curPos = pos + hdr.length();
+    }
+
+    if (res.size()<headers.size())
+        res.clear();
+
+    return res;
+}
+
+static void parseDataLine( const QString & str, const QVector<int> & offsets, QVector<QString> & res ) {
+    Q_ASSERT(offsets.size()>0);
+
+    res.resize(offsets.size());
+
+    for (int i=0; i<offsets.size(); i++) {
+        int idx1 = offsets[i];
+        int idx2 = str.length();
+        if (i+1<offsets.size())
+            idx2 = offsets[i+1];
+
+        res[i] = util::getSubString(str, idx1, idx2);
+    }
+}
+
+TableRowSink::TableRowSink( WALLET_EVENTS _logEvent, const QVector<QString> & _headerMarkers, const QVector<QString> & _headers ) :
+    logEvent(_logEvent),
+    headerMarkers(_headerMarkers),
+    headers(_headers),
+    state( _logEvent == WALLET_EVENTS::S_LINE ? STATE::WAIT_HEADER : STATE::WAIT_LOG )
+{
+    Q_ASSERT(!headerMarkers.isEmpty());
+    Q_ASSERT(!headers.isEmpty());
+}
+
+TableRowSink::~TableRowSink() {}
+
+// Process next event. Return true if event belong to the table and was consumed
+bool TableRowSink::processEvent( const WEvent & evt ) {
+    if (state == STATE::DONE)
+        return false;
+
+    if (state == STATE::WAIT_LOG) {
+        if (evt.event != logEvent)
+            return false;
+
+        state = STATE::WAIT_HEADER;
+        onLogEvent(evt.message);
+        return true;
+    }
+
+    if (evt.event != WALLET_EVENTS::S_LINE)
+        return false;
+
+    const QString & str = evt.message;
+
+    switch (state) {
+        case STATE::WAIT_HEADER: {
+            for (const auto & mk : headerMarkers) {
+                if (!str.contains(mk))
+                    return true;
+            }
+
+            layout = parseHeadersLine( str, headers );
+            if (layout.isEmpty()) {
+                Q_ASSERT(false); // There is a small chance, but it is really not likely it is ok
+                return true;
+            }
+            state = STATE::SKIP_HEADER;
+            return true;
+        }
+        case STATE::SKIP_HEADER: {
+            if (str.startsWith("=============="))
+                state = STATE::ROWS;
+            return true;
+        }
+        case STATE::ROWS: {
+            if (str.startsWith("--------------------"))
+                return true;
+
+            if (str.startsWith("==============")) {
+                state = STATE::DONE; // multiple data types case, nned to handle without surprises
+                return true;
+            }
+
+            parseDataLine(str, layout, values);
+            onRow(str, values);
+            return true;
+        }
+        default:
+            Q_ASSERT(false);
+            return false;
+    }
+}
+
+// Process all events from the buffer
+void TableRowSink::processEvents( const QVector<WEvent> & events ) {
+    for (const auto & e : events) {
+        if (state == STATE::DONE)
+            break;
+        processEvent(e);
+    }
+}
+
 }
 
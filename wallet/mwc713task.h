@@ -23,6 +23,7 @@ namespace wallet {
 
 class MWC713;
 class WalletEventCollector;
+class TableRowSink;
 
 // Base class of all tasks
 class Mwc713Task
@@ -39,6 +40,15 @@ public:
 
     virtual void onStarted() {}
 
+    // Task with large table output (txs, outputs) can register the row sink. In this case
+    // the table lines will be delivered to the sink as they come and will not be buffered
+    // into the events for processTask
+    virtual TableRowSink * getRowSink() {return nullptr;}
+
+    // Task execution time depends on number of outputs and transactions in the wallet.
+    // Timeout for such tasks will be scaled by the wallet size.
+    virtual bool isScaledByWalletSize() const {return false;}
+
     // Will be called from 'Ready' for normal tasks
     // Or in order as events coming for filtering tasks
     // Return true if data was processed. In this case processed evenets will be dropped
@@ -75,6 +85,48 @@ QVector< WEvent > filterEvents(const QVector<WEvent> & events, WALLET_EVENTS typ
 // Print events into the string
 QString printEvents(const QVector<WEvent> & events);
 
+// Streaming parser for mwc713 tables. Expected format:
+//   log event  (like S_OUTPUT_LOG, optional)
+//   header line
+//   ==============
+//   data rows, '--------------------' lines are skipped
+//   ==============
+// Rows are reported one by one, so caller can build the data incrementally.
+class TableRowSink {
+public:
+    // logEvent - event that start the table. Use S_LINE if table doesn't have one.
+    // headerMarkers - strings that header line must contain
+    // headers - column names in the order they go. Define the layout for the rows
+    TableRowSink( WALLET_EVENTS logEvent, const QVector<QString> & headerMarkers, const QVector<QString> & headers );
+    virtual ~TableRowSink();
+
+    // Process next event. Return true if event belong to the table and was consumed
+    bool processEvent( const WEvent & evt );
+
+    // Process all events from the buffer
+    void processEvents( const QVector<WEvent> & events );
+
+    bool isDone() const {return state == STATE::DONE;}
+    bool isStarted() const {return state != STATE::WAIT_LOG;}
+
+protected:
+    // Log event is found. Table is started
+    virtual void onLogEvent( const QString & message ) {Q_UNUSED(message);}
+    // Data line. values are split according to the header layout
+    virtual void onRow( const QString & line, const QVector<QString> & values ) = 0;
+
+private:
+    enum class STATE {WAIT_LOG, WAIT_HEADER, SKIP_HEADER, ROWS, DONE};
+
+    const WALLET_EVENTS logEvent;
+    const QVector<QString> headerMarkers;
+    const QVector<QString> headers;
+
+    STATE state;
+    QVector<int> layout; // positions for the columns
+    QVector<QString> values; // row values, reusing to save allocations
+};
+
 }
 
 #endif // MWC713TASK_H
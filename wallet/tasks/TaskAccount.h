@@ -110,6 +110,8 @@ public:
 
     virtual ~TaskAccountInfo() override {}
 
+    virtual bool isScaledByWalletSize() const override {return true;}
+
     virtual bool processTask(const QVector<WEvent> &events) override;
 
     virtual QSet<WALLET_EVENTS> getReadyEvents() override {return QSet<WALLET_EVENTS>{ WALLET_EVENTS::S_READY };}
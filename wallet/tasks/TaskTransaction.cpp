@@ -19,68 +19,26 @@
 
 namespace wallet {
 
-////////////////////// Common routine ///////////////////////////////////////////////////
-
-static QVector<int> parseHeadersLine( const QString & str, const QVector<QString> & headers ) {
-    Q_ASSERT(headers.size()>0);
-
-    QVector<int> res;
-
-    int curPos = 0;
-    for ( const auto & hdr : headers ) {
-        int pos = str.indexOf(hdr, curPos);
-        if (pos<0)
-            break;
-        res.push_back(pos);
-        curPos = pos + hdr.length();
-    }
-
-    if (res.size()<headers.size())
-        res.clear();
-
-    return res;
-}
-
-static QVector<QString> parseDataLine( const QString & str, const QVector<int> & offsets ) {
-    Q_ASSERT(offsets.size()>0);
-
-    QVector<QString> res;
-
-    for (int i=0; i<offsets.size(); i++) {
-        int idx1 = offsets[i];
-        int idx2 = str.length();
-        if (i+1<offsets.size())
-            idx2 = offsets[i+1];
-
-        res.push_back(util::getSubString(str, idx1, idx2));
-    }
-    return res;
-}
-
-
-
-
 // ------------------------------------ TaskOutputs -------------------------------------------
 
-WalletOutput parseOutputLine( QString str, const QVector<int> & outputLayout) {
+static WalletOutput parseOutputLine( const QVector<QString> & values ) {
 
     WalletOutput res; // invalid until data is set
 
-    QVector<QString> values = parseDataLine(str, outputLayout);
     if (values.isEmpty())
         return res;
 
     Q_ASSERT(values.size()==9);
 
-    QString strOutputCommitment = values[0];
-    QString strMmrIndex     = values[1];
-    QString strBlockHeight  = values[2];
-    QString strLockedUntil  = values[3];
-    QString strStatus       = values[4];
-    QString strCoinbase     = values[5];
-    QString strConfirms     = values[6];
-    QString strValue        = values[7];
-    QString strTx           = values[8];
+    const QString & strOutputCommitment = values[0];
+    const QString & strMmrIndex     = values[1];
+    const QString & strBlockHeight  = values[2];
+    const QString & strLockedUntil  = values[3];
+    const QString & strStatus       = values[4];
+    const QString & strCoinbase     = values[5];
+    const QString & strConfirms     = values[6];
+    const QString & strValue        = values[7];
+    const QString & strTx           = values[8];
 
     QPair<bool,int64_t> mwcOne = util::one2nano(strValue);
 
@@ -103,137 +61,93 @@ WalletOutput parseOutputLine( QString str, const QVector<int> & outputLayout) {
     return res;
 }
 
+// Note, the columns and the order are hardcoded and come from mwc713 data!!!
+OutputsRowSink::OutputsRowSink() :
+    TableRowSink( WALLET_EVENTS::S_OUTPUT_LOG, {"Output Commitment", "Block Height"},
+                  {"Output Commitment", "MMR Index", "Block Height",
+                   "Locked Until", "Status", "Coinbase?", "# Confirms", "Value", "Tx"} )
+{}
+
+void OutputsRowSink::onLogEvent( const QString & message ) {
+    QStringList l = message.split('|');
+    Q_ASSERT(l.size()==2);
+    account = l[0];
+    height = l[1].toInt();
+}
+
+void OutputsRowSink::onRow( const QString & line, const QVector<QString> & values ) {
+    Q_UNUSED(line);
+    // Expected to be a normal line
+    WalletOutput output = parseOutputLine(values);
+    if ( output.isValid() ) {
+        outputs.push_back(output);
+    }
+}
 
 static void parseOutputs(const QVector<WEvent> & events, // in
                               QString & account, // out
                               int64_t & height,  // out
                               QVector<WalletOutput> & outputVector) // out
 {
-    int curEvt = 0;
-
-    for ( ; curEvt < events.size(); curEvt++ ) {
-        if (events[curEvt].event == WALLET_EVENTS::S_OUTPUT_LOG ) {
-            QStringList l = events[curEvt].message.split('|');
-            Q_ASSERT(l.size()==2);
-            account = l[0];
-            height = l[1].toInt();
-            break;
-        }
-    }
-
-    // positions for the columns. Note, the columns and the order are hardcoded and come from mwc713 data!!!
-
-    QVector<int> outputLayout;
+    OutputsRowSink sink;
+    sink.processEvents(events);
 
-    // Continue with transaction output
-    // Search for Header first
-    for ( ; curEvt < events.size(); curEvt++ ) {
-        if (events[curEvt].event == WALLET_EVENTS::S_LINE ) {
-            auto & str = events[curEvt].message;
-            if ( str.contains("Output Commitment") && str.contains("Block Height") ) {
-
-                outputLayout = parseHeadersLine( str, {"Output Commitment", "MMR Index", "Block Height",
-                                                       "Locked Until", "Status", "Coinbase?", "# Confirms", "Value", "Tx"} );
-
-                if ( outputLayout.size()>0 ) {
-                    curEvt++;
-                    break;
-                }
-                Q_ASSERT(false); // There is a small chance, but it is really not likely it is ok
-            }
-        }
-    }
-
-    // Skip header
-    for ( ; curEvt < events.size(); curEvt++ ) {
-        if (events[curEvt].event == WALLET_EVENTS::S_LINE) {
-            auto &str = events[curEvt].message;
-            if (str.startsWith("==============")) {
-                curEvt++; // skipping this
-                break;
-            }
-        }
+    if (sink.isStarted()) {
+        account = sink.account;
+        height = sink.height;
     }
+    outputVector += sink.outputs;
+}
 
-    // Processing transactions
-    for ( ; curEvt < events.size(); curEvt++ ) {
-        if (events[curEvt].event == WALLET_EVENTS::S_LINE ) {
-            auto &str = events[curEvt].message;
-
-            if (str.startsWith("--------------------"))
-                continue;
-
-            if (str.startsWith("=============="))
-                break; // multiple data types case, nned to handle without surprises
-
-            // Expected to be a normal line
-            WalletOutput output = parseOutputLine(str, outputLayout);
-            if ( output.isValid() ) {
-                outputVector.push_back(output);
-            }
-        }
-    }
+TaskOutputs::~TaskOutputs() {
+    // Task was dropped or timed out
+    if (!reported)
+        wallet713->releasePendingQuery(queryKey);
 }
 
 bool TaskOutputs::processTask(const QVector<WEvent> & events) {
-    // We are processing transactions outptu mostly as a raw data
-
-    QString account;
-    int64_t  height = -1;
-    QVector< WalletOutput > outputResult;
-
-    parseOutputs(events, // in
-           account, height, outputResult); // out
-
-    wallet713->setOutputs(account, showSpent, height, outputResult );
+    // Table lines was consumed by the rowSink as they come, events has the rest
+    Q_UNUSED(events);
+    reported = true;
+    wallet713->setOutputs(queryKey, rowSink.account, showSpent, rowSink.height, rowSink.outputs );
     return true;
 }
 
 bool TaskOutputsForAccount::processTask(const QVector<WEvent> & events) {
-
-    QString account;
-    int64_t  height = -1;
-    QVector< WalletOutput > outputResult;
-
-    parseOutputs( events, // in
-                     account, height, outputResult );
-
-    wallet713->setWalletOutputs( account, outputResult);
+    Q_UNUSED(events);
+    wallet713->setWalletOutputs( rowSink.account, rowSink.outputs);
     return true;
 }
 
 
 // ------------------------------------ TaskTransactions -------------------------------------------
 
-static WalletTransaction parseTransactionLine( const QString & str, const QVector<int> & txLayout) {
-
-    Q_ASSERT(txLayout.size()==18);
+static WalletTransaction parseTransactionLine( const QVector<QString> & values ) {
 
     WalletTransaction res; // invalid until data is set
 
-    QVector<QString> values = parseDataLine(str, txLayout);
     if (values.isEmpty())
         return res;
 
     Q_ASSERT(values.size()==18);
 
-    QString strId       = values[0];
-    QString strType     = values[1];
-    QString strTxid     = values[2];
-    QString strAddress  = values[3];
-    QString strCrTime   = values[4];
-    QString strTtlCutOff = values[5];
-    QString strConf     = values[6];
-    QString strHeight   = values[7];
-    QString strConfTime = values[8];
-    QString strNumInputs = values[9];
-    QString strNumOutputs = values[10];
-    QString strCredited = values[11];
-    QString strDebited  = values[12];
-    QString strFee      = values[13];
-    QString strNetDiff  = values[14];
-    QString strProof    = values[15];
-    QString strKernel   = values[16];
+    const QString & strId       = values[0];
+    const QString & strType     = values[1];
+    const QString & strTxid     = values[2];
+    const QString & strAddress  = values[3];
+    const QString & strCrTime   = values[4];
+    const QString & strTtlCutOff = values[5];
+    const QString & strConf     = values[6];
+    const QString & strHeight   = values[7];
+    const QString & strConfTime = values[8];
+    const QString & strNumInputs = values[9];
+    const QString & strNumOutputs = values[10];
+    const QString & strCredited = values[11];
+    const QString & strDebited  = values[12];
+    const QString & strFee      = values[13];
+    const QString & strNetDiff  = values[14];
+    const QString & strProof    = values[15];
+    const QString & strKernel   = values[16];
     // Last 'Tx Data' we don't need
 
     bool txIdx_ok = false;
@@ -285,189 +199,119 @@ static WalletTransaction parseTransactionLine( const QString & str, const QVecto
     return res;
 }
 
-// local utility function that parse transactions output
-static void parseTransactions(const QVector<WEvent> & events, // in
-                                    QString & account, // out
-                                    int64_t & height,  // out
-                                    QVector<WalletTransaction> & trVector) // out
-{
-    // We are processing transactions mostly as a raw data
-    int curEvt = 0;
-
-    account = "";
-    height = -1;
-
-    for ( ; curEvt < events.size(); curEvt++ ) {
-        if (events[curEvt].event == WALLET_EVENTS::S_TRANSACTION_LOG ) {
-            QStringList l = events[curEvt].message.split('|');
-            Q_ASSERT(l.size()==2);
-            account = l[0];
-            height = l[1].toInt();
-            break;
-        }
-    }
-
-    // positions for the columns. Note, the columns and the order are hardcoded and come from mwc713 data!!!
-
-    QVector<int> txLayout;
-
-    // Continue with transaction output
-    // Search for Header first
-    for ( ; curEvt < events.size(); curEvt++ ) {
-        if (events[curEvt].event == WALLET_EVENTS::S_LINE ) {
-            auto & str = events[curEvt].message;
-            if ( str.contains("Creation Time") && str.contains("Confirmed?") ) {
-
-                txLayout = parseHeadersLine( str, {"Id", "Type", "Shared Transaction Id", "Address", "Creation Time",
-                               "TTL Cutoff Height", "Confirmed?", "Height", "Confirmation Time",  "Num.",  "Num.", "Amount", "Amount", "Fee", "Net", "Payment", "Kernel", "Tx"} );
+// Note, the columns and the order are hardcoded and come from mwc713 data!!!
+TransactionsRowSink::TransactionsRowSink() :
+    TableRowSink( WALLET_EVENTS::S_TRANSACTION_LOG, {"Creation Time", "Confirmed?"},
+                  {"Id", "Type", "Shared Transaction Id", "Address", "Creation Time",
+                   "TTL Cutoff Height", "Confirmed?", "Height", "Confirmation Time",  "Num.",  "Num.", "Amount", "Amount", "Fee", "Net", "Payment", "Kernel", "Tx"} )
+{}
+
+void TransactionsRowSink::onLogEvent( const QString & message ) {
+    QStringList l = message.split('|');
+    Q_ASSERT(l.size()==2);
+    account = l[0];
+    height = l[1].toInt();
+}
 
-                if ( txLayout.size()>0 ) {
-                    curEvt++;
-                    break;
-                }
-                Q_ASSERT(false); // There is a small chance, but it is really not likely it is ok
-            }
-        }
+void TransactionsRowSink::onRow( const QString & line, const QVector<QString> & values ) {
+    // mwc713 has a special line for 'cancelled'
+    if (line.contains("- Cancelled")) {
+        transactions[lastTransId].cancelled();
+        return;
     }
 
-    // Skip header
-    for ( ; curEvt < events.size(); curEvt++ ) {
-        if (events[curEvt].event == WALLET_EVENTS::S_LINE) {
-            auto &str = events[curEvt].message;
-            if (str.startsWith("==============")) {
-                curEvt++; // skipping this
-                break;
-            }
-        }
-    }
-
-    QMap<int64_t, WalletTransaction > transactions;
-
-    // Processing transactions
-    int64_t lastTransId = -1;
-    for ( ; curEvt < events.size(); curEvt++ ) {
-        if (events[curEvt].event == WALLET_EVENTS::S_LINE ) {
-            auto &str = events[curEvt].message;
-
-            if (str.startsWith("--------------------"))
-                continue;
-
-            if (str.startsWith("=============="))
-                break; // multiple data types case, nned to handle without surprises
-
-
-            // mwc713 has a special line for 'cancelled'
-            if (str.contains("- Cancelled")) {
-                transactions[lastTransId].cancelled();
-                continue;
-            }
-
-            // Expected to be a normal line
-            WalletTransaction trans = parseTransactionLine(str, txLayout);
-            if ( trans.isValid() ) {
-                lastTransId = trans.txIdx;
-                transactions[trans.txIdx] = trans;
-            }
-        }
+    // Expected to be a normal line
+    WalletTransaction trans = parseTransactionLine(values);
+    if ( trans.isValid() ) {
+        lastTransId = trans.txIdx;
+        transactions[trans.txIdx] = trans;
     }
+}
 
-    trVector.clear();
-    for ( WalletTransaction & trItem : transactions )
+QVector<WalletTransaction> TransactionsRowSink::getTransactions() const {
+    QVector<WalletTransaction> trVector;
+    trVector.reserve(transactions.size());
+    for ( const WalletTransaction & trItem : transactions )
         trVector.push_back( trItem );
+    return trVector;
 }
 
-bool TaskTransactions::processTask(const QVector<WEvent> & events) {
+// local utility function that parse transactions output
+static void parseTransactions(const QVector<WEvent> & events, // in
+                                    QString & account, // out
+                                    int64_t & height,  // out
+                                    QVector<WalletTransaction> & trVector) // out
+{
+    TransactionsRowSink sink;
+    sink.processEvents(events);
 
-    QString account;
-    int64_t height = -1;
-    QVector<WalletTransaction> trVector;
+    account = sink.account;
+    height = sink.height;
+    trVector = sink.getTransactions();
+}
 
-    parseTransactions(events, // in
-                           account, height, trVector); // out
+TaskTransactions::~TaskTransactions() {
+    // Task was dropped or timed out
+    if (!reported)
+        wallet713->releasePendingQuery(queryKey);
+}
 
-    wallet713->setTransactions( account, height, trVector );
+bool TaskTransactions::processTask(const QVector<WEvent> & events) {
+    // Table lines was consumed by the rowSink as they come, events has the rest
+    Q_UNUSED(events);
+    reported = true;
+    wallet713->setTransactions( queryKey, rowSink.account, rowSink.height, rowSink.getTransactions() );
     return true;
 }
 
-// Just parse the messages
-static void parseMessages(const QVector<WEvent> & events, // in
-                         QVector<QString> & messages) // out
-{
-    int curEvt = 0;
+// Transaction messages table, no log event for it
+class MessagesRowSink : public TableRowSink {
+public:
+    MessagesRowSink() :
+        TableRowSink( WALLET_EVENTS::S_LINE, {"Participant Id", "Message", "Public Key", "Signature"},
+                      {"Participant Id", "Message", "Public Key" , "Signature"} ) {}
 
-    // positions for the columns. Note, the columns and the order are hardcoded and come from mwc713 data!!!
+    QVector<QString> messages;
 
-    QVector<int> messagesLayout;
+protected:
+    virtual void onRow( const QString & line, const QVector<QString> & values ) override {
+        Q_UNUSED(line);
+        if (values.isEmpty())
+            return;
 
-    // Continue with transaction output
-    // Search for Header first
-    for ( ; curEvt < events.size(); curEvt++ ) {
-        if (events[curEvt].event == WALLET_EVENTS::S_LINE ) {
-            auto & str = events[curEvt].message;
-            if ( str.contains("Participant Id") &&  str.contains("Message") && str.contains("Public Key") && str.contains("Signature") ) {
+        Q_ASSERT(values.size()==4);
 
-                messagesLayout = parseHeadersLine( str, {"Participant Id", "Message", "Public Key" , "Signature"} );
+        if ( values[3].length()<140 )
+            return;
 
-                if ( messagesLayout.size()>0 ) {
-                    curEvt++;
-                    break;
-                }
-                Q_ASSERT(false); // There is a small chance, but it is really not likely it is ok
-            }
+        // We don't care about other fields, just messages
+        int participant_id = values[0].toInt();
+        if (participant_id<0) {
+            Q_ASSERT(false);
+            return;
         }
-    }
+        Q_ASSERT(participant_id>=0 && participant_id<=1);
 
-    // Skip header
-    for ( ; curEvt < events.size(); curEvt++ ) {
-        if (events[curEvt].event == WALLET_EVENTS::S_LINE) {
-            auto &str = events[curEvt].message;
-            if (str.startsWith("==============")) {
-                curEvt++; // skipping this
-                break;
-            }
-        }
-    }
+        QString strMessage = values[1];
 
-    // Processing transactions messages
-    for ( ; curEvt < events.size(); curEvt++ ) {
-        if (events[curEvt].event == WALLET_EVENTS::S_LINE ) {
-            auto &str = events[curEvt].message;
+//        if (strMessage.isEmpty() || strMessage.compare("None", Qt::CaseInsensitive)==0)
+//            return;
 
-            if (str.startsWith("--------------------"))
-                continue;
+        if (strMessage.compare("None", Qt::CaseInsensitive)==0)
+            strMessage = "";
 
-            if (str.startsWith("=============="))
-                break; // multiple data types case, nned to handle without surprises
-
-            QVector<QString> values = parseDataLine(str, messagesLayout);
-            if (values.isEmpty())
-                continue;
-
-            Q_ASSERT(values.size()==4);
-
-            if ( values[3].length()<140 )
-                continue;
-
-            // We don't care about other fields, just messages
-            int participant_id = values[0].toInt();
-            if (participant_id<0) {
-                Q_ASSERT(false);
-                continue;
-            }
-            Q_ASSERT(participant_id>=0 && participant_id<=1);
-
-            QString strMessage = values[1];
-
-//            if (strMessage.isEmpty() || strMessage.compare("None", Qt::CaseInsensitive)==0)
-//                continue;
-
-            if (strMessage.compare("None", Qt::CaseInsensitive)==0)
-                strMessage = "";
-
-            messages.resize( std::max(messages.length(), participant_id+1) );
-            messages[participant_id] = strMessage;
-        }
+        messages.resize( std::max(messages.length(), participant_id+1) );
+        messages[participant_id] = strMessage;
     }
+};
+
+// Just parse the messages
+static void parseMessages(const QVector<WEvent> & events, // in
+                         QVector<QString> & messages) // out
+{
+    MessagesRowSink sink;
+    sink.processEvents(events);
+    messages = sink.messages;
 }
 
 QString TaskTransactionsById::buildCommandLine(QString txIdxOrUUID) const {
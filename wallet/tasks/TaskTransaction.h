@@ -16,26 +16,68 @@
 #define MWC_QT_WALLET_TASKTRANSACTION_H
 
 #include "../mwc713task.h"
+#include "../wallet.h"
+#include <QMap>
 #include "../../util/stringutils.h"
 
 namespace wallet {
 
+// 'outputs' table streaming parser
+class OutputsRowSink : public TableRowSink {
+public:
+    OutputsRowSink();
+
+    QString account;
+    int64_t height = -1;
+    QVector<WalletOutput> outputs;
+
+protected:
+    virtual void onLogEvent( const QString & message ) override;
+    virtual void onRow( const QString & line, const QVector<QString> & values ) override;
+};
+
+// 'txs' table streaming parser
+class TransactionsRowSink : public TableRowSink {
+public:
+    TransactionsRowSink();
+
+    QVector<WalletTransaction> getTransactions() const;
+
+    QString account;
+    int64_t height = -1;
+
+protected:
+    virtual void onLogEvent( const QString & message ) override;
+    virtual void onRow( const QString & line, const QVector<QString> & values ) override;
+
+private:
+    QMap<int64_t, WalletTransaction > transactions;
+    int64_t lastTransId = -1;
+};
 
 class TaskOutputs : public Mwc713Task {
 public:
     const static int64_t TIMEOUT = 1000*15;
 
     // Outputs run with no-refresh because wallet responsible to call sync first
-    TaskOutputs( MWC713 * wallet713, bool show_spent ) :
-        Mwc713Task("Outputs", "Requesting outputs...", QString("outputs") + (show_spent?" --show-spent":"") + " --no-refresh" , wallet713, "") {showSpent=show_spent;}
+    // queryKey - key of the coalesced query that is waiting for the result
+    TaskOutputs( MWC713 * wallet713, bool show_spent, QString _queryKey ) :
+        Mwc713Task("Outputs", "Requesting outputs...", QString("outputs") + (show_spent?" --show-spent":"") + " --no-refresh" , wallet713, ""),
+        showSpent(show_spent), queryKey(_queryKey) {}
+
+    virtual ~TaskOutputs() override;
 
-    virtual ~TaskOutputs() override {}
+    virtual TableRowSink * getRowSink() override {return &rowSink;}
+    virtual bool isScaledByWalletSize() const override {return true;}
 
     virtual bool processTask(const QVector<WEvent> & events) override;
 
     virtual QSet<WALLET_EVENTS> getReadyEvents() override {return { WALLET_EVENTS::S_READY };}
 private:
     bool showSpent;
+    QString queryKey;
+    bool reported = false; // false - requesters of queryKey are released at the destructor
+    OutputsRowSink rowSink;
 };
 
 // Get outputs and deliver them directly to HODL status
@@ -49,11 +91,15 @@ public:
 
     virtual ~TaskOutputsForAccount() override {}
 
+    virtual TableRowSink * getRowSink() override {return &rowSink;}
+    virtual bool isScaledByWalletSize() const override {return true;}
+
     virtual bool processTask(const QVector<WEvent> & events) override;
 
     virtual QSet<WALLET_EVENTS> getReadyEvents() override {return { WALLET_EVENTS::S_READY };}
 private:
     QString accountName;
+    OutputsRowSink rowSink;
 };
 
 class TaskTransactions : public Mwc713Task {
@@ -61,14 +107,22 @@ public:
     const static int64_t TIMEOUT = 1000*60;
 
     // Transactions run with no-refresh because wallet responsible to call sync first
-    TaskTransactions( MWC713 * wallet713) :
-            Mwc713Task("Transactions", "Requesting transactions...", "txs --show-full --no-refresh", wallet713, "") {}
+    // queryKey - key of the coalesced query that is waiting for the result
+    TaskTransactions( MWC713 * wallet713, QString _queryKey) :
+            Mwc713Task("Transactions", "Requesting transactions...", "txs --show-full --no-refresh", wallet713, ""), queryKey(_queryKey) {}
+
+    virtual ~TaskTransactions() override;
 
-    virtual ~TaskTransactions() override {}
+    virtual TableRowSink * getRowSink() override {return &rowSink;}
+    virtual bool isScaledByWalletSize() const override {return true;}
 
     virtual bool processTask(const QVector<WEvent> & events) override;
 
     virtual QSet<WALLET_EVENTS> getReadyEvents() override {return { WALLET_EVENTS::S_READY };}
+private:
+    QString queryKey;
+    bool reported = false; // false - requesters of queryKey are released at the destructor
+    TransactionsRowSink rowSink;
 };
 
 class TaskTransactionsById : public Mwc713Task {
@@ -81,6 +135,8 @@ public:
 
     virtual ~TaskTransactionsById() override {}
 
+    virtual bool isScaledByWalletSize() const override {return true;}
+
     virtual bool processTask(const QVector<WEvent> & events) override;
 
     virtual QSet<WALLET_EVENTS> getReadyEvents() override {return { WALLET_EVENTS::S_READY };}
@@ -24,6 +24,8 @@
 #include "../core/appcontext.h"
 #include <QJsonObject>
 #include <QJsonDocument>
+#include <QHash>
+#include <algorithm>
 
 namespace wallet {
 
@@ -73,6 +75,40 @@ QString AccountInfo::toString() const {
                " awaiting=" + util::nano2one(awaitingConfirmation) + ")";
 }
 
+void AccountInfo::saveData(QDataStream & out) const {
+    out << 0x3487a1;
+    out << accountName;
+    out << qint64(height);
+    out << qint64(total);
+    out << qint64(awaitingConfirmation);
+    out << qint64(lockedByPrevTransaction);
+    out << qint64(currentlySpendable);
+    out << mwcServerBroken;
+}
+
+bool AccountInfo::loadData(QDataStream & in) {
+    int id = 0;
+    in >> id;
+    if (id!=0x3487a1)
+        return false;
+
+    qint64 h = 0, tot = 0, awaiting = 0, locked = 0, spendable = 0;
+    in >> accountName;
+    in >> h;
+    in >> tot;
+    in >> awaiting;
+    in >> locked;
+    in >> spendable;
+    in >> mwcServerBroken;
+
+    height = h;
+    total = tot;
+    awaitingConfirmation = awaiting;
+    lockedByPrevTransaction = locked;
+    currentlySpendable = spendable;
+    return in.status() == QDataStream::Ok;
+}
+
 
 void MwcNodeConnection::saveData(QDataStream & out) const {
     int id = 0x4355a2;
@@ -395,9 +431,110 @@ WalletTransaction WalletTransaction::fromJson(QString str) {
     return res;
 }
 
+void WalletTransaction::saveData(QDataStream & out) const {
+    out << 0x3487b1;
+    out << qint64(txIdx);
+    out << transactionType;
+    out << txid;
+    out << address;
+    out << creationTime;
+    out << qint64(ttlCutoffHeight);
+    out << confirmed;
+    out << qint64(height);
+    out << confirmationTime;
+    out << numInputs;
+    out << numOutputs;
+    out << qint64(credited);
+    out << qint64(debited);
+    out << qint64(fee);
+    out << qint64(coinNano);
+    out << proof;
+    out << kernel;
+}
+
+bool WalletTransaction::loadData(QDataStream & in) {
+    int id = 0;
+    in >> id;
+    if (id!=0x3487b1)
+        return false;
+
+    qint64 idx = 0, ttl = 0, h = 0, cr = 0, db = 0, f = 0, coin = 0;
+    in >> idx;
+    in >> transactionType;
+    in >> txid;
+    in >> address;
+    in >> creationTime;
+    in >> ttl;
+    in >> confirmed;
+    in >> h;
+    in >> confirmationTime;
+    in >> numInputs;
+    in >> numOutputs;
+    in >> cr;
+    in >> db;
+    in >> f;
+    in >> coin;
+    in >> proof;
+    in >> kernel;
+
+    txIdx = idx;
+    ttlCutoffHeight = ttl;
+    height = h;
+    credited = cr;
+    debited = db;
+    fee = f;
+    coinNano = coin;
+    return in.status() == QDataStream::Ok;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////
+//  TransactionsDelta
+
+static bool isTransactionChanged(const WalletTransaction & a, const WalletTransaction & b) {
+    return a.transactionType != b.transactionType || a.confirmed != b.confirmed || a.height != b.height ||
+           a.confirmationTime != b.confirmationTime || a.coinNano != b.coinNano || a.proof != b.proof ||
+           a.kernel != b.kernel || a.txid != b.txid;
+}
+
+// static
+TransactionsDelta TransactionsDelta::calc( const QString & account, int64_t height,
+                                           const QVector<WalletTransaction> & prev, const QVector<WalletTransaction> & next ) {
+    TransactionsDelta res;
+    res.account = account;
+    res.height = height;
+
+    QHash<int64_t, int> prevIdx;
+    prevIdx.reserve(prev.size());
+    for (int i=0; i<prev.size(); i++)
+        prevIdx.insert(prev[i].txIdx, i);
+
+    for (const auto & tx : next) {
+        auto p = prevIdx.find(tx.txIdx);
+        if (p == prevIdx.end()) {
+            res.inserted.push_back(tx);
+            continue;
+        }
+        if (isTransactionChanged(prev[p.value()], tx))
+            res.updated.push_back(tx);
+        prevIdx.erase(p);
+    }
+    // Not found in the new listing
+    for (auto p = prevIdx.constBegin(); p != prevIdx.constEnd(); p++)
+        res.removed.push_back(p.key());
+    std::sort(res.removed.begin(), res.removed.end());
+
+    return res;
+}
+
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////
 //  WalletOutput
 
+static int64_t str2num(const QString & str) {
+    bool ok = false;
+    int64_t res = str.toLongLong(&ok);
+    return ok ? res : -1;
+}
+
 void WalletOutput::setData(QString _outputCommitment,
         QString     _MMRIndex,
         QString     _blockHeight,
@@ -408,31 +545,105 @@ void WalletOutput::setData(QString _outputCommitment,
         int64_t     _valueNano,
         int64_t     _txIdx)
 {
-    outputCommitment = _outputCommitment;
-    MMRIndex = _MMRIndex;
-    blockHeight = _blockHeight;
-    lockedUntil = _lockedUntil;
-    status = _status;
+    commitmentText.clear();
+    commitmentHex.clear();
+    commitment.fill(0);
+    if (hex2commitment(_outputCommitment, commitment))
+        hasCommitment = true;
+    else {
+        commitmentText = _outputCommitment;
+        hasCommitment = !commitmentText.isEmpty();
+    }
+
+    mmrIndex = str2num(_MMRIndex);
+    blockHeight = str2num(_blockHeight);
+    lockedUntil = str2num(_lockedUntil);
+    status = str2status(_status);
+    statusText = status==STATUS::UNKNOWN ? _status : QString();
     coinbase = _coinbase;
-    numOfConfirms = _numOfConfirms;
+    numOfConfirms = str2num(_numOfConfirms);
     valueNano = _valueNano;
     txIdx = _txIdx;
 }
 
+QString WalletOutput::getOutputCommitment() const {
+    if (!commitmentText.isEmpty() || !hasCommitment)
+        return commitmentText;
+
+    if (commitmentHex.isEmpty())
+        commitmentHex = QString::fromLatin1( QByteArray::fromRawData( reinterpret_cast<const char *>(commitment.data()), COMMITMENT_SIZE ).toHex() );
+    return commitmentHex;
+}
+
+//static
+WalletOutput::STATUS WalletOutput::str2status(const QString & str) {
+    if (str == "Unspent")
+        return STATUS::UNSPENT;
+    if (str == "Unconfirmed")
+        return STATUS::UNCONFIRMED;
+    if (str == "Locked")
+        return STATUS::LOCKED;
+    if (str == "Spent")
+        return STATUS::SPENT;
+    if (str == "Reverted")
+        return STATUS::REVERTED;
+    return STATUS::UNKNOWN;
+}
+
+//static
+QString WalletOutput::status2str(STATUS status) {
+    switch (status) {
+        case STATUS::UNCONFIRMED: return "Unconfirmed";
+        case STATUS::UNSPENT:     return "Unspent";
+        case STATUS::LOCKED:      return "Locked";
+        case STATUS::SPENT:       return "Spent";
+        case STATUS::REVERTED:    return "Reverted";
+        default:                  return "";
+    }
+}
+
+static int hexDigit(ushort ch) {
+    if (ch>='0' && ch<='9')
+        return ch-'0';
+    if (ch>='a' && ch<='f')
+        return ch-'a'+10;
+    if (ch>='A' && ch<='F')
+        return ch-'A'+10;
+    return -1;
+}
+
+//static
+bool WalletOutput::hex2commitment(const QString & hex, Commitment & res) {
+    if (hex.size() != COMMITMENT_SIZE*2)
+        return false;
+
+    Commitment c;
+    for (int i=0; i<COMMITMENT_SIZE; i++) {
+        int hi = hexDigit(hex[i*2].unicode());
+        int lo = hexDigit(hex[i*2+1].unicode());
+        if (hi<0 || lo<0)
+            return false;
+        c[i] = uint8_t( (hi<<4) | lo );
+    }
+    res = c;
+    return true;
+}
+
 QString WalletOutput::toString() const {
-    return  "Output(" + outputCommitment + ", MMR=" + MMRIndex + ", Height=" + blockHeight + ", Locked=" + lockedUntil + ", status=" +
-            status + ", coinbase=" + (coinbase?"true":"false") + ", confirms=" + numOfConfirms, ", value=" + QString::number(valueNano) + ", txIdx=" + txIdx + ")";
+    return  "Output(" + getOutputCommitment() + ", MMR=" + getMMRIndex() + ", Height=" + getBlockHeight() + ", Locked=" + getLockedUntil() + ", status=" +
+            getStatus() + ", coinbase=" + (coinbase?"true":"false") + ", confirms=" + getNumOfConfirms() + ", value=" + QString::number(valueNano) + ", txIdx=" + QString::number(txIdx) + ")";
 }
 
+// Json is used by QML, keeping string values
 QString WalletOutput::toJson() const {
     QJsonObject obj;
-    obj.insert("outputCommitment", outputCommitment);
-    obj.insert("MMRIndex", MMRIndex);
-    obj.insert("blockHeight", blockHeight);
-    obj.insert("lockedUntil", lockedUntil);
-    obj.insert("status", status);
+    obj.insert("outputCommitment", getOutputCommitment());
+    obj.insert("MMRIndex", getMMRIndex());
+    obj.insert("blockHeight", getBlockHeight());
+    obj.insert("lockedUntil", getLockedUntil());
+    obj.insert("status", getStatus());
     obj.insert("coinbase", coinbase);
-    obj.insert("numOfConfirms", numOfConfirms);
+    obj.insert("numOfConfirms", getNumOfConfirms());
     obj.insert("valueNano", QString::number(valueNano) );
     obj.insert("txIdx", QString::number(txIdx) );
     obj.insert("weight", weight);
@@ -462,6 +673,146 @@ WalletOutput WalletOutput::fromJson(QString str) {
     return res;
 }
 
+void WalletOutput::saveData(QDataStream & out) const {
+    out << 0x3487c3;
+    out << hasCommitment;
+    out << commitmentText;
+    out.writeRawData( reinterpret_cast<const char *>(commitment.data()), COMMITMENT_SIZE );
+    out << qint64(mmrIndex);
+    out << qint64(blockHeight);
+    out << qint64(lockedUntil);
+    out << qint64(numOfConfirms);
+    out << qint64(valueNano);
+    out << qint64(txIdx);
+    out << weight;
+    out << quint8(status);
+    out << statusText;
+    out << coinbase;
+}
+
+bool WalletOutput::loadData(QDataStream & in) {
+    int id = 0;
+    in >> id;
+    // 0x3487c2 - before the unknown status text
+    if (id!=0x3487c2 && id!=0x3487c3)
+        return false;
+
+    qint64 mmr = 0, height = 0, locked = 0, confirms = 0, value = 0, idx = 0;
+    quint8 st = 0;
+    in >> hasCommitment;
+    in >> commitmentText;
+    if (in.readRawData( reinterpret_cast<char *>(commitment.data()), COMMITMENT_SIZE ) != COMMITMENT_SIZE)
+        return false;
+    in >> mmr;
+    in >> height;
+    in >> locked;
+    in >> confirms;
+    in >> value;
+    in >> idx;
+    in >> weight;
+    in >> st;
+    statusText.clear();
+    if (id==0x3487c3)
+        in >> statusText;
+    in >> coinbase;
+    commitmentHex.clear();
+
+    mmrIndex = mmr;
+    blockHeight = height;
+    lockedUntil = locked;
+    numOfConfirms = confirms;
+    valueNano = value;
+    txIdx = idx;
+    status = st <= quint8(STATUS::REVERTED) ? STATUS(st) : STATUS::UNKNOWN;
+    return in.status() == QDataStream::Ok;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////
+//  OutputsDelta
+
+// Confirmations are derived from the node height, they are changing for every output with every block.
+// UI is expected to show them from the height.
+static bool isOutputChanged(const WalletOutput & a, const WalletOutput & b) {
+    return a.status != b.status || a.statusText != b.statusText || a.blockHeight != b.blockHeight ||
+           a.lockedUntil != b.lockedUntil || a.mmrIndex != b.mmrIndex || a.valueNano != b.valueNano ||
+           a.txIdx != b.txIdx || a.coinbase != b.coinbase;
+}
+
+// static
+OutputsDelta OutputsDelta::calc( const QString & account, int64_t height,
+                                 const QVector<WalletOutput> & prev, const QVector<WalletOutput> & next ) {
+    OutputsDelta res;
+    res.account = account;
+    res.height = height;
+
+    QHash<QString, int> prevIdx;
+    prevIdx.reserve(prev.size());
+    for (int i=0; i<prev.size(); i++)
+        prevIdx.insert(prev[i].getOutputCommitment(), i);
+
+    for (const auto & out : next) {
+        auto p = prevIdx.find(out.getOutputCommitment());
+        if (p == prevIdx.end()) {
+            res.inserted.push_back(out);
+            continue;
+        }
+        if (isOutputChanged(prev[p.value()], out))
+            res.updated.push_back(out);
+        prevIdx.erase(p);
+    }
+    for (auto p = prevIdx.constBegin(); p != prevIdx.constEnd(); p++)
+        res.removed.push_back(p.key());
+
+    return res;
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////
+//  HistoryQuery
+
+static int64_t jsonInt64(const QJsonObject & obj, const QString & key) {
+    QJsonValue v = obj.value(key);
+    if (v.isString())
+        return v.toString().toLongLong();
+    return v.isDouble() ? int64_t(v.toDouble()) : -1;
+}
+
+static int64_t jsonAmount(const QJsonObject & obj, const QString & key) {
+    QString str = obj.value(key).toString().trimmed();
+    if (str.isEmpty())
+        return -1;
+    QPair<bool,int64_t> nano = util::one2nano(str);
+    return nano.first ? nano.second : -1;
+}
+
+// static
+HistoryQuery HistoryQuery::fromJson(const QString & str) {
+    HistoryQuery res;
+    QJsonParseError error;
+    QJsonDocument jsonDoc = QJsonDocument::fromJson(str.toUtf8(), &error);
+    if (error.error != QJsonParseError::NoError || !jsonDoc.isObject())
+        return res;
+
+    QJsonObject obj = jsonDoc.object();
+    res.account = obj.value("account").toString();
+    res.text = obj.value("text").toString();
+    res.addressPrefix = obj.value("addressPrefix").toString();
+    res.uuidPrefix = obj.value("uuidPrefix").toString();
+    res.kernelPrefix = obj.value("kernelPrefix").toString();
+    res.minAmount = jsonAmount(obj, "minAmount");
+    res.maxAmount = jsonAmount(obj, "maxAmount");
+    res.minHeight = jsonInt64(obj, "minHeight");
+    res.maxHeight = jsonInt64(obj, "maxHeight");
+    res.fromTime = jsonInt64(obj, "fromTime");
+    res.toTime = jsonInt64(obj, "toTime");
+    res.types = uint(obj.value("types").toInt(0));
+    res.confirmed = obj.value("confirmed").toInt(-1);
+    res.cancelled = obj.value("cancelled").toInt(-1);
+    res.offset = obj.value("offset").toInt(0);
+    res.count = obj.value("count").toInt(100);
+    return res;
+}
+
 
 ///////////////////////////////////////////////////////////////////////////////////////////
 //  WalletUtxoSignature
@@ -21,6 +21,8 @@
 #include "../util/stringutils.h"
 #include <QDateTime>
 #include <QObject>
+#include <QJsonObject>
+#include <array>
 
 namespace core {
 class AppContext;
@@ -33,6 +35,8 @@ class MwcNode;
 
 namespace wallet {
 
+class HistoryStore;
+
 struct AccountInfo {
     QString accountName = "default";
     int64_t height = 0;
@@ -65,6 +69,9 @@ struct AccountInfo {
     // Debug/Log printing
     QString toString() const;
 
+    void saveData(QDataStream & out) const;
+    bool loadData(QDataStream & in);
+
     bool balancesAreEquals(const AccountInfo & accInfo) const;
 };
 
@@ -168,18 +175,26 @@ public:
 };
 
 struct WalletOutput {
-
-    QString    outputCommitment;
-    QString    MMRIndex;
-    QString    blockHeight;
-    QString    lockedUntil;
-    QString    status;
-    bool       coinbase = false;
-    QString    numOfConfirms;
+    enum class STATUS : uint8_t { UNKNOWN=0, UNCONFIRMED, UNSPENT, LOCKED, SPENT, REVERTED };
+    enum { COMMITMENT_SIZE = 33 };
+    typedef std::array<uint8_t, COMMITMENT_SIZE> Commitment;
+
+    // Typed compact data. Wallets can have 100k+ outputs, so no strings here.
+    Commitment commitment{};       // binary commitment, valid if commitmentText is empty
+    QString    commitmentText;     // Only if mwc713 printed something that is not a 33 byte hex. Normally null
+    QString    statusText;         // Only if mwc713 printed a status that we don't know. Normally null
+    int64_t    mmrIndex = -1;      // -1 - None
+    int64_t    blockHeight = -1;
+    int64_t    lockedUntil = -1;
+    int64_t    numOfConfirms = -1;
     int64_t    valueNano = 0L;
-    int64_t    txIdx;
+    int64_t    txIdx = -1;
     double     weight = 0.0; // HODL weight, used for ouptus optimization
+    STATUS     status = STATUS::UNKNOWN;
+    bool       coinbase = false;
+    bool       hasCommitment = false;
 
+    // String adapter for mwc713 parser and tests
     void setData(QString outputCommitment,
             QString     MMRIndex,
             QString     blockHeight,
@@ -207,18 +222,40 @@ struct WalletOutput {
         return item;
     }
 
+    // String views for UI, the same values that mwc713 printed
+    QString getOutputCommitment() const;
+    QString getMMRIndex() const {return mmrIndex<0 ? "None" : QString::number(mmrIndex);}
+    QString getBlockHeight() const {return num2str(blockHeight);}
+    QString getLockedUntil() const {return num2str(lockedUntil);}
+    QString getStatus() const {return status==STATUS::UNKNOWN ? statusText : status2str(status);}
+    QString getNumOfConfirms() const {return num2str(numOfConfirms);}
+
+    static STATUS str2status(const QString & str);
+    static QString status2str(STATUS status);
+    // Parse 66 chars hex string. Return false if it is not a commitment.
+    static bool hex2commitment(const QString & hex, Commitment & res);
+
     QString toString() const;
 
     bool isValid() const {
-        return !(outputCommitment.isEmpty() || status.isEmpty());
+        return hasCommitment && (status!=STATUS::UNKNOWN || !statusText.isEmpty());
     }
 
     double getWeightedValue() const {return weight*valueNano; }
 
-    bool isUnspent() const {return status == "Unspent";}
+    bool isUnspent() const {return status == STATUS::UNSPENT;}
 
     QString toJson() const;
     static WalletOutput fromJson(QString str);
+
+    void saveData(QDataStream & out) const;
+    bool loadData(QDataStream & in);
+
+private:
+    static QString num2str(int64_t val) {return val<0 ? "" : QString::number(val);}
+
+    // Hex of the binary commitment, built on the first request. UI and locks ask for it many times.
+    mutable QString commitmentHex;
 };
 
 struct WalletTransaction {
@@ -314,6 +351,66 @@ struct WalletTransaction {
 
     QString toJson() const;
     static WalletTransaction fromJson(QString str);
+
+    void saveData(QDataStream & out) const;
+    bool loadData(QDataStream & in);
+};
+
+// Changes between two 'txs' listings of the account. Transactions are matched by txIdx.
+struct TransactionsDelta {
+    QString account;
+    int64_t height = -1;
+    QVector<WalletTransaction> inserted;
+    QVector<WalletTransaction> updated;  // status, height, confirmation or cancellation was changed
+    QVector<int64_t>           removed;  // txIdx
+
+    bool isEmpty() const {return inserted.isEmpty() && updated.isEmpty() && removed.isEmpty();}
+
+    static TransactionsDelta calc( const QString & account, int64_t height,
+                                   const QVector<WalletTransaction> & prev, const QVector<WalletTransaction> & next );
+};
+
+// Changes between two 'outputs' listings of the account. Outputs are matched by commitment.
+struct OutputsDelta {
+    QString account;
+    int64_t height = -1;
+    QVector<WalletOutput> inserted;
+    QVector<WalletOutput> updated;  // status, height or lock height was changed. Confirmations are not compared
+    QVector<QString>      removed;  // commitments
+
+    bool isEmpty() const {return inserted.isEmpty() && updated.isEmpty() && removed.isEmpty();}
+
+    static OutputsDelta calc( const QString & account, int64_t height,
+                              const QVector<WalletOutput> & prev, const QVector<WalletOutput> & next );
+};
+
+// Search over the local transactions history. Empty/-1 fields are not applied.
+struct HistoryQuery {
+    QString account;
+    QString text;          // Case insensitive substring of UUID, address, kernel or transaction note
+    QString addressPrefix; // Case insensitive prefixes
+    QString uuidPrefix;
+    QString kernelPrefix;
+    int64_t minAmount = -1; // Absolute coinNano value
+    int64_t maxAmount = -1;
+    int64_t minHeight = -1;
+    int64_t maxHeight = -1;
+    int64_t fromTime = -1;  // Creation time, msecs since epoch
+    int64_t toTime = -1;
+    uint    types = 0;      // SEND|RECEIVE|COIN_BASE of WalletTransaction::TRANSACTION_TYPE, 0 - any
+    int     confirmed = -1; // 0 - unconfirmed only, 1 - confirmed only
+    int     cancelled = -1; // 0 - not cancelled only, 1 - cancelled only
+    int     offset = 0;
+    int     count = 100;
+
+    // Amounts are MWC strings, times are msecs, other numbers as in WalletTransaction::toJson
+    static HistoryQuery fromJson(const QString & str);
+};
+
+struct HistoryQueryResult {
+    int total = 0; // Number of matched transactions
+    QVector<WalletTransaction> transactions; // Requested page, newest first
+    QString error; // Not empty if local history is not available, nothing was searched
 };
 
 struct WalletUtxoSignature {
@@ -517,9 +614,18 @@ public:
     // This info needed in many cases and we don't want spend time every time for that.
     virtual QVector<AccountInfo> getWalletBalance(bool filterDeleted = true) const  = 0;
 
+    // Balances can be restored from the cache at login. They are stale and shown until
+    // the first balance refresh is done. Return the height of that restored data, -1 if data is fresh.
+    virtual int64_t getWarmStartHeight() const = 0;
+
     // Get outputs that was collected for this wallet. Outputs should be ready with balances
     virtual const QMap<QString, QVector<wallet::WalletOutput> > & getwalletOutputs() const = 0;
 
+    // Local copy of the transactions and outputs history. Read only, it is updated by the listings.
+    virtual const HistoryStore & getHistoryStore() const = 0;
+    // Search over the local history, transaction notes are included
+    virtual HistoryQueryResult searchHistory(const HistoryQuery & query) = 0;
+
     virtual QString getCurrentAccountName()  = 0;
 
     // Request Wallet balance update. It is a multistep operation
@@ -564,6 +670,11 @@ public:
     // Check Signal: onNodeStatus( bool online, QString errMsg, int nodeHeight, int peerHeight, int64_t totalDifficulty, int connections )
     virtual bool getNodeStatus() = 0;
 
+    // Task engine metrics: latency histograms by task and queue depth by priority.
+    virtual QJsonObject getTaskMetrics() const = 0;
+    // Dump task engine metrics into the json file. Return error message or empty string on success
+    virtual QString dumpTaskMetrics(QString fileName) const = 0;
+
     // Set account that will receive the funds
     // Check Signal:  onSetReceiveAccount( bool ok, QString AccountOrMessage );
     virtual void setReceiveAccount(QString account)  = 0;
@@ -627,12 +738,14 @@ public:
 
 
     // Show outputs for the wallet
-    // Check Signal: onOutputs( QString account, int64_t height, QVector<WalletOutput> outputs)
-    virtual void getOutputs(QString account, bool show_spent, bool enforceSync)  = 0;
+    // cookie - requester tag, it will be returned back with result. Identical requests might share the same result.
+    // Check Signal: onOutputs( QString account, bool showSpent, int64_t height, QVector<WalletOutput> outputs, QString cookie)
+    virtual void getOutputs(QString account, bool show_spent, bool enforceSync, QString cookie = "")  = 0;
 
     // Show all transactions for current account
-    // Check Signal: onTransactions( QString account, int64_t height, QVector<WalletTransaction> Transactions)
-    virtual void getTransactions(QString account, bool enforceSync)  = 0;
+    // cookie - requester tag, it will be returned back with result. Identical requests might share the same result.
+    // Check Signal: onTransactions( QString account, int64_t height, QVector<WalletTransaction> Transactions, QString cookie)
+    virtual void getTransactions(QString account, bool enforceSync, QString cookie = "")  = 0;
 
     // get Extended info for specific transaction
     // Check Signal: onTransactionById( bool success, QString account, int64_t height, WalletTransaction transaction, QVector<WalletOutput> outputs, QVector<QString> messages )
@@ -809,14 +922,18 @@ signals:
     void onSetReceiveAccount( bool ok, QString AccountOrMessage );
 
     // Transactions
-    void onTransactions( QString account, int64_t height, QVector<WalletTransaction> Transactions);
+    void onTransactions( QString account, int64_t height, QVector<WalletTransaction> Transactions, QString cookie);
     void onCancelTransacton( bool success, QString account, int64_t trIdx, QString errMessage );
 
     void onTransactionById( bool success, QString account, int64_t height, WalletTransaction transaction, QVector<WalletOutput> outputs, QVector<QString> messages );
 
     void onAllTransactions( QVector<WalletTransaction> Transactions);
 
-    void onOutputs( QString account, bool showSpent, int64_t height, QVector<WalletOutput> outputs);
+    void onOutputs( QString account, bool showSpent, int64_t height, QVector<WalletOutput> outputs, QString cookie);
+
+    // Changes since the previous listing of the account. Emitted before onTransactions/onOutputs, only if something changed.
+    void onTransactionsDelta( wallet::TransactionsDelta delta );
+    void onOutputsDelta( wallet::OutputsDelta delta );
 
     void onCheckResult(bool ok, QString errors );
 
@@ -894,6 +1011,8 @@ signals:
 
 Q_DECLARE_METATYPE(wallet::WalletTransaction);
 Q_DECLARE_METATYPE(wallet::WalletOutput);
+Q_DECLARE_METATYPE(wallet::TransactionsDelta);
+Q_DECLARE_METATYPE(wallet::OutputsDelta);
 Q_DECLARE_METATYPE(wallet::SwapInfo);
 Q_DECLARE_METATYPE(wallet::SwapTradeInfo);
 Q_DECLARE_METATYPE(wallet::SwapExecutionPlanRecord);
@@ -0,0 +1,129 @@
+// Copyright 2019 The MWC Developers
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "walletcache.h"
+#include <QSaveFile>
+#include <QFile>
+#include <QDataStream>
+#include "../util/ioutils.h"
+#include "../util/crypto.h"
+#include "../util/Log.h"
+
+namespace wallet {
+
+// Cache format. Increase the version if format is changed, old cache will be ignored.
+static const int WALLET_CACHE_ID = 0x5A71C0;
+static const int WALLET_CACHE_VERSION = 3;
+
+// static
+QString WalletCache::getFileName(const QString & dataPath) {
+    QPair<bool,QString> contextPath = ioutils::getAppDataPath("context");
+    if (!contextPath.first || dataPath.isEmpty())
+        return "";
+
+    // Data path might contain any symbols, using hash for the file name
+    return contextPath.second + "/walletcache_" + crypto::calcHSA256Hash(dataPath).left(16) + ".dat";
+}
+
+// Load cache for the data path. Return false if there is no valid cache.
+bool WalletCache::load(const QString & dataPath) {
+    *this = WalletCache();
+
+    const QString fileName = getFileName(dataPath);
+    if (fileName.isEmpty())
+        return false;
+
+    QFile file(fileName);
+    if ( !file.open(QIODevice::ReadOnly) )
+        return false; // No cache yet
+
+    QDataStream in(&file);
+    in.setVersion(QDataStream::Qt_5_7);
+
+    int id = 0;
+    int version = 0;
+    QString path;
+    in >> id;
+    in >> version;
+    if (id != WALLET_CACHE_ID || version != WALLET_CACHE_VERSION)
+        return false;
+
+    in >> path;
+    if (path != dataPath)
+        return false; // hash collision, very unlikely
+
+    qint64 h = 0, t = 0;
+    in >> h;
+    in >> t;
+
+    int sz = 0;
+    in >> sz;
+    for (int i=0; i<sz && in.status() == QDataStream::Ok; i++) {
+        AccountInfo ai;
+        if (!ai.loadData(in))
+            return false;
+        accounts.push_back(ai);
+    }
+
+    if (in.status() != QDataStream::Ok) {
+        logger::logInfo("WalletCache", "Unable to read the wallet cache " + fileName );
+        *this = WalletCache();
+        return false;
+    }
+
+    height = h;
+    time = t;
+    return true;
+}
+
+// Save the cache for the data path. Write is atomic, either old or new data will be at the disk.
+bool WalletCache::save(const QString & dataPath) const {
+    const QString fileName = getFileName(dataPath);
+    if (fileName.isEmpty())
+        return false;
+
+    QSaveFile file(fileName);
+    if ( !file.open(QIODevice::WriteOnly) ) {
+        logger::logInfo("WalletCache", "Unable to save the wallet cache " + fileName + ", " + file.errorString() );
+        return false;
+    }
+
+    QDataStream out(&file);
+    out.setVersion(QDataStream::Qt_5_7);
+
+    out << WALLET_CACHE_ID;
+    out << WALLET_CACHE_VERSION;
+    out << dataPath;
+    out << qint64(height);
+    out << qint64(time);
+
+    out << accounts.size();
+    for (const auto & ai : accounts)
+        ai.saveData(out);
+
+    if (out.status() != QDataStream::Ok || !file.commit()) {
+        logger::logInfo("WalletCache", "Unable to save the wallet cache " + fileName );
+        return false;
+    }
+    return true;
+}
+
+// Delete the cache file for the data path
+void WalletCache::remove(const QString & dataPath) {
+    const QString fileName = getFileName(dataPath);
+    if (!fileName.isEmpty())
+        QFile::remove(fileName);
+}
+
+}
@@ -0,0 +1,52 @@
+// Copyright 2019 The MWC Developers
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MWC_QT_WALLET_WALLETCACHE_H
+#define MWC_QT_WALLET_WALLETCACHE_H
+
+#include <QString>
+#include <QVector>
+#include "wallet.h"
+
+namespace wallet {
+
+// Last known balances summary for the wallet instance. It is stored per wallet data path
+// into the app context directory, so the balances can be shown right after the login while mwc713 is
+// doing the sync and refresh.
+// The file is not encrypted, so only the account balances are stored. Outputs and transactions
+// (commitments, addresses, amounts) are never written here. Restored data is stale until the first refresh,
+// see Wallet::getWarmStartHeight.
+struct WalletCache {
+    int64_t height = -1; // Height of the data, -1 - no data
+    int64_t time = 0;    // When cache was saved, ms
+    QVector<AccountInfo> accounts;
+
+    bool isEmpty() const {return accounts.isEmpty();}
+
+    // Load cache for the data path. Return false if there is no valid cache.
+    bool load(const QString & dataPath);
+
+    // Save the cache for the data path. Write is atomic, either old or new data will be at the disk.
+    bool save(const QString & dataPath) const;
+
+    // Delete the cache file for the data path
+    static void remove(const QString & dataPath);
+
+private:
+    static QString getFileName(const QString & dataPath);
+};
+
+}
+
+#endif //MWC_QT_WALLET_WALLETCACHE_H
@@ -0,0 +1,76 @@
+// Copyright 2019 The MWC Developers
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "walletsnapshot.h"
+
+namespace wallet {
+
+static QVector<QString> outputs2json(const QVector<WalletOutput> & outputs) {
+    QVector<QString> res;
+    res.reserve(outputs.size());
+    for (const auto & o : outputs)
+        res.push_back(o.toJson());
+    return res;
+}
+
+////////////////////////////////////////////////////////////////////
+// OutputsSnapshot
+
+OutputsSnapshot::OutputsSnapshot() :
+    d(new OutputsSnapshotData)
+{}
+
+OutputsSnapshot::OutputsSnapshot(const QString & account, bool showSpent, int64_t height, const QVector<WalletOutput> & outputs) :
+    d(new OutputsSnapshotData)
+{
+    d->account = account;
+    d->showSpent = showSpent;
+    d->height = height;
+    d->outputs = outputs;
+}
+
+QVector<QString> OutputsSnapshot::outputsToJson() const {
+    return outputs2json(d->outputs);
+}
+
+////////////////////////////////////////////////////////////////////
+// TransactionsSnapshot
+
+TransactionsSnapshot::TransactionsSnapshot() :
+    d(new TransactionsSnapshotData)
+{}
+
+TransactionsSnapshot::TransactionsSnapshot(const QString & account, int64_t height, const QVector<WalletTransaction> & transactions,
+                                           const QVector<WalletOutput> & outputs) :
+    d(new TransactionsSnapshotData)
+{
+    d->account = account;
+    d->height = height;
+    d->transactions = transactions;
+    d->outputs = outputs;
+}
+
+QVector<QString> TransactionsSnapshot::transactionsToJson() const {
+    QVector<QString> res;
+    res.reserve(d->transactions.size());
+    for (const auto & t : d->transactions)
+        res.push_back(t.toJson());
+    return res;
+}
+
+QVector<QString> TransactionsSnapshot::outputsToJson() const {
+    return outputs2json(d->outputs);
+}
+
+}
@@ -0,0 +1,86 @@
+// Copyright 2019 The MWC Developers
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MWC_QT_WALLET_WALLETSNAPSHOT_H
+#define MWC_QT_WALLET_WALLETSNAPSHOT_H
+
+#include <QSharedData>
+#include <QSharedDataPointer>
+#include <QVector>
+#include <QString>
+#include "wallet.h"
+
+namespace wallet {
+
+struct OutputsSnapshotData : public QSharedData {
+    QString account;
+    bool    showSpent = false;
+    int64_t height = -1;
+    QVector<WalletOutput> outputs;
+};
+
+// Immutable outputs query result. Copy is a reference counter increment, so the bridge can
+// hand it to any number of windows. Json is built only for QML on request.
+class OutputsSnapshot {
+public:
+    OutputsSnapshot();
+    OutputsSnapshot(const QString & account, bool showSpent, int64_t height, const QVector<WalletOutput> & outputs);
+
+    const QString & getAccount() const {return d->account;}
+    bool isShowSpent() const {return d->showSpent;}
+    int64_t getHeight() const {return d->height;}
+    const QVector<WalletOutput> & getOutputs() const {return d->outputs;}
+
+    // Json strings for QML, see WalletOutput::toJson
+    QVector<QString> outputsToJson() const;
+
+private:
+    // Only const access, data never detach
+    QSharedDataPointer<OutputsSnapshotData> d;
+};
+
+struct TransactionsSnapshotData : public QSharedData {
+    QString account;
+    int64_t height = -1;
+    QVector<WalletTransaction> transactions;
+    QVector<WalletOutput> outputs; // Transaction details only, empty for the transaction lists
+};
+
+// Immutable transactions query result, the same idea as OutputsSnapshot.
+// For transaction details it holds the single transaction and its outputs.
+class TransactionsSnapshot {
+public:
+    TransactionsSnapshot();
+    TransactionsSnapshot(const QString & account, int64_t height, const QVector<WalletTransaction> & transactions,
+                         const QVector<WalletOutput> & outputs = QVector<WalletOutput>());
+
+    const QString & getAccount() const {return d->account;}
+    int64_t getHeight() const {return d->height;}
+    const QVector<WalletTransaction> & getTransactions() const {return d->transactions;}
+    const QVector<WalletOutput> & getOutputs() const {return d->outputs;}
+
+    // Json strings for QML, see WalletTransaction::toJson, WalletOutput::toJson
+    QVector<QString> transactionsToJson() const;
+    QVector<QString> outputsToJson() const;
+
+private:
+    QSharedDataPointer<TransactionsSnapshotData> d;
+};
+
+}
+
+Q_DECLARE_METATYPE(wallet::OutputsSnapshot);
+Q_DECLARE_METATYPE(wallet::TransactionsSnapshot);
+
+#endif //MWC_QT_WALLET_WALLETSNAPSHOT_H
@@ -15,13 +15,14 @@
 #include "e_outputs_w.h"
 #include "ui_e_outputs.h"
 #include <QDebug>
+#include <QHash>
 #include "../control_desktop/messagebox.h"
 #include "../dialogs_desktop/e_showoutputdlg.h"
 #include "../util_desktop/timeoutlock.h"
 #include "../bridge/config_b.h"
 #include "../bridge/wallet_b.h"
 #include "../bridge/wnd/e_outputs_b.h"
-#include "../control_desktop/richbutton.h"
+#include "../control_desktop/richlistview.h"
 
 namespace wnd {
 
@@ -30,20 +31,6 @@ bool Outputs::lockMessageWasShown = false;
 
 //////////////////////////////////////////////////////////////////////////////////////////////////////
 
-void OutputData::setBtns(control::RichItem * _ritem,
-                         QWidget * _markWnd,
-                         control::RichButton * _lockBtn,
-                         QLabel * _lockLabel,
-                         QLabel * _comment) {
-    ritem = _ritem;
-    markWnd = _markWnd;
-    lockBtn = _lockBtn;
-    lockLabel = _lockLabel;
-    comment = _comment;
-}
-
-//////////////////////////////////////////////////////////////////////////////////////////////////////
-
 Outputs::Outputs(QWidget *parent) :
         core::NavWnd(parent),
         ui(new Ui::Outputs) {
@@ -53,16 +40,19 @@ Outputs::Outputs(QWidget *parent) :
     wallet = new bridge::Wallet(this);
     outputs = new bridge::Outputs(this);
 
-    QObject::connect( wallet, &bridge::Wallet::sgnOutputs,
+    QObject::connect( wallet, &bridge::Wallet::sgnOutputsSnapshot,
                       this, &Outputs::onSgnOutputs, Qt::QueuedConnection);
     QObject::connect( wallet, &bridge::Wallet::sgnWalletBalanceUpdated,
                       this, &Outputs::onSgnWalletBalanceUpdated, Qt::QueuedConnection);
     QObject::connect( wallet, &bridge::Wallet::sgnNewNotificationMessage,
                       this, &Outputs::onSgnNewNotificationMessage, Qt::QueuedConnection);
 
-    QObject::connect(ui->outputsTable, &control::RichVBox::onItemActivated,
+    QObject::connect(ui->outputsTable, &control::RichListView::onItemActivated,
                      this, &Outputs::onItemActivated, Qt::QueuedConnection);
 
+    ui->outputsTable->setRowBuilder( [this](int row) {return buildRow(row);} );
+    ui->outputsTable->setButtonCallback(this);
+
     ui->progress->initLoader(true);
     ui->progressFrame->hide();
 
@@ -85,136 +75,118 @@ Outputs::~Outputs() {
     delete ui;
 }
 
-bool Outputs::calcMarkFlag(const wallet::WalletOutput & out) {
+bool Outputs::calcMarkFlag(const wallet::WalletOutput & out) const {
     QString lockState = calcLockedState(out);
-    return out.status == "Unconfirmed" || out.status == "Locked" || lockState == "YES";
+    return out.status == wallet::WalletOutput::STATUS::UNCONFIRMED || out.status == wallet::WalletOutput::STATUS::LOCKED || lockState == "YES";
 }
 
-void Outputs::updateShownData() {
-    ui->outputsTable->clearAll();
-
-    int total = allData.size();
-
-    qDebug() << "updating output table for " << total << " outputs";
-    // Printing first 200 outputs. For normal usage 200 is enough. The re
-    for (int i = allData.size()-1; i >= std::max(0, allData.size()-5000); i--) {
-        auto &out = allData[i].output;
-
-        // Data filtering was done on outputs request level. No need to filter out anything
-
-        // return "N/A, Yes, "No"
-        QString lockState = calcLockedState(out);
-        bool mark = calcMarkFlag(out);
-
-        control::RichItem * itm = control::createMarkedItem(QString::number(i), ui->outputsTable, mark );
-
-        QWidget * markWnd = (QWidget *) itm->getCurrentWidget();
-
-        // First row with Info about the commit
-        {
-            itm->hbox().setContentsMargins(0, 0, 0, 0).setSpacing(4);
-            // Adding Icon and a text
-            if (out.status == "Unconfirmed") {
-                itm->addWidget(control::createIcon(itm, ":/img/iconUnconfirmed@2x.svg", control::ROW_HEIGHT, control::ROW_HEIGHT));
-            } else if (out.status == "Unspent") {
-                if (out.coinbase)
-                    itm->addWidget(control::createIcon(itm, ":/img/iconCoinbase@2x.svg", control::ROW_HEIGHT, control::ROW_HEIGHT));
-                else
-                    itm->addWidget(control::createIcon(itm, ":/img/iconReceived@2x.svg", control::ROW_HEIGHT, control::ROW_HEIGHT));
-            } else if (out.status == "Locked") {
-                itm->addWidget( control::createIcon(itm, ":/img/iconLock@2x.svg", control::ROW_HEIGHT, control::ROW_HEIGHT));
-            } else if (out.status == "Spent") {
-                itm->addWidget( control::createIcon(itm, ":/img/iconSent@2x.svg", control::ROW_HEIGHT, control::ROW_HEIGHT));
-            } else {
-                Q_ASSERT(false);
-            }
+QVector<int> Outputs::calcShownRows() const {
+    // Spent outputs might stay from the previous 'show all' request
+    const bool showSpent = config->isShowOutputAll();
+
+    QVector<int> rows;
+    rows.reserve(allData.size());
+    // Last outputs go first
+    for (int i = allData.size()-1; i >= 0; i--) {
+        if (!showSpent && allData[i].output.status == wallet::WalletOutput::STATUS::SPENT)
+            continue;
+        rows.push_back(i);
+    }
+    return rows;
+}
 
-            itm->addWidget(control::createLabel(itm, false, false, out.status));
-            itm->addHSpacer();
+void Outputs::updateShownData() {
+    shownRows = calcShownRows();
+    dataRows = QVector<int>(allData.size(), -1);
+    for (int row=0; row<shownRows.size(); row++)
+        dataRows[shownRows[row]] = row;
+    qDebug() << "updating output table for " << shownRows.size() << " outputs";
+    ui->outputsTable->resetRows(shownRows.size());
+}
 
-            bool hok = false;
-            int height = out.blockHeight.toInt(&hok);
-            bool lok = false;
-            int lockH = out.lockedUntil.toInt(&lok);
+void Outputs::updateDataRow(int idx) {
+    int row = idx>=0 && idx<dataRows.size() ? dataRows[idx] : -1;
+    if (row>=0)
+        ui->outputsTable->updateRow(row);
+}
 
-            if (hok) {
-                itm->addWidget(control::createLabel(itm, false, true, "Block: " + out.blockHeight));
-            }
-            if (lok && hok && lockH > height) {
-                itm->addFixedHSpacer(control::LEFT_MARK_SPACING).addWidget(
-                        control::createLabel(itm, false, true, "Lock Height: " + out.lockedUntil));
-            }
-            itm->pop();
-        } // First line
+control::RichRow Outputs::buildRow(int row) const {
+    control::RichRow res;
+    if (row<0 || row>=shownRows.size())
+        return res;
 
-        itm->addWidget( control::createHorzLine(itm) );
+    const int i = shownRows[row];
+    const wallet::WalletOutput & out = allData[i].output;
 
-        QLabel * lockL = nullptr;
-        control::RichButton * lockBtn = nullptr;
+    // return "N/A, Yes, "No"
+    QString lockState = calcLockedState(out);
 
-        { // Line with amount
-            itm->hbox().setContentsMargins(0, 0, 0, 0).setSpacing(4);
+    res.id = QString::number(i);
+    res.marked = calcMarkFlag(out);
+
+    // First row with Info about the commit
+    {
+        control::RichLine & ln = res.line();
+        // Adding Icon and a text
+        if (out.status == wallet::WalletOutput::STATUS::UNCONFIRMED) {
+            ln.add( control::RichCell::icon(":/img/iconUnconfirmed@2x.svg") );
+        } else if (out.status == wallet::WalletOutput::STATUS::UNSPENT) {
+            if (out.coinbase)
+                ln.add( control::RichCell::icon(":/img/iconCoinbase@2x.svg") );
+            else
+                ln.add( control::RichCell::icon(":/img/iconReceived@2x.svg") );
+        } else if (out.status == wallet::WalletOutput::STATUS::LOCKED) {
+            ln.add( control::RichCell::icon(":/img/iconLock@2x.svg") );
+        } else if (out.status == wallet::WalletOutput::STATUS::SPENT) {
+            ln.add( control::RichCell::icon(":/img/iconSent@2x.svg") );
+        } else {
+            Q_ASSERT(false);
+        }
 
-            itm->addWidget(control::createIcon(itm, ":/img/iconLock@2x", control::ROW_HEIGHT, control::ROW_HEIGHT));
-            lockL = (QLabel*)itm->getCurrentWidget();
+        ln.add( control::RichCell::label(out.getStatus()) ).add( control::RichCell::spacer() );
 
-            if (lockState != "YES") {
-                lockL->hide();
-            }
+        if (out.blockHeight >= 0) {
+            ln.add( control::RichCell::label("Block: " + out.getBlockHeight(), true) );
+        }
+        if (out.blockHeight >= 0 && out.lockedUntil > out.blockHeight) {
+            ln.add( control::RichCell::fixedSpacer(control::LEFT_MARK_SPACING) )
+              .add( control::RichCell::label("Lock Height: " + out.getLockedUntil(), true) );
+        }
+    } // First line
 
-            itm->addWidget( control::createLabel(itm, false, false, util::nano2one(out.valueNano) + " MWC", control::FONT_LARGE));
-            itm->addHSpacer();
+    res.horzLine();
 
-            // Add lock button if it is applicable
-            if ( lockState == "YES" ) {
-                itm->addWidget(new control::RichButton(itm, "Unlock", 60, control::ROW_HEIGHT, "Unlock this output and make it spendable"));
-                lockBtn = (control::RichButton*) itm->getCurrentWidget();
-            }
-            else if (lockState == "NO") {
-                itm->addWidget(new control::RichButton(itm, "Lock", 60, control::ROW_HEIGHT, "Lock this output and make it non spendable"));
-                lockBtn = (control::RichButton*) itm->getCurrentWidget();
-            }
+    { // Line with amount
+        control::RichLine & ln = res.line();
 
-            if (lockBtn) {
-                lockBtn->setCallback(this, QString::number(i) );
-                itm->addFixedHSpacer(control::ROW_HEIGHT);
-            }
+        if (lockState == "YES")
+            ln.add( control::RichCell::icon(":/img/iconLock@2x") );
 
-            itm->addWidget( control::createLabel(itm, false, true, "Conf: " + out.numOfConfirms));
+        ln.add( control::RichCell::label(util::nano2one(out.valueNano) + " MWC", false, control::FONT_LARGE) )
+          .add( control::RichCell::spacer() );
 
-            itm->pop();
+        // Add lock button if it is applicable
+        if ( lockState == "YES" ) {
+            ln.add( control::RichCell::button("Unlock", QString::number(i), "Unlock this output and make it spendable") )
+              .add( control::RichCell::fixedSpacer(control::ROW_HEIGHT) );
         }
-
-        // line with commit
-        {
-            itm->hbox().setContentsMargins(0, 0, 0, 0);
-            itm->addWidget(control::createLabel(itm, false, true, out.outputCommitment, control::FONT_SMALL));
-            itm->addHSpacer();
-            itm->pop();
+        else if (lockState == "NO") {
+            ln.add( control::RichCell::button("Lock", QString::number(i), "Lock this output and make it non spendable") )
+              .add( control::RichCell::fixedSpacer(control::ROW_HEIGHT) );
         }
 
-        // And the last optional line is comment
-        QLabel *noteL = nullptr;
-        {
-            QString outputNote = config->getOutputNote(out.outputCommitment);
-            itm->hbox().setContentsMargins(0, 0, 0, 0);
-            itm->addWidget(control::createLabel(itm, true, false, outputNote));
-            noteL = (QLabel *) itm->getCurrentWidget();
-            //itm->addHSpacer();
-            itm->pop();
-
-            if (outputNote.isEmpty())
-                noteL->hide();
-        }
-        Q_ASSERT(noteL);
+        ln.add( control::RichCell::label("Conf: " + out.getNumOfConfirms(), true) );
+    }
 
-        itm->apply();
+    // line with commit
+    res.line().add( control::RichCell::label(out.getOutputCommitment(), true, control::FONT_SMALL) ).add( control::RichCell::spacer() );
 
-        allData[i].setBtns(itm, markWnd, lockBtn, lockL, noteL);
-        ui->outputsTable->addItem(itm);
-    }
+    // And the last optional line is comment
+    QString outputNote = config->getOutputNote(out.getOutputCommitment());
+    if (!outputNote.isEmpty())
+        res.line().add( control::RichCell::label(outputNote, false, control::FONT_NORMAL, true) );
 
-    ui->outputsTable->apply();
+    return res;
 }
 
 void Outputs::richButtonPressed(control::RichButton * button, QString coockie) {
@@ -224,8 +196,8 @@ void Outputs::richButtonPressed(control::RichButton * button, QString coockie) {
 
     if (idx>=0 && idx<allData.size()) {
         wallet::WalletOutput & selected = allData[idx].output;
-        bool locked = !config->isLockedOutput(selected.outputCommitment);
-        config->setLockedOutput(locked, selected.outputCommitment);
+        bool locked = !config->isLockedOutput(selected.getOutputCommitment());
+        config->setLockedOutput(locked, selected.getOutputCommitment());
 
         updateOutputState( idx, locked );
     }
@@ -235,25 +207,9 @@ bool Outputs::updateOutputState(int idx, bool lock) {
     if ( idx>=0 && idx<allData.size() && showLockMessage() ) {
 
         wallet::WalletOutput & selected = allData[idx].output;
-        QLabel * lockL = allData[idx].lockLabel;
-        control::RichButton * lockBtn = allData[idx].lockBtn;
-
-        config->setLockedOutput(lock, selected.outputCommitment);
-        if (lock) {
-            if (lockBtn)
-                lockBtn->setText("Unlock");
-            if (lockL)
-                lockL->show();
-        }
-        else {
-            if (lockBtn)
-                lockBtn->setText("Lock");
-            if (lockL)
-                lockL->hide();
-        }
-
-        bool mark = calcMarkFlag(selected);
-        allData[idx].markWnd->setStyleSheet( mark ? control::LEFT_MARK_ON : control::LEFT_MARK_OFF );
+        config->setLockedOutput(lock, selected.getOutputCommitment());
+        // Lock button, icon and the mark are built from the config
+        updateDataRow(idx);
 
         return true;
     }
@@ -264,24 +220,48 @@ QString Outputs::currentSelectedAccount() {
     return ui->accountComboBox->currentData().toString();
 }
 
-void Outputs::onSgnOutputs( QString account, bool showSpent, QString height, QVector<QString> outputs) {
-    Q_UNUSED(height);
-
-    if (account != currentSelectedAccount() || showSpent != config->isShowOutputAll() )
+void Outputs::onSgnOutputs( wallet::OutputsSnapshot outputs) {
+    if (outputs.getAccount() != currentSelectedAccount() || outputs.isShowSpent() != config->isShowOutputAll() )
         return;
 
     ui->progressFrame->hide();
     ui->tableFrame->show();
 
-    allData.clear();
+    const QVector<wallet::WalletOutput> & newOutputs = outputs.getOutputs();
+
+    QVector<wallet::WalletOutput> prev;
+    prev.reserve(allData.size());
+    for (const auto & d : allData)
+        prev.push_back(d.output);
+    const wallet::OutputsDelta delta = wallet::OutputsDelta::calc(outputs.getAccount(), outputs.getHeight(), prev, newOutputs);
 
-    for (const QString & s : outputs) {
+    allData.clear();
+    allData.reserve(newOutputs.size());
+    for (const auto & o : newOutputs) {
         OutputData out;
-        out.output = wallet::WalletOutput::fromJson(s);
+        out.output = o;
         allData.push_back( out );
     }
 
-    updateShownData();
+    // Refresh usually changes few outputs. Listing order is stable, if the set is the same, the rows are the same too.
+    if ( delta.inserted.isEmpty() && delta.removed.isEmpty() && calcShownRows() == shownRows &&
+            ui->outputsTable->getRowCount() == shownRows.size() ) {
+        if (!delta.updated.isEmpty()) {
+            QHash<QString, int> dataIdx;
+            for (int i=0; i<allData.size(); i++)
+                dataIdx.insert( allData[i].output.getOutputCommitment(), i );
+            for (const auto & o : delta.updated)
+                updateDataRow( dataIdx.value(o.getOutputCommitment(), -1) );
+        }
+        // With a new block every row has new confirmations number. Only the visible rows
+        // are painted, there is no need to update them one by one.
+        if (outputs.getHeight() != shownHeight)
+            ui->outputsTable->viewport()->update();
+    }
+    else {
+        updateShownData();
+    }
+    shownHeight = outputs.getHeight();
 }
 
 void Outputs::on_refreshButton_clicked() {
@@ -290,13 +270,10 @@ void Outputs::on_refreshButton_clicked() {
 
 // Request and reset page counter
 void Outputs::requestOutputs(QString account) {
-    allData.clear();
-
     ui->progressFrame->show();
     ui->tableFrame->hide();
 
-    updateShownData();
-
+    wallet->setAccountFilter(account); // Other accounts data is not needed
     wallet->requestOutputs(account, config->isShowOutputAll(), true);
 }
 
@@ -306,6 +283,9 @@ void Outputs::on_accountComboBox_activated(int index) {
     QString selectedAccount = currentSelectedAccount();
     if (!selectedAccount.isEmpty()) {
         wallet->switchAccount(selectedAccount);
+        // Another account data can't be updated incrementally
+        allData.clear();
+        updateShownData();
         requestOutputs(selectedAccount);
     }
 }
@@ -341,17 +321,19 @@ void Outputs::on_showUnspent_clicked() {
     config->setShowOutputAll( showAll );
     ui->showUnspent->setText( QString("Show Spent: ") + (showAll ? "Yes" : "No") );
 
+    // Hiding spent is just a filter for what we already have
+    updateShownData();
     on_refreshButton_clicked();
 }
 
 // return "N/A, YES, "NO"
-QString Outputs::calcLockedState(const wallet::WalletOutput & output) {
+QString Outputs::calcLockedState(const wallet::WalletOutput & output) const {
     if (!canLockOutputs)
         return "N/A";
 
     QString lockState = "N/A";
     if (output.isUnspent()) {
-            lockState = config->isLockedOutput(output.outputCommitment) ? "YES" : "NO";
+            lockState = config->isLockedOutput(output.getOutputCommitment()) ? "YES" : "NO";
     }
     return lockState;
 }
@@ -389,10 +371,10 @@ void Outputs::onItemActivated(QString itemId) {
         wallet::WalletOutput out = allData[idx].output;
         util::TimeoutLockObject to("Outputs");
 
-        bool locked = config->isLockedOutput(out.outputCommitment);
+        bool locked = config->isLockedOutput(out.getOutputCommitment());
 
         QString account = currentSelectedAccount();
-        QString outputNote = config->getOutputNote(out.outputCommitment);
+        QString outputNote = config->getOutputNote(out.getOutputCommitment());
         dlg::ShowOutputDlg showOutputDlg(this, out,
                                          outputNote,
                                          config->isLockOutputEnabled(), locked);
@@ -400,22 +382,20 @@ void Outputs::onItemActivated(QString itemId) {
         if (showOutputDlg.exec() == QDialog::Accepted) {
             if (locked != showOutputDlg.isLocked()) {
                 if (updateOutputState(idx, showOutputDlg.isLocked())) {
-                    config->setLockedOutput(showOutputDlg.isLocked(), out.outputCommitment);
+                    config->setLockedOutput(showOutputDlg.isLocked(), out.getOutputCommitment());
                 }
             }
 
             QString resNote = showOutputDlg.getResultOutputNote();
             if (resNote != outputNote ) {
                 if (resNote.isEmpty()) {
-                    config->deleteOutputNote( out.outputCommitment );
-                    allData[idx].comment->hide();
+                    config->deleteOutputNote( out.getOutputCommitment() );
                 }
                 else {
                     // add new note or update existing note for this commitment
-                    config->updateOutputNote(out.outputCommitment, resNote);
-                    allData[idx].comment->setText(resNote);
-                    allData[idx].comment->show();
+                    config->updateOutputNote(out.getOutputCommitment(), resNote);
                 }
+                updateDataRow(idx);
             }
         }
     }
@@ -17,10 +17,9 @@
 
 #include "../core_desktop/navwnd.h"
 #include "../wallet/wallet.h"
+#include "../wallet/walletsnapshot.h"
 #include "../control_desktop/richbutton.h"
 
-class QLabel;
-
 namespace Ui {
 class Outputs;
 }
@@ -32,20 +31,13 @@ class Outputs;
 }
 
 namespace control {
-class RichItem;
+struct RichRow;
 }
 
 namespace wnd {
 
 struct OutputData {
     wallet::WalletOutput output;
-    control::RichItem * ritem = nullptr;
-    QWidget * markWnd = nullptr;
-    control::RichButton * lockBtn = nullptr;
-    QLabel * lockLabel = nullptr;
-    QLabel * comment = nullptr;
-
-    void setBtns(control::RichItem * ritem, QWidget * markWnd, control::RichButton * lockBtn, QLabel * lockLabel, QLabel * comment);
 };
 
 class Outputs : public core::NavWnd,  control::RichButtonPressCallback
@@ -62,7 +54,7 @@ private slots:
     void on_showUnspent_clicked();
 
     void onSgnWalletBalanceUpdated();
-    void onSgnOutputs( QString account, bool showSpent, QString height, QVector<QString> outputs);
+    void onSgnOutputs( wallet::OutputsSnapshot outputs);
 
     void onSgnNewNotificationMessage(int level, QString message);
 
@@ -74,7 +66,7 @@ protected:
 private:
     virtual void panelWndStarted() override;
 
-    bool calcMarkFlag(const wallet::WalletOutput & out);
+    bool calcMarkFlag(const wallet::WalletOutput & out) const;
 
     bool updateOutputState(int idx, bool lock);
 
@@ -82,14 +74,20 @@ private:
 
     QString currentSelectedAccount();
 
-    // return enable state for the buttons
+    // Filter and sort allData into shownRows, reset the list
     void updateShownData();
+    // Build filtered and sorted rows, values are allData indexes
+    QVector<int> calcShownRows() const;
+    // Row for the outputs list, row is index in shownRows
+    control::RichRow buildRow(int row) const;
+    // Repaint the row that shows allData[idx]
+    void updateDataRow(int idx);
 
     // return selected account
     QString updateAccountsData();
 
     // return "N/A, YES, "NO"
-    QString calcLockedState(const wallet::WalletOutput & output);
+    QString calcLockedState(const wallet::WalletOutput & output) const;
 
     // return true if user fine with lock changes
     bool showLockMessage();
@@ -100,6 +98,9 @@ private:
     bridge::Outputs * outputs = nullptr; // needed as output windows active flag
 
     QVector<OutputData> allData; // all outputs
+    QVector<int> shownRows; // list rows, indexes in allData
+    QVector<int> dataRows;  // allData index -> list row, -1 - not shown
+    int64_t shownHeight = -1; // Height of the shown data, confirmations depend on it
 
     bool canLockOutputs = false;
 
@@ -17,6 +17,7 @@
 #include "../control_desktop/messagebox.h"
 #include "../util_desktop/timeoutlock.h"
 #include <QDebug>
+#include <algorithm>
 #include "../dialogs_desktop/e_showproofdlg.h"
 #include "../dialogs_desktop/e_showtransactiondlg.h"
 #include "../bridge/wallet_b.h"
@@ -24,24 +25,13 @@
 #include "../bridge/util_b.h"
 #include "../bridge/wnd/e_transactions_b.h"
 #include "../core/global.h"
+#include "../control_desktop/richlistview.h"
 
 // It is exception for Mobile, CSV export not likely needed into mobile wallet
 #include "../util/Files.h"
 
 namespace wnd {
 
-void TransactionData::setBtns(control::RichItem * _ritem, control::RichButton * _cancelBtn,
-             control::RichButton * _repostBtn, control::RichButton * _proofBtn,
-             QLabel * _noteL) {
-    ritem = _ritem;
-    cancelBtn = _cancelBtn;
-    repostBtn = _repostBtn;
-    proofBtn = _proofBtn;
-    noteL = _noteL;
-}
-
-////////////////////////////////////////////////////////////////////////////////////////////////////
-
 Transactions::Transactions(QWidget *parent) :
     core::NavWnd(parent),
     ui(new Ui::Transactions)
@@ -55,11 +45,13 @@ Transactions::Transactions(QWidget *parent) :
 
     QObject::connect( wallet, &bridge::Wallet::sgnWalletBalanceUpdated,
                       this, &Transactions::onSgnWalletBalanceUpdated, Qt::QueuedConnection);
-    QObject::connect( wallet, &bridge::Wallet::sgnTransactions,
+    QObject::connect( wallet, &bridge::Wallet::sgnTransactionsSnapshot,
                       this, &Transactions::onSgnTransactions, Qt::QueuedConnection);
+    QObject::connect( wallet, &bridge::Wallet::sgnTransactionsDelta,
+                      this, &Transactions::onSgnTransactionsDelta, Qt::QueuedConnection);
     QObject::connect( wallet, &bridge::Wallet::sgnCancelTransacton,
                       this, &Transactions::onSgnCancelTransacton, Qt::QueuedConnection);
-    QObject::connect( wallet, &bridge::Wallet::sgnTransactionById,
+    QObject::connect( wallet, &bridge::Wallet::sgnTransactionByIdSnapshot,
                       this, &Transactions::onSgnTransactionById, Qt::QueuedConnection);
     QObject::connect( wallet, &bridge::Wallet::sgnExportProofResult,
                       this, &Transactions::onSgnExportProofResult, Qt::QueuedConnection);
@@ -72,9 +64,12 @@ Transactions::Transactions(QWidget *parent) :
     QObject::connect( wallet, &bridge::Wallet::sgnRepost,
                       this, &Transactions::onSgnRepost, Qt::QueuedConnection);
 
-    QObject::connect(ui->transactionTable, &control::RichVBox::onItemActivated,
+    QObject::connect(ui->transactionTable, &control::RichListView::onItemActivated,
                      this, &Transactions::onItemActivated, Qt::QueuedConnection);
 
+    ui->transactionTable->setRowBuilder( [this](int row) {return buildRow(row);} );
+    ui->transactionTable->setButtonCallback(this);
+
     ui->progress->initLoader(true);
     ui->progressFrame->hide();
 
@@ -91,156 +86,152 @@ Transactions::~Transactions()
 }
 
 void Transactions::updateData() {
-    ui->transactionTable->clearAll();
-
-    QDateTime current = QDateTime::currentDateTime();
-    int expectedConfirmNumber = config->getInputConfirmationNumber();
-    QString currentAccount = ui->accountComboBox->currentData().toString();
-
-    int txCnt = 0;
-
-    for ( int idx = allTrans.size()-1; idx>=0 && txCnt<5000; idx--, txCnt++) {
-        TransactionData &tr = allTrans[idx];
-        const wallet::WalletTransaction &trans = tr.trans;
-
-        // if the node is online and in sync, display the number of confirmations instead of time
-        // trans.confirmationTime format: 2020-10-13 04:36:54
-        // Expected: Jan 2, 2020 / 2:07am
-        QString txTimeStr = trans.confirmationTime;
-        if (txTimeStr.isEmpty() || txTimeStr == "None")
-            txTimeStr = trans.creationTime;
-
-        QDateTime txTime = QDateTime::fromString(txTimeStr, "HH:mm:ss dd-MM-yyyy");
-        txTimeStr = txTime.toString("MMM d, yyyy / H:mmap");
-        bool blocksPrinted = false;
-        if (trans.confirmed && nodeHeight > 0 && trans.height > 0) {
-            int needConfirms = trans.isCoinbase() ? mwc::COIN_BASE_CONFIRM_NUMBER : expectedConfirmNumber;
-            // confirmations are 1 more than the difference between the node and transaction heights
-            int64_t confirmations = nodeHeight - trans.height + 1;
-            if (needConfirms >= confirmations) {
-                txTimeStr = "(" + QString::number(confirmations) + "/" + QString::number(needConfirms) + " blocks)";
-                blocksPrinted = true;
-            }
-        }
-
-        control::RichItem *itm = control::createMarkedItem(QString::number(idx), ui->transactionTable,
-                                                           trans.canBeCancelled());
-
-        { // First line
-            itm->hbox().setContentsMargins(0, 0, 0, 0).setSpacing(4);
-            // Adding Icon and a text
-            itm->addWidget( control::createLabel(itm, false, false, "#" + QString::number(trans.txIdx + 1)) ).addFixedHSpacer(10);
-
-            if (trans.transactionType & wallet::WalletTransaction::TRANSACTION_TYPE::CANCELLED) {
-                itm->addWidget(control::createIcon(itm, ":/img/iconClose@2x.svg", control::ROW_HEIGHT,
-                                                   control::ROW_HEIGHT))
-                        .addWidget(control::createLabel(itm, false, false, "Cancelled"));
-            } else if (!trans.confirmed) {
-                itm->addWidget(control::createIcon(itm, ":/img/iconUnconfirmed@2x.svg", control::ROW_HEIGHT,
-                                                   control::ROW_HEIGHT))
-                        .addWidget(control::createLabel(itm, false, false, "Unconfirmed"));
-            } else if (trans.transactionType & wallet::WalletTransaction::TRANSACTION_TYPE::SEND) {
-                itm->addWidget(control::createIcon(itm, ":/img/iconSent@2x.svg", control::ROW_HEIGHT,
-                                                   control::ROW_HEIGHT))
-                        .addWidget(control::createLabel(itm, false, false, "Sent"));
-            } else if (trans.transactionType & wallet::WalletTransaction::TRANSACTION_TYPE::RECEIVE) {
-                itm->addWidget(control::createIcon(itm, ":/img/iconReceived@2x.svg", control::ROW_HEIGHT,
-                                                   control::ROW_HEIGHT))
-                        .addWidget(control::createLabel(itm, false, false, "Received"));
-            } else if (trans.transactionType & wallet::WalletTransaction::TRANSACTION_TYPE::COIN_BASE) {
-                itm->addWidget(control::createIcon(itm, ":/img/iconCoinbase@2x.svg", control::ROW_HEIGHT,
-                                                   control::ROW_HEIGHT))
-                        .addWidget(control::createLabel(itm, false, false, "CoinBase"));
-            } else {
-                Q_ASSERT(false);
-            }
-
-            // Update with time or blocks
-            itm->addHSpacer().addWidget(control::createLabel(itm, false, true, txTimeStr));
+    expectedConfirmNumber = config->getInputConfirmationNumber();
 
-            itm->pop();
-        } // First line
-
-        itm->addWidget(control::createHorzLine(itm));
+    shownRows.clear();
+    if (searchText.isEmpty()) {
+        // Rows are built by the list on demand, only for the visible ones
+        ui->transactionTable->resetRows(allTrans.size());
+        return;
+    }
 
-        control::RichButton *cancelBtn = nullptr;
-        control::RichButton *repostBtn = nullptr;
+    // Search is done over the local history, it is in sync with the listing that we have
+    wallet::HistoryQuery query;
+    query.account = account;
+    query.text = searchText;
+    query.count = allTrans.size();
+    const wallet::HistoryQueryResult found = wallet->searchTransactions(query);
+    if (!found.error.isEmpty()) {
+        // Empty list would look like nothing is found
+        ui->transactionTable->resetRows(0);
+        if (!searchErrorShown) {
+            searchErrorShown = true;
+            control::MessageBox::messageText(this, "Search Error", found.error);
+        }
+        return;
+    }
+    for (const auto & tx : found.transactions) {
+        int idx = findTrans(tx.txIdx);
+        if (idx>=0)
+            shownRows.push_back(idx);
+    }
+    ui->transactionTable->resetRows(shownRows.size());
+}
 
-        // Line with amount
-        {
-            QString amount = util::nano2one(trans.coinNano);
+int Transactions::getTransIdx(int row) const {
+    if (searchText.isEmpty())
+        return allTrans.size() - 1 - row;
+    return (row>=0 && row<shownRows.size()) ? shownRows[row] : -1;
+}
 
-            itm->hbox().setContentsMargins(0, 0, 0, 0).setSpacing(4);
-            itm->addWidget(control::createLabel(itm, false, false, amount + " MWC", control::FONT_LARGE));
+int Transactions::getRow(int transIdx) const {
+    if (searchText.isEmpty())
+        return allTrans.size() - 1 - transIdx;
+    return shownRows.indexOf(transIdx);
+}
 
-            itm->addHSpacer();
+int Transactions::findTrans(int64_t txIdx) const {
+    auto it = std::lower_bound( allTrans.begin(), allTrans.end(), txIdx,
+                                [](const TransactionData & d, int64_t idx) {return d.trans.txIdx < idx;} );
+    return (it != allTrans.end() && it->trans.txIdx == txIdx) ? int(it - allTrans.begin()) : -1;
+}
 
-            if (!blocksPrinted && nodeHeight > 0 && trans.height > 0) {
-                itm->addWidget(control::createLabel(itm, false, true,
-                                                   "Conf: " + QString::number(nodeHeight - trans.height + 1)));
-            }
-            if (trans.canBeCancelled()) {
-                itm->addWidget(new control::RichButton(itm, "Cancel", 60, control::ROW_HEIGHT, "Cancel this transaction and unlock coins"));
-                cancelBtn = (control::RichButton *) itm->getCurrentWidget();
-                cancelBtn->setCallback(this, "Cancel:" + QString::number(idx));
-            }
-            // Can be reposted
-            if (trans.transactionType == wallet::WalletTransaction::TRANSACTION_TYPE::SEND && !trans.confirmed) {
-                itm->addWidget(new control::RichButton(itm, "Repost", 60, control::ROW_HEIGHT, "Report this transaction to the network"));
-                repostBtn = (control::RichButton *) itm->getCurrentWidget();
-                repostBtn->setCallback(this,
-                                       "Repost:" + QString::number(idx) + ":" + currentAccount);
-            }
-            itm->pop();
+control::RichRow Transactions::buildRow(int row) const {
+    control::RichRow res;
+
+    const int idx = getTransIdx(row);
+    if (idx<0 || idx>=allTrans.size())
+        return res;
+
+    const wallet::WalletTransaction &trans = allTrans[idx].trans;
+
+    res.id = QString::number(idx);
+    res.marked = trans.canBeCancelled();
+
+    // if the node is online and in sync, display the number of confirmations instead of time
+    // trans.confirmationTime format: 2020-10-13 04:36:54
+    // Expected: Jan 2, 2020 / 2:07am
+    QString txTimeStr = trans.confirmationTime;
+    if (txTimeStr.isEmpty() || txTimeStr == "None")
+        txTimeStr = trans.creationTime;
+
+    QDateTime txTime = QDateTime::fromString(txTimeStr, "HH:mm:ss dd-MM-yyyy");
+    txTimeStr = txTime.toString("MMM d, yyyy / H:mmap");
+    bool blocksPrinted = false;
+    if (trans.confirmed && nodeHeight > 0 && trans.height > 0) {
+        int needConfirms = trans.isCoinbase() ? mwc::COIN_BASE_CONFIRM_NUMBER : expectedConfirmNumber;
+        // confirmations are 1 more than the difference between the node and transaction heights
+        int64_t confirmations = nodeHeight - trans.height + 1;
+        if (needConfirms >= confirmations) {
+            txTimeStr = "(" + QString::number(confirmations) + "/" + QString::number(needConfirms) + " blocks)";
+            blocksPrinted = true;
         }
+    }
 
-        control::RichButton *proofBtn = nullptr;
-
-        // Line with ID
-        {
-            itm->hbox().setContentsMargins(0, 0, 0, 0).setSpacing(4);
-            itm->addWidget(control::createLabel(itm, false, true, trans.txid, control::FONT_SMALL));
-            itm->addHSpacer();
-            if (trans.proof) {
-                itm->addWidget(new control::RichButton(itm, "Proof", 60, control::ROW_HEIGHT,
-                                                       "Generate proof file for this transaction. Proof file can be validated by public at MWC Block Explorer"));
-                proofBtn = (control::RichButton *) itm->getCurrentWidget();
-                proofBtn->setCallback(this, "Proof:" + QString::number(idx));
-            }
-            itm->pop();
+    { // First line
+        control::RichLine & ln = res.line();
+        ln.add( control::RichCell::label("#" + QString::number(trans.txIdx + 1)) ).add( control::RichCell::fixedSpacer(10) );
+
+        if (trans.transactionType & wallet::WalletTransaction::TRANSACTION_TYPE::CANCELLED) {
+            ln.add( control::RichCell::icon(":/img/iconClose@2x.svg") ).add( control::RichCell::label("Cancelled") );
+        } else if (!trans.confirmed) {
+            ln.add( control::RichCell::icon(":/img/iconUnconfirmed@2x.svg") ).add( control::RichCell::label("Unconfirmed") );
+        } else if (trans.transactionType & wallet::WalletTransaction::TRANSACTION_TYPE::SEND) {
+            ln.add( control::RichCell::icon(":/img/iconSent@2x.svg") ).add( control::RichCell::label("Sent") );
+        } else if (trans.transactionType & wallet::WalletTransaction::TRANSACTION_TYPE::RECEIVE) {
+            ln.add( control::RichCell::icon(":/img/iconReceived@2x.svg") ).add( control::RichCell::label("Received") );
+        } else if (trans.transactionType & wallet::WalletTransaction::TRANSACTION_TYPE::COIN_BASE) {
+            ln.add( control::RichCell::icon(":/img/iconCoinbase@2x.svg") ).add( control::RichCell::label("CoinBase") );
+        } else {
+            Q_ASSERT(false);
         }
 
+        // Update with time or blocks
+        ln.add( control::RichCell::spacer() ).add( control::RichCell::label(txTimeStr, true) );
+    } // First line
 
-        // Address field...
-        if (!trans.address.isEmpty()) {
-            itm->hbox().setContentsMargins(0, 0, 0, 0);
-            itm->addWidget(control::createLabel(itm, false, true, trans.address, control::FONT_SMALL));
-            itm->addHSpacer().pop();
-        }
-
-        // And the last optional line is comment
-        QLabel *noteL = nullptr;
-        {
-            QString txnNote = config->getTxNote(trans.txid);
+    res.horzLine();
 
-            itm->hbox().setContentsMargins(0, 0, 0, 0);
-            itm->addWidget(control::createLabel(itm, true, false, txnNote));
-            //itm->addHSpacer();
-            itm->pop();
+    // Line with amount
+    {
+        control::RichLine & ln = res.line();
+        QString amount = util::nano2one(trans.coinNano);
+        ln.add( control::RichCell::label(amount + " MWC", false, control::FONT_LARGE) ).add( control::RichCell::spacer() );
 
-            noteL = (QLabel *) itm->getCurrentWidget();
-            if (txnNote.isEmpty())
-                noteL->hide();
+        if (!blocksPrinted && nodeHeight > 0 && trans.height > 0) {
+            ln.add( control::RichCell::label("Conf: " + QString::number(nodeHeight - trans.height + 1), true) );
+        }
+        if (trans.canBeCancelled()) {
+            ln.add( control::RichCell::button("Cancel", "Cancel:" + QString::number(idx), "Cancel this transaction and unlock coins") );
+        }
+        // Can be reposted
+        if (trans.transactionType == wallet::WalletTransaction::TRANSACTION_TYPE::SEND && !trans.confirmed) {
+            ln.add( control::RichCell::button("Repost", "Repost:" + QString::number(idx) + ":" + account, "Report this transaction to the network") );
         }
-        Q_ASSERT(noteL);
+    }
 
-        itm->apply();
+    // Line with ID
+    {
+        control::RichLine & ln = res.line();
+        ln.add( control::RichCell::label(trans.txid, true, control::FONT_SMALL) ).add( control::RichCell::spacer() );
+        if (trans.proof) {
+            ln.add( control::RichCell::button("Proof", "Proof:" + QString::number(idx),
+                            "Generate proof file for this transaction. Proof file can be validated by public at MWC Block Explorer") );
+        }
+    }
 
-        tr.setBtns(itm, cancelBtn, repostBtn, proofBtn, noteL);
+    // Address field...
+    if (!trans.address.isEmpty()) {
+        res.line().add( control::RichCell::label(trans.address, true, control::FONT_SMALL) ).add( control::RichCell::spacer() );
+    }
 
-        ui->transactionTable->addItem(itm);
+    // And the last optional line is comment
+    QString txnNote = config->getTxNote(trans.txid);
+    if (!txnNote.isEmpty()) {
+        res.line().add( control::RichCell::label(txnNote, false, control::FONT_NORMAL, true) );
     }
-    ui->transactionTable->apply();
+
+    return res;
 }
 
 void Transactions::richButtonPressed(control::RichButton * button, QString coockie) {
@@ -327,27 +318,92 @@ void Transactions::onSgnRepost( int idx, QString err ) {
 }
 
 
-void Transactions::onSgnTransactions( QString acc, QString height, QVector<QString> transactions) {
-    Q_UNUSED(height)
-
-    if (acc != ui->accountComboBox->currentData().toString() )
+void Transactions::onSgnTransactions( wallet::TransactionsSnapshot transactions) {
+    if (transactions.getAccount() != ui->accountComboBox->currentData().toString() )
         return;
 
     ui->progressFrame->hide();
     ui->transactionTable->show();
 
-    account = acc;
+    if ( !allTrans.isEmpty() && account == transactions.getAccount() ) {
+        // Delta might be already applied, then nothing will be changed
+        QVector<wallet::WalletTransaction> prev;
+        prev.reserve(allTrans.size());
+        for (const auto & tr : allTrans)
+            prev.push_back(tr.trans);
+        applyTransactionsDelta( wallet::TransactionsDelta::calc(account, transactions.getHeight(), prev, transactions.getTransactions()) );
+        return;
+    }
+
+    account = transactions.getAccount();
     allTrans.clear();
+    allTrans.reserve(transactions.getTransactions().size());
 
-    for (QString & t : transactions ) {
+    for (const auto & t : transactions.getTransactions() ) {
         TransactionData dt;
-        dt.trans = wallet::WalletTransaction::fromJson(t);
+        dt.trans = t;
         allTrans.push_back( dt );
     }
 
     updateData();
 }
 
+void Transactions::onSgnTransactionsDelta( wallet::TransactionsDelta delta ) {
+    // Waiting for the first listing, it will come with the full data
+    if (allTrans.isEmpty())
+        return;
+    applyTransactionsDelta(delta);
+}
+
+void Transactions::applyTransactionsDelta(const wallet::TransactionsDelta & delta) {
+    if (delta.account != account || delta.isEmpty())
+        return;
+
+    // Delta might be calculated from another listing, so 'inserted' transaction can be already here
+    QVector<wallet::WalletTransaction> updated = delta.updated;
+    QVector<wallet::WalletTransaction> inserted;
+    for (const auto & tx : delta.inserted) {
+        if (findTrans(tx.txIdx)>=0)
+            updated.push_back(tx);
+        else
+            inserted.push_back(tx);
+    }
+
+    // Updated transaction might match the search or not any more, filter need to be applied again
+    if ( inserted.isEmpty() && delta.removed.isEmpty() && searchText.isEmpty() ) {
+        for (const auto & tx : updated) {
+            int idx = findTrans(tx.txIdx);
+            if (idx<0)
+                continue;
+            allTrans[idx].trans = tx;
+            int row = getRow(idx);
+            if (row>=0)
+                ui->transactionTable->updateRow(row);
+        }
+        return;
+    }
+
+    // Rows are moved or filtered again, list need to be reset
+    for (const auto & tx : updated) {
+        int idx = findTrans(tx.txIdx);
+        if (idx>=0)
+            allTrans[idx].trans = tx;
+    }
+    for (int64_t txIdx : delta.removed) {
+        int idx = findTrans(txIdx);
+        if (idx>=0)
+            allTrans.remove(idx);
+    }
+    for (const auto & tx : inserted) {
+        TransactionData dt;
+        dt.trans = tx;
+        auto it = std::lower_bound( allTrans.begin(), allTrans.end(), tx.txIdx,
+                                    [](const TransactionData & d, int64_t idx) {return d.trans.txIdx < idx;} );
+        allTrans.insert(it, dt);
+    }
+    updateData();
+}
+
 void Transactions::onSgnExportProofResult(bool success, QString fn, QString msg ) {
     util::TimeoutLockObject to( "Transactions" );
     if (success) {
@@ -385,21 +441,25 @@ void Transactions::onSgnVerifyProofResult(bool success, QString fn, QString msg
 
 
 void Transactions::requestTransactions() {
-    allTrans.clear();
     nodeHeight = -1;
 
     QString account = ui->accountComboBox->currentData().toString();
+    // The same account data is updated incrementally
+    if (account != this->account) {
+        allTrans.clear();
+        this->account.clear();
+        updateData();
+    }
     if (account.isEmpty())
         return;
 
     ui->progressFrame->show();
     ui->transactionTable->hide();
-    ui->transactionTable->clearAll();
 
     // !!! Note, order is important even it is async. We want node status be processed first..
     wallet->requestNodeStatus(); // Need to know th height.
+    wallet->setAccountFilter(account); // Other accounts data is not needed
     wallet->requestTransactions(account, true);
-    updateData();
 }
 
 void Transactions::on_refreshButton_clicked()
@@ -440,19 +500,18 @@ void Transactions::on_exportButton_clicked()
     // qt-wallet displays the transactions last to first
     // however when exporting the transactions, we want to export first to last
     QStringList exportRecords;
-
-    // retrieve the first transaction and get the CSV headers
-    const wallet::WalletTransaction & trans = allTrans[0].trans;
-    QString csvHeaders = trans.getCSVHeaders();
-    exportRecords << csvHeaders;
-    QString csvValues = trans.toStringCSV();
-    exportRecords << csvValues;
-
-    // now retrieve the remaining transactions and add them to our list
-    for ( int idx=1; idx < allTrans.size(); idx++) {
-        const wallet::WalletTransaction & trans = allTrans[idx].trans;
-        QString csvValues = trans.toStringCSV();
-        exportRecords << csvValues;
+    exportRecords << wallet::WalletTransaction::getCSVHeaders();
+
+    // Local history is updated with every listing and it is in txIdx order already.
+    // Shown transactions are used if history is not available.
+    const QVector<wallet::WalletTransaction> stored = wallet->getStoredTransactions(account);
+    if (stored.size() >= allTrans.size()) {
+        for (const auto & trans : stored)
+            exportRecords << trans.toStringCSV();
+    }
+    else {
+        for (const auto & dt : allTrans)
+            exportRecords << dt.trans.toStringCSV();
     }
     // Note: Mobile doesn't expect to export anything. That is why we are breaking bridge rule here and usung util::writeTextFile directly
     // warning: When using a debug build, avoid testing with an existing file which has
@@ -495,33 +554,28 @@ void Transactions::onSgnNodeStatus( bool online, QString errMsg, int _nodeHeight
     Q_UNUSED(totalDifficulty);
     Q_UNUSED(connections);
 
-    if (online)
+    if (online && nodeHeight != _nodeHeight) {
         nodeHeight = _nodeHeight;
+        // Confirmation numbers depend on the height
+        ui->transactionTable->viewport()->update();
+    }
 }
 
-void Transactions::onSgnTransactionById(bool success, QString account, QString height, QString transactionJson,
-                          QVector<QString> outputsJson, QVector<QString> messages) {
-
-    Q_UNUSED(account)
-    Q_UNUSED(height)
-
+void Transactions::onSgnTransactionById(bool success, wallet::TransactionsSnapshot details, QVector<QString> messages) {
     ui->progressFrame->hide();
     ui->transactionTable->show();
 
     util::TimeoutLockObject to( "Transactions" );
 
-    if (!success) {
+    if (!success || details.getTransactions().isEmpty()) {
         control::MessageBox::messageText(this, "Transaction details",
                                          "Internal error. Transaction details are not found.");
         return;
     }
 
-    wallet::WalletTransaction transaction = wallet::WalletTransaction::fromJson(transactionJson);
-
-    QVector<wallet::WalletOutput> outputs;
-    for (auto & json : outputsJson)
-        outputs.push_back( wallet::WalletOutput::fromJson(json));
-
+    const QString account = details.getAccount();
+    wallet::WalletTransaction transaction = details.getTransactions().first();
+    const QVector<wallet::WalletOutput> & outputs = details.getOutputs();
 
     QString txnNote = config->getTxNote(transaction.txid);
     dlg::ShowTransactionDlg showTransDlg(this, account,  transaction, outputs, messages, txnNote);
@@ -536,13 +590,11 @@ void Transactions::onSgnTransactionById(bool success, QString account, QString h
             }
 
             // Updating the UI
-            for (const auto & tx : allTrans) {
-                if (tx.trans.txid == transaction.txid) {
-                    tx.noteL->setText(txnNote);
-                    if (txnNote.isEmpty())
-                        tx.noteL->hide();
-                    else
-                        tx.noteL->show();
+            for (int idx=0; idx<allTrans.size(); idx++) {
+                if (allTrans[idx].trans.txid == transaction.txid) {
+                    int row = getRow(idx);
+                    if (row>=0)
+                        ui->transactionTable->updateRow(row);
                 }
             }
         }
@@ -559,6 +611,11 @@ void Transactions::on_accountComboBox_activated(int index)
     requestTransactions();
 }
 
+void Transactions::on_searchEdit_textEdited(const QString & text) {
+    searchText = text.trimmed();
+    updateData();
+}
+
 void Transactions::onSgnCancelTransacton(bool success, QString account, QString trIdxStr, QString errMessage) {
     Q_UNUSED(account)
     Q_UNUSED(errMessage)
@@ -17,6 +17,7 @@
 
 #include "../core_desktop/navwnd.h"
 #include "../wallet/wallet.h"
+#include "../wallet/walletsnapshot.h"
 #include "../control_desktop/richbutton.h"
 
 namespace Ui {
@@ -31,26 +32,13 @@ class Util;
 }
 
 namespace control {
-class RichItem;
-class RichButton;
+struct RichRow;
 }
 
-class QLabel;
-
 namespace wnd {
 
 struct TransactionData {
     wallet::WalletTransaction trans;
-
-    control::RichItem * ritem = nullptr;
-    control::RichButton * cancelBtn = nullptr;
-    control::RichButton * repostBtn = nullptr;
-    control::RichButton * proofBtn = nullptr;
-    QLabel * noteL = nullptr;
-
-    void setBtns(control::RichItem * ritem, control::RichButton * cancelBtn,
-                 control::RichButton * repostBtn, control::RichButton * proofBtn,
-                 QLabel * noteL);
 };
 
 class Transactions : public core::NavWnd,  control::RichButtonPressCallback
@@ -63,17 +51,18 @@ public:
 
 private slots:
     void on_accountComboBox_activated(int index);
+    void on_searchEdit_textEdited(const QString & text);
 
     void on_refreshButton_clicked();
     void on_validateProofButton_clicked();
     void on_exportButton_clicked();
 
     void onSgnWalletBalanceUpdated();
-    void onSgnTransactions( QString account, QString height, QVector<QString> transactions);
+    void onSgnTransactions( wallet::TransactionsSnapshot transactions);
+    void onSgnTransactionsDelta( wallet::TransactionsDelta delta );
     void onSgnCancelTransacton(bool success, QString account, QString trIdx, QString errMessage);
 
-    void onSgnTransactionById(bool success, QString account, QString height, QString transaction,
-                              QVector<QString> outputs, QVector<QString> messages);
+    void onSgnTransactionById(bool success, wallet::TransactionsSnapshot details, QVector<QString> messages);
 
     void onSgnExportProofResult(bool success, QString fn, QString msg );
     void onSgnVerifyProofResult(bool success, QString fn, QString msg );
@@ -91,6 +80,15 @@ protected:
 private:
     void requestTransactions();
     void updateData();
+    // allTrans index for the list row and back. -1 if not found or not shown
+    int getTransIdx(int row) const;
+    int getRow(int transIdx) const;
+    // allTrans index for the txIdx
+    int findTrans(int64_t txIdx) const;
+    // Apply changes to allTrans. Only changed rows are repainted if transactions set is the same
+    void applyTransactionsDelta(const wallet::TransactionsDelta & delta);
+    // Row for the transactions list. Rows are in reverse order, the last transaction is on top
+    control::RichRow buildRow(int row) const;
 
 private:
     Ui::Transactions *ui;
@@ -100,9 +98,13 @@ private:
     bridge::Util * util = nullptr;
 
     QString account;
-    QVector<TransactionData> allTrans;
+    QVector<TransactionData> allTrans; // ordered by txIdx
+    QString searchText;
+    bool searchErrorShown = false; // Local history problem is reported once
+    QVector<int> shownRows; // allTrans indexes of the found transactions, newest first. Used if searchText is not empty
 
     int64_t nodeHeight    = 0;
+    int expectedConfirmNumber = 0;
 };
 
 }
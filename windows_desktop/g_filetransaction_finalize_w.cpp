@@ -43,7 +43,7 @@ FileTransactionFinalize::FileTransactionFinalize(QWidget *parent,
 
     QObject::connect( finalize, &bridge::Finalize::sgnHideProgress,
                       this, &FileTransactionFinalize::onSgnHideProgress, Qt::QueuedConnection);
-    QObject::connect( wallet, &bridge::Wallet::sgnTransactionById,
+    QObject::connect( wallet, &bridge::Wallet::sgnTransactionByIdSnapshot,
                       this, &FileTransactionFinalize::sgnTransactionById, Qt::QueuedConnection);
 
     ui->progress->initLoader(false);
@@ -97,19 +97,13 @@ FileTransactionFinalize::~FileTransactionFinalize() {
     delete ui;
 }
 
-void FileTransactionFinalize::sgnTransactionById( bool success, QString account, QString height, QString transaction,
-                         QVector<QString> outputs, QVector<QString> messages ) {
-
-    Q_UNUSED(account)
-    Q_UNUSED(height)
-    Q_UNUSED(outputs)
-
+void FileTransactionFinalize::sgnTransactionById( bool success, wallet::TransactionsSnapshot details, QVector<QString> messages ) {
     ui->progress->hide();
 
-    if (!success)
+    if (!success || details.getTransactions().isEmpty())
         return;
 
-    wallet::WalletTransaction txDetails = wallet::WalletTransaction::fromJson(transaction);
+    const wallet::WalletTransaction & txDetails = details.getTransactions().first();
 
     ui->mwcLabel->setText( util::nano2one( std::abs(txDetails.coinNano) ) + " MWC" );
     if (messages.length()>0) { // my message need to read form the saved transaction data
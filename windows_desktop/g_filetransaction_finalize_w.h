@@ -18,6 +18,7 @@
 #include "../core_desktop/navwnd.h"
 #include "../util/Json.h"
 #include "../wallet/wallet.h"
+#include "../wallet/walletsnapshot.h"
 
 namespace Ui {
 class FileTransactionFinalize;
@@ -49,8 +50,7 @@ private slots:
 
     void onSgnHideProgress();
 
-    void sgnTransactionById( bool success, QString account, QString height, QString transaction,
-                             QVector<QString> outputs, QVector<QString> messages );
+    void sgnTransactionById( bool success, wallet::TransactionsSnapshot details, QVector<QString> messages );
 private:
     Ui::FileTransactionFinalize *ui;
     bridge::Wallet * wallet = nullptr;